@@ -200,6 +200,9 @@ function ( add_includes_libs_to_target _target _stem _prefixes )
 	    target_link_libraries      ( ${_target} PRIVATE dl )
         endif ()
     endif ()
+    if ( Threads_FOUND )
+	target_link_libraries      ( ${_target} PRIVATE Threads::Threads )
+    endif ()
     if ( NOT "X{_library_names}" STREQUAL "X" )
 	##  Some libraries were built -- add them for linker
 	target_link_libraries      ( ${_target} PRIVATE ${_library_names} )
@@ -69,13 +69,19 @@ MDPRDFT_LIB=true
 ##  Build the Real Convolution library
 RCONV_LIB=true
 
+##  Build the 3D real-to-real (DCT-II/III and DST-II/III) library
+R2R_LIB=true
+
+##  Build the 3D Fourier resampling (refine and coarsen by 2) library
+RESAMPLE_LIB=true
+
 ##  Build the PSATD fixed sizes library
 PSATD_LIB=false
 
-##  File containing the sizes to build for the CPU version of MDDFT, MDPRDFT, and RCONV
+##  File containing the sizes to build for the CPU version of MDDFT, MDPRDFT, RCONV, R2R, and RESAMPLE
 CPU_SIZES_FILE="cube-sizes-cpu.txt"
 
-##  File containing the sizes to build for the GPU version of MDDFT, MDPRDFT, and RCONV
+##  File containing the sizes to build for the GPU version of MDDFT, MDPRDFT, RCONV, R2R, and RESAMPLE
 GPU_SIZES_FILE="cube-sizes-gpu.txt"
 ##  GPU_SIZES_FILE="cube-sizes.txt"
 
@@ -97,6 +103,8 @@ echo "PRDFTBAT_LIB=$PRDFTBAT_LIB" >> build-lib-code-options.sh
 echo "MDDFT_LIB=$MDDFT_LIB" >> build-lib-code-options.sh
 echo "MDPRDFT_LIB=$MDPRDFT_LIB" >> build-lib-code-options.sh
 echo "RCONV_LIB=$RCONV_LIB" >> build-lib-code-options.sh
+echo "R2R_LIB=$R2R_LIB" >> build-lib-code-options.sh
+echo "RESAMPLE_LIB=$RESAMPLE_LIB" >> build-lib-code-options.sh
 echo "PSATD_LIB=$PSATD_LIB" >> build-lib-code-options.sh
 echo "CPU_SIZES_FILE=$CPU_SIZES_FILE" >> build-lib-code-options.sh
 echo "GPU_SIZES_FILE=$GPU_SIZES_FILE" >> build-lib-code-options.sh
@@ -188,6 +196,20 @@ else
 fi
 echo "option ( RCONV_LIB \"Build the Real Convolution library\" $setopt )" >> options.cmake
 
+if [ "$R2R_LIB" = true ]; then
+    setopt="ON"
+else
+    setopt="OFF"
+fi
+echo "option ( R2R_LIB \"Build the 3D real-to-real (DCT, DST) library\" $setopt )" >> options.cmake
+
+if [ "$RESAMPLE_LIB" = true ]; then
+    setopt="ON"
+else
+    setopt="OFF"
+fi
+echo "option ( RESAMPLE_LIB \"Build the 3D Fourier resampling library\" $setopt )" >> options.cmake
+
 if [ "$PSATD_LIB" = true ]; then
     setopt="ON"
 else
@@ -0,0 +1,593 @@
+#include "fftx3.hpp"
+#include "interface.hpp"
+#include "mddftlib.hpp"
+#include "mdprdftlib.hpp"
+#include "dftbatlib.hpp"
+#include "../rconv/rconvObj.hpp"
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+
+#if defined FFTX_CUDA
+#include "cudabackend.hpp"
+#elif defined FFTX_HIP
+#include "hipbackend.hpp"
+#else
+#include "cpubackend.hpp"
+#endif
+#if defined (FFTX_CUDA) || defined(FFTX_HIP)
+#include "device_macros.h"
+#endif
+
+#ifndef FFTX_BENCH_SIZES_DIR
+#define FFTX_BENCH_SIZES_DIR "."
+#endif
+
+//  Benchmark sweep over the library size files.
+//
+//  For every size and transform family, the first transform() on a fresh
+//  problem object is timed as the cold run (it includes any code generation,
+//  compilation, cache lookup and init); the following iterations are warm
+//  runs, for which the kernel time reported by getTime() is recorded.
+//  Statistics and GFLOPS are
+//  computed from the kernel times, using the 5 N log2(N) convention for
+//  complex transforms of N points (2.5 N log2(N) for the real transforms
+//  mdprdft/imdprdft; 5 N log2(N) for rconv, a forward and an inverse real
+//  transform; 5 n log2(n) per line for batches of 1D DFTs).
+//
+//  The phases of the cold run are timed by the problem object itself:
+//    plan    = getting the code: generation, compilation, cache or library lookup
+//              (getPlanTime())
+//    init    = setting the code up around the kernel: loading, init and destroy
+//              functions (getInitTime())
+//    execute = fastest warm kernel time
+//
+//  With -g the results are compared against a baseline file (the JSON written
+//  by an earlier run on the same machine), making the program a performance
+//  gate: it exits with a nonzero status if any transform is slower than the
+//  baseline by more than the threshold, either in execute time or in setup
+//  (plan + init) time, and reports the phase accounting for the slowdown.
+//  A transform whose execute time is over the threshold is measured once more
+//  before it counts as slower, to filter out interference from other jobs.
+//  With -r the results are recorded as the new baseline.  If the baseline file
+//  does not exist, the results are recorded as well, but as nothing was
+//  compared the program exits with the status noBaseline, which CTest
+//  reports as a skipped test.
+
+//  Exit status of a gate run without a baseline to compare against
+static const int noBaseline = 77;
+
+static const char * cubeFamilies[]  = { "mddft", "imddft", "mdprdft", "imdprdft", "rconv" };
+static const char * batchFamilies[] = { "dftbat", "idftbat" };
+
+struct benchStats {
+    double min = 0., median = 0., p99 = 0.;
+};
+
+struct benchResult {
+    std::string family;
+    std::vector<int> sizes;     // [X, Y, Z] for cubes, [n, nbatch, stridetype] for batches
+    double flops = 0.;
+    double cold = 0.;           // wall time of the first transform (ms)
+    std::vector<double> kernel; // getTime() of each warm transform (ms)
+    benchStats stats;           // of kernel
+    double plan = 0., init = 0., execute = 0.;
+    double gflops = 0.;
+};
+
+//  Nearest rank percentile of a list of times
+static double percentile(std::vector<double> vals, double pct)
+{
+    if ( vals.empty() ) return 0.;
+    std::sort(vals.begin(), vals.end());
+    size_t rank = (size_t) std::ceil(pct / 100. * vals.size());
+    if ( rank < 1 ) rank = 1;
+    return vals[rank - 1];
+}
+
+static void computeStats(benchResult& res)
+{
+    res.stats.min = percentile(res.kernel, 0.);
+    res.stats.median = percentile(res.kernel, 50.);
+    res.stats.p99 = percentile(res.kernel, 99.);
+    res.execute = res.stats.min;
+    res.gflops = ( res.stats.median > 0. ) ? res.flops / (res.stats.median * 1.e6) : 0.;
+}
+
+//  Read the sizes from a cube-sizes*.txt file: lines of the form
+//  szcube := [ x, y, z ];  blank lines and lines starting with # are ignored
+
+static std::vector<std::vector<int>> readCubeSizes(const std::string& fname)
+{
+    std::vector<std::vector<int>> sizes;
+    std::ifstream ifs(fname);
+    std::string line;
+    while ( std::getline(ifs, line) ) {
+        size_t pos = line.find_first_not_of(" \t");
+        if ( pos == std::string::npos || line[pos] == '#' ) continue;
+        size_t brk = line.find('[', pos);
+        if ( line.compare(pos, 6, "szcube") != 0 || brk == std::string::npos ) continue;
+        int xx, yy, zz;
+        if ( sscanf(line.c_str() + brk + 1, "%d , %d , %d", &xx, &yy, &zz) == 3 )
+            sizes.push_back(std::vector<int>{xx, yy, zz});
+    }
+    return sizes;
+}
+
+//  Read the sizes from dftbatch-sizes.txt: lines of the form
+//  nbatch := b; szns := n; stridetype := s;
+
+static int readKey(const std::string& line, const std::string& key)
+{
+    size_t pos = line.find(key);
+    if ( pos == std::string::npos ) return -1;
+    pos = line.find(":=", pos);
+    return ( pos == std::string::npos ) ? -1 : atoi(line.c_str() + pos + 2);
+}
+
+static std::vector<std::vector<int>> readBatchSizes(const std::string& fname)
+{
+    std::vector<std::vector<int>> sizes;
+    std::ifstream ifs(fname);
+    std::string line;
+    while ( std::getline(ifs, line) ) {
+        size_t pos = line.find_first_not_of(" \t");
+        if ( pos == std::string::npos || line[pos] == '#' ) continue;
+        int nbatch = readKey(line, "nbatch");
+        int szns = readKey(line, "szns");
+        int stride = readKey(line, "stridetype");
+        if ( nbatch > 0 && szns > 0 && stride > 0 )
+            sizes.push_back(std::vector<int>{szns, nbatch, stride});
+    }
+    return sizes;
+}
+
+static std::string sizeString(const std::vector<int>& sizes, bool batch)
+{
+    std::ostringstream oss;
+    if ( batch )
+        oss << sizes.at(0) << "x" << sizes.at(1) << "/s" << sizes.at(2);
+    else
+        oss << sizes.at(0) << "x" << sizes.at(1) << "x" << sizes.at(2);
+    return oss.str();
+}
+
+//  Input, output and symbol buffers, large enough for a complex array of
+//  npts points; on GPU these live on the device
+
+class benchBuffers {
+public:
+    std::vector<void*> args;
+
+    benchBuffers(size_t npts) {
+        m_bytes = npts * sizeof(std::complex<double>);
+        std::vector<double> host(2 * npts);
+        for ( size_t i = 0; i < host.size(); i++ )
+            host[i] = 1 - ((double) rand()) / (double) (RAND_MAX/2);
+#if defined (FFTX_CUDA) || defined(FFTX_HIP)
+        DEVICE_MALLOC((void **)&m_X, m_bytes);
+        DEVICE_MALLOC((void **)&m_Y, m_bytes);
+        DEVICE_MALLOC((void **)&m_sym, m_bytes);
+        DEVICE_MEM_COPY(m_X, host.data(), m_bytes, MEM_COPY_HOST_TO_DEVICE);
+        DEVICE_MEM_COPY(m_sym, host.data(), m_bytes, MEM_COPY_HOST_TO_DEVICE);
+#else
+        m_X = new double[2 * npts];
+        m_Y = new double[2 * npts];
+        m_sym = new double[2 * npts];
+        std::copy(host.begin(), host.end(), (double*)m_X);
+        std::copy(host.begin(), host.end(), (double*)m_sym);
+#endif
+#if defined FFTX_CUDA
+        args = std::vector<void*>{&m_Y, &m_X, &m_sym};
+#else
+        args = std::vector<void*>{(void*)m_Y, (void*)m_X, (void*)m_sym};
+#endif
+    }
+
+    //  Host copy of the output
+    std::vector<std::complex<double>> output() const {
+        std::vector<std::complex<double>> host(m_bytes / sizeof(std::complex<double>));
+#if defined (FFTX_CUDA) || defined(FFTX_HIP)
+        DEVICE_MEM_COPY(host.data(), m_Y, m_bytes, MEM_COPY_DEVICE_TO_HOST);
+#else
+        std::copy((std::complex<double>*)m_Y, (std::complex<double>*)m_Y + host.size(), host.begin());
+#endif
+        return host;
+    }
+
+    //  Use the input of a_other, a set of buffers of the same size
+    void copyInput(const benchBuffers& a_other) {
+#if defined (FFTX_CUDA) || defined(FFTX_HIP)
+        DEVICE_MEM_COPY(m_X, a_other.m_X, m_bytes, MEM_COPY_DEVICE_TO_DEVICE);
+#else
+        std::copy((double*)a_other.m_X, (double*)a_other.m_X + m_bytes / sizeof(double), (double*)m_X);
+#endif
+    }
+
+    ~benchBuffers() {
+#if defined (FFTX_CUDA) || defined(FFTX_HIP)
+        DEVICE_FREE(m_X);
+        DEVICE_FREE(m_Y);
+        DEVICE_FREE(m_sym);
+#else
+        delete[] (double*)m_X;
+        delete[] (double*)m_Y;
+        delete[] (double*)m_sym;
+#endif
+    }
+
+private:
+    size_t m_bytes;
+    void * m_X;
+    void * m_Y;
+    void * m_sym;
+};
+
+static double msSince(std::chrono::high_resolution_clock::time_point start)
+{
+    std::chrono::duration<double, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
+    return duration.count();
+}
+
+template<class PROBLEM>
+static void measure(PROBLEM& prob, int iterations, benchResult& res)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    prob.transform();
+    res.cold = msSince(start);
+    res.plan = prob.getPlanTime();
+    res.init = prob.getInitTime();
+    for ( int itn = 0; itn < iterations; itn++ ) {
+        prob.transform();
+        res.kernel.push_back(prob.getTime());
+    }
+    computeStats(res);
+}
+
+//  Run one family on one size; returns false for an unknown family
+
+static bool benchOne(const std::string& family, const std::vector<int>& sizes,
+                     int iterations, benchResult& res)
+{
+    bool batch = ( family == "dftbat" || family == "idftbat" );
+    size_t npts = (size_t) sizes.at(0) * sizes.at(1) * ( batch ? 1 : sizes.at(2) );
+    double logn = std::log2((double) ( batch ? sizes.at(0) : npts ));
+    benchBuffers buf(npts);
+
+    res.family = family;
+    res.sizes = sizes;
+    res.flops = 5. * npts * logn;
+    if ( family == "mdprdft" || family == "imdprdft" )
+        res.flops *= 0.5;
+
+    if ( family == "mddft" ) {
+        MDDFTProblem prob(buf.args, sizes, family);
+        measure(prob, iterations, res);
+    }
+    else if ( family == "imddft" ) {
+        IMDDFTProblem prob(buf.args, sizes, family);
+        measure(prob, iterations, res);
+    }
+    else if ( family == "mdprdft" ) {
+        MDPRDFTProblem prob(buf.args, sizes, family);
+        measure(prob, iterations, res);
+    }
+    else if ( family == "imdprdft" ) {
+        IMDPRDFTProblem prob(buf.args, sizes, family);
+        measure(prob, iterations, res);
+    }
+    else if ( family == "rconv" ) {
+        RCONVProblem prob(buf.args, sizes, family);
+        measure(prob, iterations, res);
+    }
+    else if ( batch ) {
+        int sign = ( family == "dftbat" ) ? -1 : 1;
+        std::vector<int> bsizes{sizes.at(0), sizes.at(1), sizes.at(2), sign, sign};
+        DFTBATProblem prob(buf.args, bsizes, family);
+        measure(prob, iterations, res);
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+//  Self-check of a batch family: a batch of unstrided 1D DFTs (stridetype 1)
+//  is a 1D MDDFT (dftbat) or IMDDFT (idftbat) with a batch; returns the max
+//  difference between the two outputs
+
+static double checkBatch(const std::string& family, const std::vector<int>& sizes)
+{
+    int sign = ( family == "dftbat" ) ? -1 : 1;
+    size_t npts = (size_t) sizes.at(0) * sizes.at(1);
+    benchBuffers buf(npts), ref(npts);
+    ref.copyInput(buf);
+    DFTBATProblem prob(buf.args, std::vector<int>{sizes.at(0), sizes.at(1), 1, sign, sign}, family);
+    prob.transform();
+    std::vector<int> msizes = mdSizes(std::vector<int>{sizes.at(0)}, sizes.at(1));
+    if ( sign == -1 ) {
+        MDDFTProblem mdp(ref.args, msizes, "mddft");
+        mdp.transform();
+    }
+    else {
+        IMDDFTProblem imdp(ref.args, msizes, "imddft");
+        imdp.transform();
+    }
+    std::vector<std::complex<double>> out = buf.output(), refout = ref.output();
+    double err = 0.;
+    for ( size_t i = 0; i < npts; i++ )
+        err = std::max(err, std::abs(out[i] - refout[i]));
+    return err;
+}
+
+static void printTable(const std::vector<benchResult>& results)
+{
+    printf ( "%-9s %-16s %11s %11s %11s %11s %9s\n", "family", "size",
+             "cold(ms)", "min(ms)", "median(ms)", "p99(ms)", "GFLOPS" );
+    for ( const benchResult& res : results ) {
+        bool batch = ( res.family == "dftbat" || res.family == "idftbat" );
+        printf ( "%-9s %-16s %11.4f %11.4f %11.4f %11.4f %9.3f\n", res.family.c_str(),
+                 sizeString(res.sizes, batch).c_str(), res.cold, res.stats.min,
+                 res.stats.median, res.stats.p99, res.gflops );
+    }
+    fflush ( stdout );
+}
+
+static void writeJSON(const std::string& fname, const std::string& descrip, int iterations,
+                      const std::vector<benchResult>& results)
+{
+    FILE *fp = fopen ( fname.c_str(), "w" );
+    if ( fp == NULL ) {
+        printf ( "Cannot open %s for writing, no JSON output\n", fname.c_str() );
+        return;
+    }
+    fprintf ( fp, "{\n  \"backend\": \"%s\",\n  \"iterations\": %d,\n", descrip.c_str(), iterations );
+    fprintf ( fp, "  \"flops\": \"5 N log2(N) (complex), 2.5 N log2(N) (real)\",\n" );
+    fprintf ( fp, "  \"units\": \"ms\",\n  \"results\": [" );
+    for ( size_t ir = 0; ir < results.size(); ir++ ) {
+        const benchResult& res = results[ir];
+        fprintf ( fp, "%s\n    { \"family\": \"%s\", \"sizes\": [", ( ir ? "," : "" ), res.family.c_str() );
+        for ( size_t is = 0; is < res.sizes.size(); is++ )
+            fprintf ( fp, "%s%d", ( is ? ", " : "" ), res.sizes[is] );
+        fprintf ( fp, "],\n      \"cold\": %.6e, \"min\": %.6e, \"median\": %.6e, \"p99\": %.6e,\n",
+                  res.cold, res.stats.min, res.stats.median, res.stats.p99 );
+        fprintf ( fp, "      \"plan\": %.6e, \"init\": %.6e, \"execute\": %.6e,\n",
+                  res.plan, res.init, res.execute );
+        fprintf ( fp, "      \"flops\": %.6e, \"gflops\": %.6e }", res.flops, res.gflops );
+    }
+    fprintf ( fp, "\n  ]\n}\n" );
+    fclose ( fp );
+}
+
+//  Read the results of an earlier run from its JSON output
+
+static double jsonNumber(const std::string& block, const char * key)
+{
+    size_t pos = block.find("\"" + std::string(key) + "\":");
+    return ( pos == std::string::npos ) ? 0. : atof(block.c_str() + block.find(':', pos) + 1);
+}
+
+static bool readBaseline(const std::string& fname, std::vector<benchResult>& base)
+{
+    std::ifstream ifs(fname);
+    if ( !ifs ) return false;
+    std::string text ( ( std::istreambuf_iterator<char>(ifs) ),
+                       ( std::istreambuf_iterator<char>() ) );
+    const std::string tag = "\"family\": \"";
+    for ( size_t pos = text.find(tag); pos != std::string::npos; pos = text.find(tag, pos) ) {
+        pos += tag.size();
+        std::string block = text.substr(pos, text.find('}', pos) - pos);
+        benchResult res;
+        res.family = block.substr(0, block.find('"'));
+        size_t brk = block.find('[');
+        std::istringstream sizes(block.substr(brk + 1, block.find(']') - brk - 1));
+        std::string val;
+        while ( std::getline(sizes, val, ',') )
+            res.sizes.push_back(atoi(val.c_str()));
+        res.cold = jsonNumber(block, "cold");
+        res.plan = jsonNumber(block, "plan");
+        res.init = jsonNumber(block, "init");
+        res.execute = jsonNumber(block, "execute");
+        base.push_back(res);
+    }
+    return true;
+}
+
+//  Compare against the baseline; returns the number of regressions.  The setup
+//  time (plan + init) comes from the single cold run, whose noise (first touch
+//  of the buffers, cache state) is of the order of one execution, so besides
+//  exceeding the threshold it has to grow by more than floorms milliseconds
+//  and more than the baseline execute time to count.
+
+static int checkBaseline(std::vector<benchResult>& results, const std::vector<benchResult>& base,
+                         int iterations, double threshold, double floorms)
+{
+    static const char * phases[] = { "plan", "init", "execute" };
+    int failed = 0, checked = 0;
+    double limit = 1. + threshold / 100.;
+
+    printf ( "Comparing against baseline, threshold %.1f%%\n", threshold );
+    for ( benchResult& res : results ) {
+        auto ref = std::find_if(base.begin(), base.end(), [&res](const benchResult& b) {
+            return b.family == res.family && b.sizes == res.sizes; });
+        bool batch = ( res.family == "dftbat" || res.family == "idftbat" );
+        std::string label = res.family + " " + sizeString(res.sizes, batch);
+        if ( ref == base.end() ) {
+            printf ( "  %-26s not in baseline ... skipped\n", label.c_str() );
+            continue;
+        }
+        checked++;
+        double setup = res.plan + res.init, refsetup = ref->plan + ref->init;
+        bool slowexec = ( res.execute > ref->execute * limit );
+        if ( slowexec ) {
+            benchResult again;
+            benchOne(res.family, res.sizes, iterations, again);
+            res.execute = std::min(res.execute, again.execute);
+            slowexec = ( res.execute > ref->execute * limit );
+        }
+        bool slowsetup = ( setup > refsetup * limit &&
+                           setup - refsetup > std::max(floorms, ref->execute) );
+        if ( !slowexec && !slowsetup ) continue;
+
+        failed++;
+        double cur[3] = { res.plan, res.init, res.execute };
+        double old[3] = { ref->plan, ref->init, ref->execute };
+        int worst = slowexec ? 2 : ( cur[0] - old[0] > cur[1] - old[1] ? 0 : 1 );
+        printf ( "  %-26s SLOWER, attributed to %s time\n", label.c_str(), phases[worst] );
+        for ( int ip = 0; ip < 3; ip++ ) {
+            double pct = ( old[ip] > 0. ) ? 100. * (cur[ip] - old[ip]) / old[ip] : 0.;
+            printf ( "      %-8s %11.4f ms -> %11.4f ms (%+.1f%%)\n", phases[ip], old[ip], cur[ip], pct );
+        }
+    }
+    printf ( "%d of %d transforms slower than baseline\n", failed, checked );
+    return failed;
+}
+
+int main(int argc, char* argv[])
+{
+    int iterations = 20;
+    char *prog = argv[0];
+#if defined (FFTX_CUDA) || defined(FFTX_HIP)
+    std::string cubefile = FFTX_BENCH_SIZES_DIR "/cube-sizes-gpu.txt";
+#else
+    std::string cubefile = FFTX_BENCH_SIZES_DIR "/cube-sizes-cpu.txt";
+#endif
+    std::string batchfile = FFTX_BENCH_SIZES_DIR "/dftbatch-sizes.txt";
+    std::string jsonfile = "fftx_bench.json";
+    std::string famlist;
+    std::string basefile;
+    double threshold = 10.;
+    double floorms = 1.;
+    bool record = false;
+
+    while ( argc > 1 && argv[1][0] == '-' ) {
+        switch ( argv[1][1] ) {
+        case 'i':
+            argv++, argc--;
+            iterations = atoi ( argv[1] );
+            break;
+        case 'c':
+            argv++, argc--;
+            cubefile = argv[1];
+            break;
+        case 'b':
+            argv++, argc--;
+            batchfile = argv[1];
+            break;
+        case 'f':
+            argv++, argc--;
+            famlist = argv[1];
+            break;
+        case 'o':
+            argv++, argc--;
+            jsonfile = argv[1];
+            break;
+        case 'g':
+            argv++, argc--;
+            basefile = argv[1];
+            break;
+        case 't':
+            argv++, argc--;
+            threshold = atof ( argv[1] );
+            break;
+        case 'm':
+            argv++, argc--;
+            floorms = atof ( argv[1] );
+            break;
+        case 'r':
+            record = true;
+            break;
+        case 'h':
+            printf ( "Usage: %s: [ -i iterations ] [ -c cube sizes file ] [ -b dftbatch sizes file ]\n"
+                     "       [ -f family[,family...] ] [ -o JSON output file ]\n"
+                     "       [ -g baseline file [ -t threshold percent ] [ -m setup floor ms ] [ -r (record baseline) ] ]\n"
+                     "       [ -h (print help message) ]\n"
+                     "Families: mddft imddft mdprdft imdprdft rconv dftbat idftbat (default: all)\n", argv[0] );
+            exit (0);
+        default:
+            printf ( "%s: unknown argument: %s ... ignored\n", prog, argv[1] );
+        }
+        argv++, argc--;
+    }
+    if ( iterations < 1 ) iterations = 1;
+
+#if defined FFTX_CUDA
+    CUdevice cuDevice;
+    CUcontext context;
+    cuInit(0);
+    cuDeviceGet(&cuDevice, 0);
+    cuCtxCreate(&context, 0, cuDevice);
+    std::string descrip = "NVIDIA GPU";
+#elif defined FFTX_HIP
+    std::string descrip = "AMD GPU";
+#else
+    std::string descrip = "CPU";
+#endif
+
+    std::vector<std::string> families;
+    std::istringstream iss(famlist);
+    std::string fam;
+    while ( std::getline(iss, fam, ',') )
+        if ( !fam.empty() ) families.push_back(fam);
+    if ( families.empty() ) {
+        families.assign(std::begin(cubeFamilies), std::end(cubeFamilies));
+        families.insert(families.end(), std::begin(batchFamilies), std::end(batchFamilies));
+    }
+
+    std::vector<std::vector<int>> cubes = readCubeSizes(cubefile);
+    std::vector<std::vector<int>> batches = readBatchSizes(batchfile);
+    printf ( "%s: %d warm iterations on %s, %d cube sizes (%s), %d batch sizes (%s)\n",
+             prog, iterations, descrip.c_str(), (int) cubes.size(), cubefile.c_str(),
+             (int) batches.size(), batchfile.c_str() );
+
+    std::vector<benchResult> results;
+    for ( const std::string& family : families ) {
+        bool batch = ( family == "dftbat" || family == "idftbat" );
+        for ( const std::vector<int>& sizes : ( batch ? batches : cubes ) ) {
+            benchResult res;
+            if ( !benchOne(family, sizes, iterations, res) ) {
+                printf ( "%s: unknown family: %s ... ignored\n", prog, family.c_str() );
+                break;
+            }
+            results.push_back(res);
+        }
+    }
+
+    printTable(results);
+    writeJSON(jsonfile, descrip, iterations, results);
+    printf ( "%s: results written to %s\n", prog, jsonfile.c_str() );
+
+    //  The batch families are checked against MDDFT / IMDDFT on the first batch size
+    int failed = 0;
+    for ( const std::string& family : families ) {
+        if ( ( family != "dftbat" && family != "idftbat" ) || batches.empty() ) continue;
+        double err = checkBatch(family, batches.front());
+        bool ok = ( err < 1.e-8 );
+        printf ( "%s: self-check of %s %dx%d against %s: max error %E ... %s\n", prog, family.c_str(),
+                 batches.front().at(0), batches.front().at(1), ( family == "dftbat" ? "mddft" : "imddft" ),
+                 err, ( ok ? "PASSED" : "FAILED" ) );
+        if ( !ok ) failed++;
+    }
+
+    bool skipped = false;
+    if ( !basefile.empty() ) {
+        std::vector<benchResult> base;
+        if ( !record && readBaseline(basefile, base) ) {
+            failed += checkBaseline(results, base, iterations, threshold, floorms);
+        }
+        else {
+            skipped = !record;
+            if ( skipped )
+                printf ( "%s: no baseline in %s, nothing compared ... skipped\n", prog, basefile.c_str() );
+            writeJSON(basefile, descrip, iterations, results);
+            printf ( "%s: baseline recorded in %s\n", prog, basefile.c_str() );
+        }
+    }
+
+    printf("%s: All done, exiting\n", prog);
+    if ( failed )
+        return 1;
+    return ( skipped ? noBaseline : 0 );
+}
@@ -0,0 +1,122 @@
+#include <cmath> // Without this, abs is the wrong function!
+#include <complex>
+#include <vector>
+
+#include "interface.hpp"
+#include "transformlib.hpp"
+
+// Max difference between the box of a_full (extents a_n) at a_lo and a_box (extents a_m).
+static double boxError ( const std::complex<double> *a_full, const std::complex<double> *a_box,
+                         const std::vector<int>& a_n, const int *a_lo, const int *a_m )
+{
+    double err = 0.;
+    for ( int i = 0; i < a_m[0]; i++ )
+        for ( int j = 0; j < a_m[1]; j++ )
+            for ( int k = 0; k < a_m[2]; k++ ) {
+                size_t f = ((size_t)(i + a_lo[0]) * a_n[1] + j + a_lo[1]) * a_n[2] + k + a_lo[2];
+                size_t b = ((size_t)i * a_m[1] + j) * a_m[2] + k;
+                err = std::max ( err, std::abs ( a_full[f] - a_box[b] ) );
+            }
+    return err;
+}
+
+int main(int argc, char* argv[])
+{
+    int mm = 24, nn = 32, kk = 40; // default cube dimensions
+    int cut = 4;                   // the box is the first 1/cut along each axis
+    char *prog = argv[0];
+    int baz = 0;
+
+    while ( argc > 1 && argv[1][0] == '-' ) {
+        switch ( argv[1][1] ) {
+        case 'c':
+            argv++, argc--;
+            cut = atoi ( argv[1] );
+            break;
+        case 's':
+            argv++, argc--;
+            mm = atoi ( argv[1] );
+            while ( argv[1][baz] != 'x' ) baz++;
+            baz++ ;
+            nn = atoi ( & argv[1][baz] );
+            while ( argv[1][baz] != 'x' ) baz++;
+            baz++ ;
+            kk = atoi ( & argv[1][baz] );
+            break;
+        case 'h':
+            printf ( "Usage: %s: [ -c cut ] [ -s MMxNNxKK ] [ -h (print help message) ]\n", argv[0] );
+            exit (0);
+        default:
+            printf ( "%s: unknown argument: %s ... ignored\n", prog, argv[1] );
+        }
+        argv++, argc--;
+    }
+
+    std::vector<int> sizes{ mm, nn, kk };
+    int m[3] = { std::max(mm/cut, 1), std::max(nn/cut, 1), std::max(kk/cut, 1) };
+    size_t npts = (size_t) mm * nn * kk;
+    double tol = 1.e-14 * npts;
+
+    std::vector<std::complex<double>> X ( npts ), Y ( npts );
+    for ( auto& v : X )
+        v = std::complex<double> ( 1 - ((double) rand()) / (double) (RAND_MAX/2),
+                                   1 - ((double) rand()) / (double) (RAND_MAX/2) );
+    MDDFTProblem mdp ( std::vector<void*>{ Y.data(), X.data(), nullptr }, sizes, "mddft" );
+    mdp.transform();
+
+    std::vector<int> half{ mm, nn, kk/2+1 };
+    std::vector<double> R ( npts );
+    for ( auto& v : R )
+        v = 1 - ((double) rand()) / (double) (RAND_MAX/2);
+    std::vector<std::complex<double>> S ( (size_t) mm * nn * half[2] );
+    MDPRDFTProblem rp ( std::vector<void*>{ S.data(), R.data(), nullptr }, sizes, "mdprdft" );
+    rp.transform();
+
+    // the low-wavenumber box at the origin, then one with a nonzero corner
+    double err = 0.;
+    int corners[2][3] = { { 0, 0, 0 }, { 3, 5, 7 } };
+    for ( int c = 0; c < 2; c++ ) {
+        // complex input: the box of the full MDDFT
+        int lo[3];
+        for ( int d = 0; d < 3; d++ )
+            lo[d] = std::min ( corners[c][d], sizes[d] - m[d] );
+        fftx::box_t<3> box ( fftx::point_t<3>({{ lo[0], lo[1], lo[2] }}),
+                             fftx::point_t<3>({{ lo[0]+m[0]-1, lo[1]+m[1]-1, lo[2]+m[2]-1 }}) );
+        std::vector<std::complex<double>> Ybox ( m[0] * m[1] * m[2] );
+        MDDFTBoxProblem bp ( std::vector<void*>{ Ybox.data(), X.data(), nullptr }, sizes, box, "mddft_box" );
+        bp.transform();
+        double errc = boxError ( Y.data(), Ybox.data(), sizes, lo, m );
+        printf ( "MDDFT %dx%dx%d box of %dx%dx%d at (%d, %d, %d): max difference %E\n",
+                 mm, nn, kk, m[0], m[1], m[2], lo[0], lo[1], lo[2], errc );
+
+        // real input: the same box, kept inside the half spectrum
+        int mh[3] = { m[0], m[1], std::min ( m[2], half[2] ) };
+        lo[2] = std::min ( corners[c][2], half[2] - mh[2] );
+        fftx::box_t<3> hbox ( fftx::point_t<3>({{ lo[0], lo[1], lo[2] }}),
+                              fftx::point_t<3>({{ lo[0]+mh[0]-1, lo[1]+mh[1]-1, lo[2]+mh[2]-1 }}) );
+        std::vector<std::complex<double>> Sbox ( mh[0] * mh[1] * mh[2] );
+        MDPRDFTBoxProblem rbp ( std::vector<void*>{ Sbox.data(), R.data(), nullptr }, sizes, hbox, "mdprdft_box" );
+        rbp.transform();
+        double errr = boxError ( S.data(), Sbox.data(), half, lo, mh );
+        printf ( "MDPRDFT %dx%dx%d box of %dx%dx%d at (%d, %d, %d): max difference %E\n",
+                 mm, nn, kk, mh[0], mh[1], mh[2], lo[0], lo[1], lo[2], errr );
+        err = std::max ( err, std::max ( errc, errr ) );
+    }
+
+    // a box past the end of the half spectrum is rejected
+    bool rejected = false;
+    try {
+        fftx::box_t<3> bad ( fftx::point_t<3>({{ 0, 0, 0 }}),
+                             fftx::point_t<3>({{ mm-1, nn-1, half[2] }}) );
+        MDPRDFTBoxProblem rbad ( std::vector<void*>{ S.data(), R.data(), nullptr }, sizes, bad, "mdprdft_box" );
+    }
+    catch ( const std::out_of_range& ) {
+        rejected = true;
+    }
+    printf ( "box outside the half spectrum %s\n", rejected ? "rejected" : "NOT rejected" );
+
+    bool ok = ( err < tol && rejected );
+    printf ( "%s: %s\n", prog, ok ? "PASSED" : "FAILED" );
+    printf ( "%s: All done, exiting\n", prog );
+    return ok ? 0 : 1;
+}
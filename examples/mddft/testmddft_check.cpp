@@ -0,0 +1,103 @@
+#include <cmath> // Without this, abs is the wrong function!
+#include <complex>
+#include <vector>
+
+#include "interface.hpp"
+#include "transformlib.hpp"
+
+typedef std::complex<double> cplx;
+
+// MDDFT on the native engine, with one output value corrupted after the transform.
+class CorruptMDDFTProblem: public MDDFTProblem {
+public:
+    using MDDFTProblem::MDDFTProblem;
+    bool nativeTransform() {
+        MDDFTProblem::nativeTransform();
+        ((double*)args.at(0))[1] += 1.;
+        return true;
+    }
+protected:
+    bool planGenerated() { return false; }
+};
+
+// Run a_prob twice with every call checked; returns the checks that failed.
+static long runChecked ( FFTXProblem& a_prob, const char * a_label )
+{
+    fftx_check::checker& chk = fftx_check::checker::instance();
+    long checked = chk.checked(), failed = chk.failed();
+    a_prob.setCheckRate ( 1 );
+    for ( int itn = 0; itn < 2; itn++ ) {
+        a_prob.transform();
+        chk.flush();
+    }
+    printf ( "%s: %ld calls checked, %ld failed\n", a_label, chk.checked() - checked, chk.failed() - failed );
+    return chk.failed() - failed;
+}
+
+int main(int argc, char* argv[])
+{
+    int mm = 12, nn = 10, kk = 8; // default cube dimensions
+    int batch = 2;
+    char *prog = argv[0];
+    int baz = 0;
+
+    while ( argc > 1 && argv[1][0] == '-' ) {
+        switch ( argv[1][1] ) {
+        case 's':
+            argv++, argc--;
+            mm = atoi ( argv[1] );
+            while ( argv[1][baz] != 'x' ) baz++;
+            baz++ ;
+            nn = atoi ( & argv[1][baz] );
+            while ( argv[1][baz] != 'x' ) baz++;
+            baz++ ;
+            kk = atoi ( & argv[1][baz] );
+            break;
+        case 'b':
+            argv++, argc--;
+            batch = atoi ( argv[1] );
+            break;
+        case 'h':
+            printf ( "Usage: %s: [ -s MMxNNxKK ] [ -b batch ] [ -h (print help message) ]\n", argv[0] );
+            exit (0);
+        default:
+            printf ( "%s: unknown argument: %s ... ignored\n", prog, argv[1] );
+        }
+        argv++, argc--;
+    }
+
+    std::vector<int> sizes = mdSizes ( std::vector<int>{ mm, nn, kk }, batch );
+    size_t npts = (size_t) mm * nn * kk * batch;
+    size_t nspec = npts / kk * ( kk/2 + 1 );
+    std::vector<cplx> X ( npts ), Y ( npts ), Z ( npts ), S ( nspec );
+    std::vector<double> R ( npts ), Rback ( npts );
+    for ( size_t i = 0; i < npts; i++ ) {
+        X[i] = cplx ( 1 - ((double) rand()) / (double) (RAND_MAX/2),
+                      1 - ((double) rand()) / (double) (RAND_MAX/2) );
+        R[i] = X[i].real();
+    }
+
+    // every transform with checked mode on: no check may fail
+    long failed = 0;
+    MDDFTProblem mdp ( std::vector<void*>{ Y.data(), X.data(), nullptr }, sizes, "mddft" );
+    failed += runChecked ( mdp, "MDDFT" );
+    IMDDFTProblem imdp ( std::vector<void*>{ Z.data(), Y.data(), nullptr }, sizes, "imddft" );
+    failed += runChecked ( imdp, "IMDDFT" );
+    MDPRDFTProblem rp ( std::vector<void*>{ S.data(), R.data(), nullptr }, sizes, "mdprdft" );
+    failed += runChecked ( rp, "MDPRDFT" );
+    IMDPRDFTProblem irp ( std::vector<void*>{ Rback.data(), S.data(), nullptr }, sizes, "imdprdft" );
+    failed += runChecked ( irp, "IMDPRDFT" );
+    MDPRDFTProblem rpcol ( std::vector<void*>{ S.data(), R.data(), nullptr }, sizes, "mdprdft" );
+    rpcol.setLayout ( fftx::layout_t ( false, FFTX_COMPLEX_TRUNC_LAST ) );
+    failed += runChecked ( rpcol, "MDPRDFT column major" );
+
+    // a corrupted output: every check must fail
+    CorruptMDDFTProblem bad ( std::vector<void*>{ Y.data(), X.data(), nullptr }, sizes, "mddft" );
+    long caught = runChecked ( bad, "MDDFT with a corrupted output" );
+
+    bool ok = ( failed == 0 && caught == 2 );
+    printf ( "%s: checks of correct transforms failed %ld times, corrupted output caught %ld of 2 times ... %s\n",
+             prog, failed, caught, ok ? "PASSED" : "FAILED" );
+    printf ( "%s: All done, exiting\n", prog );
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+#include <cmath> // Without this, abs is the wrong function!
+#include <complex>
+#include <vector>
+
+#include "interface.hpp"
+#include "transformlib.hpp"
+
+typedef std::complex<double> cplx;
+
+// Max difference between the components of two fields over their box.
+template<typename T>
+static double maxDiff ( const fftx::field_t<3, T>& a, const fftx::field_t<3, T>& b, double a_scale = 1. )
+{
+    double err = 0.;
+    for ( int c = 0; c < a.components(); c++ )
+        for ( size_t i = 0; i < a.box().size(); i++ ) {
+            fftx::point_t<3> p = fftx::pointFromPositionBox ( i, a.box() );
+            err = std::max ( err, std::abs ( a ( c, p ) * a_scale - b ( c, p ) ) );
+        }
+    return err;
+}
+
+static const char * orderName ( fftx::componentOrder a_order )
+{
+    return ( a_order == fftx::AOS ) ? "AOS" : "SOA";
+}
+
+int main(int argc, char* argv[])
+{
+    int mm = 12, nn = 10, kk = 8; // default cube dimensions
+    int ncomp = 3;
+    char *prog = argv[0];
+    int baz = 0;
+
+    while ( argc > 1 && argv[1][0] == '-' ) {
+        switch ( argv[1][1] ) {
+        case 's':
+            argv++, argc--;
+            mm = atoi ( argv[1] );
+            while ( argv[1][baz] != 'x' ) baz++;
+            baz++ ;
+            nn = atoi ( & argv[1][baz] );
+            while ( argv[1][baz] != 'x' ) baz++;
+            baz++ ;
+            kk = atoi ( & argv[1][baz] );
+            break;
+        case 'c':
+            argv++, argc--;
+            ncomp = atoi ( argv[1] );
+            break;
+        case 'h':
+            printf ( "Usage: %s: [ -s MMxNNxKK ] [ -c components ] [ -h (print help message) ]\n", argv[0] );
+            exit (0);
+        default:
+            printf ( "%s: unknown argument: %s ... ignored\n", prog, argv[1] );
+        }
+        argv++, argc--;
+    }
+
+    // ncomp components (e.g. Ex, Ey, Ez) over one box, transformed as a batch
+    fftx::box_t<3> domain ( fftx::point_t<3> ( { { 0, 0, 0 } } ),
+                            fftx::point_t<3> ( { { mm-1, nn-1, kk-1 } } ) );
+    fftx::box_t<3> spectrum ( fftx::point_t<3> ( { { 0, 0, 0 } } ),
+                              fftx::point_t<3> ( { { mm-1, nn-1, kk/2 } } ) );
+    std::vector<int> sizes = mdSizes ( std::vector<int>{ mm, nn, kk }, ncomp );
+    size_t npts = domain.size();
+
+    fftx::field_t<3, cplx> Xsoa ( domain, ncomp ), Ysoa ( domain, ncomp );
+    for ( size_t i = 0; i < npts * ncomp; i++ )
+        Xsoa.data()[i] = cplx ( 1 - ((double) rand()) / (double) (RAND_MAX/2),
+                                1 - ((double) rand()) / (double) (RAND_MAX/2) );
+    MDDFTProblem mdpRef ( std::vector<void*>{ Ysoa.data(), Xsoa.data(), nullptr }, sizes, "mddft" );
+    mdpRef.transform();
+
+    // complex DFT from and to each component order, against the SOA batch
+    for ( int out = 0; out < 2; out++ )
+        for ( int in = 0; in < 2; in++ ) {
+            fftx::componentOrder outOrder = (fftx::componentOrder) out, inOrder = (fftx::componentOrder) in;
+            fftx::field_t<3, cplx> X ( domain, ncomp, inOrder ), Y ( domain, ncomp, outOrder ),
+                Z ( domain, ncomp, inOrder );
+            for ( int c = 0; c < ncomp; c++ )
+                for ( size_t i = 0; i < npts; i++ ) {
+                    fftx::point_t<3> p = fftx::pointFromPositionBox ( i, domain );
+                    X ( c, p ) = Xsoa ( c, p );
+                }
+            fftx::layout_t layout ( FFTX_ROW_MAJOR_ORDER, FFTX_COMPLEX_TRUNC_LAST, outOrder, inOrder );
+            MDDFTProblem mdp ( std::vector<void*>{ Y.data(), X.data(), nullptr }, sizes, "mddft" );
+            mdp.setLayout ( layout );
+            mdp.transform();
+            IMDDFTProblem imdp ( std::vector<void*>{ Z.data(), Y.data(), nullptr }, sizes, "imddft" );
+            imdp.setLayout ( fftx::layout_t ( FFTX_ROW_MAJOR_ORDER, FFTX_COMPLEX_TRUNC_LAST, inOrder, outOrder ) );
+            imdp.transform();
+            printf ( "MDDFT %dx%dx%d, %d components %s to %s: max error %E, inverse max error %E\n",
+                     mm, nn, kk, ncomp, orderName ( inOrder ), orderName ( outOrder ),
+                     maxDiff ( Y, Ysoa ), maxDiff ( Z, X, 1. / npts ) );
+        }
+
+    // real-to-complex DFT of a real field with interleaved components, and back
+    fftx::field_t<3, double> Rsoa ( domain, ncomp ), R ( domain, ncomp, fftx::AOS ), Rback ( domain, ncomp, fftx::AOS );
+    for ( int c = 0; c < ncomp; c++ )
+        for ( size_t i = 0; i < npts; i++ ) {
+            fftx::point_t<3> p = fftx::pointFromPositionBox ( i, domain );
+            R ( c, p ) = Rsoa ( c, p ) = Xsoa ( c, p ).real();
+        }
+    fftx::field_t<3, cplx> Sref ( spectrum, ncomp );
+    MDPRDFTProblem rpRef ( std::vector<void*>{ Sref.data(), Rsoa.data(), nullptr }, sizes, "mdprdft" );
+    rpRef.transform();
+    for ( int out = 0; out < 2; out++ ) {
+        fftx::componentOrder specOrder = (fftx::componentOrder) out;
+        fftx::field_t<3, cplx> S ( spectrum, ncomp, specOrder );
+        MDPRDFTProblem rp ( std::vector<void*>{ S.data(), R.data(), nullptr }, sizes, "mdprdft" );
+        rp.setLayout ( fftx::layout_t ( FFTX_ROW_MAJOR_ORDER, FFTX_COMPLEX_TRUNC_LAST, specOrder, fftx::AOS ) );
+        rp.transform();
+        IMDPRDFTProblem irp ( std::vector<void*>{ Rback.data(), S.data(), nullptr }, sizes, "imdprdft" );
+        irp.setLayout ( fftx::layout_t ( FFTX_ROW_MAJOR_ORDER, FFTX_COMPLEX_TRUNC_LAST, fftx::AOS, specOrder ) );
+        irp.transform();
+
+        // component views of the interleaved field read the same points
+        double errView = 0.;
+        for ( int c = 0; c < ncomp; c++ ) {
+            fftx::array_t<3, double> v = Rback.component ( c );
+            for ( size_t i = 0; i < npts; i++ ) {
+                fftx::point_t<3> p = fftx::pointFromPositionBox ( i, domain );
+                errView = std::max ( errView, std::abs ( v.m_data.local()[v.offset ( p )] - Rback ( c, p ) ) );
+            }
+        }
+        printf ( "MDPRDFT %dx%dx%d, %d components AOS to %s: max error %E, inverse max error %E, view error %E\n",
+                 mm, nn, kk, ncomp, orderName ( specOrder ), maxDiff ( S, Sref ),
+                 maxDiff ( Rback, R, 1. / npts ), errView );
+    }
+
+    printf ( "%s: All done, exiting\n", prog );
+    return 0;
+}
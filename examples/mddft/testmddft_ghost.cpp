@@ -0,0 +1,147 @@
+#include <cmath> // Without this, abs is the wrong function!
+#include <complex>
+#include <vector>
+
+#include "interface.hpp"
+#include "transformlib.hpp"
+
+typedef std::complex<double> cplx;
+
+// Element strides of a strided view, as setStrides takes them.
+template<int DIM, typename T>
+static std::vector<size_t> viewStrides ( const fftx::array_t<DIM, T>& a_view )
+{
+    std::array<size_t, DIM> s = a_view.strides();
+    return std::vector<size_t> ( s.begin(), s.end() );
+}
+
+// Max difference between the points of a_view and the packed array a_ref over a_box.
+template<typename T>
+static double maxDiff ( const fftx::array_t<3, T>& a_view, const T *a_ref, const fftx::box_t<3>& a_box,
+                        double a_scale = 1. )
+{
+    double err = 0.;
+    for ( size_t i = 0; i < a_box.size(); i++ ) {
+        fftx::point_t<3> p = fftx::pointFromPositionBox ( i, a_box );
+        err = std::max ( err, std::abs ( a_view.m_data.local()[a_view.offset ( p )] * a_scale - a_ref[i] ) );
+    }
+    return err;
+}
+
+// Number of points of a_array outside a_box that differ from a_value.
+template<typename T>
+static size_t ghostsChanged ( const fftx::array_t<3, T>& a_array, const fftx::box_t<3>& a_box, T a_value )
+{
+    size_t changed = 0;
+    for ( size_t i = 0; i < a_array.m_domain.size(); i++ ) {
+        fftx::point_t<3> p = fftx::pointFromPositionBox ( i, a_array.m_domain );
+        if ( !fftx::isInBox ( p, a_box ) && a_array.m_data.local()[i] != a_value )
+            changed++;
+    }
+    return changed;
+}
+
+int main(int argc, char* argv[])
+{
+    int mm = 12, nn = 10, kk = 8; // default cube dimensions
+    int ghosts = 2;
+    char *prog = argv[0];
+    int baz = 0;
+
+    while ( argc > 1 && argv[1][0] == '-' ) {
+        switch ( argv[1][1] ) {
+        case 's':
+            argv++, argc--;
+            mm = atoi ( argv[1] );
+            while ( argv[1][baz] != 'x' ) baz++;
+            baz++ ;
+            nn = atoi ( & argv[1][baz] );
+            while ( argv[1][baz] != 'x' ) baz++;
+            baz++ ;
+            kk = atoi ( & argv[1][baz] );
+            break;
+        case 'g':
+            argv++, argc--;
+            ghosts = atoi ( argv[1] );
+            break;
+        case 'h':
+            printf ( "Usage: %s: [ -s MMxNNxKK ] [ -g ghosts ] [ -h (print help message) ]\n", argv[0] );
+            exit (0);
+        default:
+            printf ( "%s: unknown argument: %s ... ignored\n", prog, argv[1] );
+        }
+        argv++, argc--;
+    }
+
+    // fields of mm x nn x kk points with ghosts layers on each side
+    fftx::box_t<3> interior ( fftx::point_t<3> ( { { 0, 0, 0 } } ),
+                              fftx::point_t<3> ( { { mm-1, nn-1, kk-1 } } ) );
+    fftx::box_t<3> ghosted ( fftx::point_t<3> ( { { -ghosts, -ghosts, -ghosts } } ),
+                             fftx::point_t<3> ( { { mm-1+ghosts, nn-1+ghosts, kk-1+ghosts } } ) );
+    std::vector<int> sizes{ mm, nn, kk };
+    size_t npts = interior.size();
+    const cplx cfill ( -7., 7. );
+    const double rfill = -7.;
+
+    fftx::array_t<3, cplx> X ( ghosted ), Y ( ghosted ), Z ( ghosted );
+    for ( size_t i = 0; i < ghosted.size(); i++ ) {
+        X.m_data.local()[i] = cplx ( 1 - ((double) rand()) / (double) (RAND_MAX/2),
+                                     1 - ((double) rand()) / (double) (RAND_MAX/2) );
+        Y.m_data.local()[i] = Z.m_data.local()[i] = cfill;
+    }
+    fftx::array_t<3, cplx> Xin = X.subArray ( fftx::box_t<3> ( interior ) );
+    fftx::array_t<3, cplx> Yin = Y.subArray ( fftx::box_t<3> ( interior ) );
+    fftx::array_t<3, cplx> Zin = Z.subArray ( fftx::box_t<3> ( interior ) );
+
+    // reference: the transform of the interior, packed
+    std::vector<cplx> packed ( npts ), ref ( npts );
+    for ( size_t i = 0; i < npts; i++ )
+        packed[i] = Xin.m_data.local()[Xin.offset ( fftx::pointFromPositionBox ( i, interior ) )];
+    MDDFTProblem mdpRef ( std::vector<void*>{ ref.data(), packed.data(), nullptr }, sizes, "mddft" );
+    mdpRef.transform();
+
+    MDDFTProblem mdp ( std::vector<void*>{ Yin.m_data.local(), Xin.m_data.local(), nullptr }, sizes, "mddft" );
+    mdp.setStrides ( 0, viewStrides ( Yin ) );
+    mdp.setStrides ( 1, viewStrides ( Xin ) );
+    mdp.transform();
+    IMDDFTProblem imdp ( std::vector<void*>{ Zin.m_data.local(), Yin.m_data.local(), nullptr }, sizes, "imddft" );
+    imdp.setStrides ( 0, viewStrides ( Zin ) );
+    imdp.setStrides ( 1, viewStrides ( Yin ) );
+    imdp.transform();
+    printf ( "MDDFT %dx%dx%d, %d ghosts: max error %E, inverse max error %E, ghosts changed %zu\n",
+             mm, nn, kk, ghosts, maxDiff ( Yin, ref.data(), interior ),
+             maxDiff ( Zin, packed.data(), interior, 1. / npts ),
+             ghostsChanged ( Y, interior, cfill ) + ghostsChanged ( Z, interior, cfill ) );
+
+    // real-to-complex transform of the interior of a real field, to a packed spectrum, and back
+    fftx::array_t<3, double> R ( ghosted ), Rback ( ghosted );
+    for ( size_t i = 0; i < ghosted.size(); i++ ) {
+        R.m_data.local()[i] = X.m_data.local()[i].real();
+        Rback.m_data.local()[i] = rfill;
+    }
+    fftx::array_t<3, double> Rin = R.subArray ( fftx::box_t<3> ( interior ) );
+    fftx::array_t<3, double> Rbackin = Rback.subArray ( fftx::box_t<3> ( interior ) );
+    std::vector<double> rpacked ( npts );
+    for ( size_t i = 0; i < npts; i++ )
+        rpacked[i] = packed[i].real();
+    size_t nspec = npts / kk * ( kk/2 + 1 );
+    std::vector<cplx> S ( nspec ), Sref ( nspec );
+    MDPRDFTProblem rpRef ( std::vector<void*>{ Sref.data(), rpacked.data(), nullptr }, sizes, "mdprdft" );
+    rpRef.transform();
+
+    MDPRDFTProblem rp ( std::vector<void*>{ S.data(), Rin.m_data.local(), nullptr }, sizes, "mdprdft" );
+    rp.setStrides ( 1, viewStrides ( Rin ) );
+    rp.transform();
+    IMDPRDFTProblem irp ( std::vector<void*>{ Rbackin.m_data.local(), S.data(), nullptr }, sizes, "imdprdft" );
+    irp.setStrides ( 0, viewStrides ( Rbackin ) );
+    irp.transform();
+    double errR = 0.;
+    for ( size_t i = 0; i < nspec; i++ )
+        errR = std::max ( errR, std::abs ( S[i] - Sref[i] ) );
+    printf ( "MDPRDFT %dx%dx%d, %d ghosts: max error %E, inverse max error %E, ghosts changed %zu\n",
+             mm, nn, kk, ghosts, errR, maxDiff ( Rbackin, rpacked.data(), interior, 1. / npts ),
+             ghostsChanged ( Rback, interior, rfill ) );
+
+    printf ( "%s: All done, exiting\n", prog );
+    return 0;
+}
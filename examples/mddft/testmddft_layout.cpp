@@ -0,0 +1,139 @@
+#include <cmath> // Without this, abs is the wrong function!
+#include <complex>
+#include <vector>
+
+#include "interface.hpp"
+#include "transformlib.hpp"
+
+typedef std::complex<double> cplx;
+
+// Direct DFT of sign a_sign of a row-major array of extents a_n, one axis at a time.
+static std::vector<cplx> directDFT ( const std::vector<cplx>& a_in, const std::vector<int>& a_n, int a_sign )
+{
+    std::vector<cplx> data = a_in, line;
+    size_t npts = data.size();
+    size_t inner = npts;
+    for ( int len : a_n ) {
+        inner /= len;
+        line.resize ( len );
+        for ( size_t start = 0; start < npts; start++ ) {
+            if ( ( start / inner ) % len != 0 ) continue;  // one line per first point
+            for ( int k = 0; k < len; k++ ) {
+                cplx sum = 0.;
+                for ( int j = 0; j < len; j++ )
+                    sum += data[start + j*inner] * std::polar ( 1., a_sign * 2. * M_PI * j * k / len );
+                line[k] = sum;
+            }
+            for ( int k = 0; k < len; k++ )
+                data[start + k*inner] = line[k];
+        }
+    }
+    return data;
+}
+
+// Position in the row-major array of extents a_n of point a_i of the
+// row-major array of extents a_half (a_n with a_n[a_trunc]/2+1 points on axis a_trunc).
+static size_t fullPosition ( size_t a_i, const std::vector<int>& a_n, const std::vector<int>& a_half )
+{
+    size_t pos = 0, stride = 1;
+    for ( int d = a_n.size() - 1; d >= 0; d-- ) {
+        pos += ( a_i % a_half[d] ) * stride;
+        a_i /= a_half[d];
+        stride *= a_n[d];
+    }
+    return pos;
+}
+
+static const char * layoutName ( const fftx::layout_t& a_layout )
+{
+    static const char * names[2][2] = { { "column-major, truncated first", "column-major, truncated last" },
+                                        { "row-major, truncated first", "row-major, truncated last" } };
+    return names[a_layout.rowMajor][a_layout.truncLast];
+}
+
+int main(int argc, char* argv[])
+{
+    int mm = 12, nn = 10, kk = 8; // default cube dimensions
+    char *prog = argv[0];
+    int baz = 0;
+
+    while ( argc > 1 && argv[1][0] == '-' ) {
+        switch ( argv[1][1] ) {
+        case 's':
+            argv++, argc--;
+            mm = atoi ( argv[1] );
+            while ( argv[1][baz] != 'x' ) baz++;
+            baz++ ;
+            nn = atoi ( & argv[1][baz] );
+            while ( argv[1][baz] != 'x' ) baz++;
+            baz++ ;
+            kk = atoi ( & argv[1][baz] );
+            break;
+        case 'h':
+            printf ( "Usage: %s: [ -s MMxNNxKK ] [ -h (print help message) ]\n", argv[0] );
+            exit (0);
+        default:
+            printf ( "%s: unknown argument: %s ... ignored\n", prog, argv[1] );
+        }
+        argv++, argc--;
+    }
+
+    std::vector<int> n{ mm, nn, kk };
+    std::vector<int> sizes = mdSizes ( n, 1 );
+    size_t npts = (size_t) mm * nn * kk;
+    std::vector<cplx> X ( npts ), Y ( npts ), Z ( npts );
+    for ( auto& v : X )
+        v = cplx ( 1 - ((double) rand()) / (double) (RAND_MAX/2),
+                   1 - ((double) rand()) / (double) (RAND_MAX/2) );
+
+    // A column-major MDDFT of {mm, nn, kk} is the row-major MDDFT of {kk, nn, mm}
+    // of the same memory, and shares its generated code.
+    fftx::layout_t colMajor ( false, true );
+    std::vector<cplx> ref = directDFT ( X, colMajor.physical ( n ), -1 );
+    MDDFTProblem mdp ( std::vector<void*>{ Y.data(), X.data(), nullptr }, sizes, "mddft" );
+    mdp.setLayout ( colMajor );
+    mdp.transform();
+    IMDDFTProblem imdp ( std::vector<void*>{ Z.data(), Y.data(), nullptr }, sizes, "imddft" );
+    imdp.setLayout ( colMajor );
+    imdp.transform();
+    double err = 0., errInv = 0.;
+    for ( size_t i = 0; i < npts; i++ ) {
+        err = std::max ( err, std::abs ( Y[i] - ref[i] ) );
+        errInv = std::max ( errInv, std::abs ( Z[i] / (double) npts - X[i] ) );
+    }
+    printf ( "MDDFT %dx%dx%d (%s): max error %E, inverse max error %E\n",
+             mm, nn, kk, layoutName ( colMajor ), err, errInv );
+
+    // MDPRDFT in each of the four layouts
+    std::vector<double> R ( npts ), Rback ( npts );
+    std::vector<cplx> Rc ( npts );
+    for ( size_t i = 0; i < npts; i++ )
+        Rc[i] = R[i] = X[i].real();
+    for ( int rowMajor = 1; rowMajor >= 0; rowMajor-- )
+        for ( int truncLast = 1; truncLast >= 0; truncLast-- ) {
+            fftx::layout_t layout ( rowMajor, truncLast );
+            std::vector<int> p = layout.physical ( n ), half = p;
+            int trunc = layout.physicalTruncAxis ( 3 );
+            half[trunc] = p[trunc]/2 + 1;
+            size_t nspec = npts / p[trunc] * half[trunc];
+            std::vector<cplx> S ( nspec );
+            ref = directDFT ( Rc, p, -1 );
+
+            MDPRDFTProblem rp ( std::vector<void*>{ S.data(), R.data(), nullptr }, sizes, "mdprdft" );
+            rp.setLayout ( layout );
+            rp.transform();
+            IMDPRDFTProblem irp ( std::vector<void*>{ Rback.data(), S.data(), nullptr }, sizes, "imdprdft" );
+            irp.setLayout ( layout );
+            irp.transform();
+            double errR = 0., errRInv = 0.;
+            for ( size_t i = 0; i < nspec; i++ )
+                errR = std::max ( errR, std::abs ( S[i] - ref[fullPosition ( i, p, half )] ) );
+            for ( size_t i = 0; i < npts; i++ )
+                errRInv = std::max ( errRInv, std::abs ( Rback[i] / (double) npts - R[i] ) );
+            printf ( "MDPRDFT %dx%dx%d (%s): max error %E, inverse max error %E\n",
+                     mm, nn, kk, layoutName ( layout ), errR, errRInv );
+        }
+
+    printf ( "%s: All done, exiting\n", prog );
+    return 0;
+}
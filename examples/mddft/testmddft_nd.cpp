@@ -0,0 +1,117 @@
+#include <cmath> // Without this, abs is the wrong function!
+#include <complex>
+#include <vector>
+
+#include "interface.hpp"
+#include "transformlib.hpp"
+
+typedef std::complex<double> cplx;
+
+// Direct DFT of sign a_sign of a row-major array of extents a_n, one axis at a time.
+static std::vector<cplx> directDFT ( const std::vector<cplx>& a_in, const std::vector<int>& a_n, int a_sign )
+{
+    std::vector<cplx> data = a_in, line;
+    size_t npts = data.size();
+    size_t inner = npts;
+    for ( int len : a_n ) {
+        inner /= len;
+        line.resize ( len );
+        for ( size_t start = 0; start < npts; start++ ) {
+            if ( ( start / inner ) % len != 0 ) continue;  // one line per first point
+            for ( int k = 0; k < len; k++ ) {
+                cplx sum = 0.;
+                for ( int j = 0; j < len; j++ )
+                    sum += data[start + j*inner] * std::polar ( 1., a_sign * 2. * M_PI * j * k / len );
+                line[k] = sum;
+            }
+            for ( int k = 0; k < len; k++ )
+                data[start + k*inner] = line[k];
+        }
+    }
+    return data;
+}
+
+static double maxDiff ( const cplx *a, const cplx *b, size_t len )
+{
+    double err = 0.;
+    for ( size_t i = 0; i < len; i++ )
+        err = std::max ( err, std::abs ( a[i] - b[i] ) );
+    return err;
+}
+
+int main(int argc, char* argv[])
+{
+    int batch = 2;
+    char *prog = argv[0];
+
+    while ( argc > 1 && argv[1][0] == '-' ) {
+        switch ( argv[1][1] ) {
+        case 'b':
+            argv++, argc--;
+            batch = atoi ( argv[1] );
+            break;
+        case 'h':
+            printf ( "Usage: %s: [ -b batch ] [ -h (print help message) ]\n", argv[0] );
+            exit (0);
+        default:
+            printf ( "%s: unknown argument: %s ... ignored\n", prog, argv[1] );
+        }
+        argv++, argc--;
+    }
+
+    std::vector<std::vector<int>> shapes{ { 48 }, { 24, 20 }, { 12, 10, 8 }, { 8, 6, 5, 4 } };
+    for ( const std::vector<int>& n : shapes ) {
+        std::vector<int> sizes = mdSizes ( n, batch );
+        size_t npts = 1;
+        for ( int e : n ) npts *= e;
+        std::string shape = std::to_string ( n[0] );
+        for ( size_t d = 1; d < n.size(); d++ )
+            shape += "x" + std::to_string ( n[d] );
+
+        // complex DFT of each field of the batch, and back
+        std::vector<cplx> X ( npts * batch ), Y ( npts * batch ), Z ( npts * batch );
+        for ( auto& v : X )
+            v = cplx ( 1 - ((double) rand()) / (double) (RAND_MAX/2),
+                       1 - ((double) rand()) / (double) (RAND_MAX/2) );
+        MDDFTProblem mdp ( std::vector<void*>{ Y.data(), X.data(), nullptr }, sizes, "mddft" );
+        mdp.transform();
+        IMDDFTProblem imdp ( std::vector<void*>{ Z.data(), Y.data(), nullptr }, sizes, "imddft" );
+        imdp.transform();
+        double err = 0., errInv = 0.;
+        for ( int b = 0; b < batch; b++ ) {
+            std::vector<cplx> field ( X.begin() + b*npts, X.begin() + (b+1)*npts );
+            std::vector<cplx> ref = directDFT ( field, n, -1 );
+            err = std::max ( err, maxDiff ( Y.data() + b*npts, ref.data(), npts ) );
+        }
+        for ( size_t i = 0; i < npts * batch; i++ )
+            errInv = std::max ( errInv, std::abs ( Z[i] / (double) npts - X[i] ) );
+        printf ( "%dD MDDFT %s batch %d: max error %E, inverse max error %E\n",
+                 (int) n.size(), shape.c_str(), batch, err, errInv );
+
+        // real-to-complex DFT: the half spectrum of the complex DFT of a real field
+        int half = n.back()/2 + 1;
+        size_t nspec = npts / n.back() * half;
+        std::vector<double> R ( npts * batch ), Rback ( npts * batch );
+        std::vector<cplx> S ( nspec * batch );
+        for ( size_t i = 0; i < npts * batch; i++ )
+            R[i] = X[i].real();
+        MDPRDFTProblem rp ( std::vector<void*>{ S.data(), R.data(), nullptr }, sizes, "mdprdft" );
+        rp.transform();
+        IMDPRDFTProblem irp ( std::vector<void*>{ Rback.data(), S.data(), nullptr }, sizes, "imdprdft" );
+        irp.transform();
+        double errR = 0., errRInv = 0.;
+        for ( int b = 0; b < batch; b++ ) {
+            std::vector<cplx> field ( R.begin() + b*npts, R.begin() + (b+1)*npts );
+            std::vector<cplx> ref = directDFT ( field, n, -1 );
+            for ( size_t i = 0; i < nspec; i++ )
+                errR = std::max ( errR, std::abs ( S[b*nspec + i] - ref[i / half * n.back() + i % half] ) );
+        }
+        for ( size_t i = 0; i < npts * batch; i++ )
+            errRInv = std::max ( errRInv, std::abs ( Rback[i] / (double) npts - R[i] ) );
+        printf ( "%dD MDPRDFT %s batch %d: max error %E, inverse max error %E\n",
+                 (int) n.size(), shape.c_str(), batch, errR, errRInv );
+    }
+
+    printf ( "%s: All done, exiting\n", prog );
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include <cmath> // Without this, abs is the wrong function!
+#include <complex>
+#include <vector>
+
+#include "interface.hpp"
+#include "transformlib.hpp"
+#include "pencillib.hpp"
+
+typedef std::complex<double> cplx;
+
+int main(int argc, char* argv[])
+{
+    int mm = 12, nn = 10, kk = 14; // default cube dimensions
+    char *prog = argv[0];
+    int baz = 0;
+
+    while ( argc > 1 && argv[1][0] == '-' ) {
+        switch ( argv[1][1] ) {
+        case 's':
+            argv++, argc--;
+            mm = atoi ( argv[1] );
+            while ( argv[1][baz] != 'x' ) baz++;
+            baz++ ;
+            nn = atoi ( & argv[1][baz] );
+            while ( argv[1][baz] != 'x' ) baz++;
+            baz++ ;
+            kk = atoi ( & argv[1][baz] );
+            break;
+        case 'h':
+            printf ( "Usage: %s: [ -s MMxNNxKK ] [ -h (print help message) ]\n", argv[0] );
+            exit (0);
+        default:
+            printf ( "%s: unknown argument: %s ... ignored\n", prog, argv[1] );
+        }
+        argv++, argc--;
+    }
+
+    std::vector<int> sizes{ mm, nn, kk };
+    size_t npts = (size_t) mm * nn * kk;
+    std::vector<cplx> X ( npts ), Y ( npts ), Yref ( npts ), Z ( npts );
+    for ( auto& v : X )
+        v = cplx ( 1 - ((double) rand()) / (double) (RAND_MAX/2),
+                   1 - ((double) rand()) / (double) (RAND_MAX/2) );
+    std::vector<cplx> Xcopy ( X );
+
+    MDDFTProblem mdp ( std::vector<void*>{ Yref.data(), X.data(), nullptr }, sizes, "mddft" );
+    mdp.transform();
+
+    // forward pencil transform against MDDFT, then the inverse back to the input
+    MDDFTPencilProblem pp ( std::vector<void*>{ Y.data(), X.data(), nullptr }, sizes, "mddft_pencil" );
+    pp.transform();
+    IMDDFTPencilProblem ipp ( std::vector<void*>{ Z.data(), Y.data(), nullptr }, sizes, "imddft_pencil" );
+    ipp.transform();
+
+    double err = 0., errInv = 0., errIn = 0.;
+    for ( size_t i = 0; i < npts; i++ ) {
+        err = std::max ( err, std::abs ( Y[i] - Yref[i] ) );
+        errInv = std::max ( errInv, std::abs ( Z[i] / (double) npts - Xcopy[i] ) );
+        errIn = std::max ( errIn, std::abs ( X[i] - Xcopy[i] ) );
+    }
+    printf ( "MDDFTPencil %dx%dx%d: max error %E, inverse max error %E, input changed by %E\n",
+             mm, nn, kk, err, errInv, errIn );
+    printf ( "MDDFTPencil %dx%dx%d: %f ms, of which %f ms in transposes\n",
+             mm, nn, kk, pp.getTime(), pp.getTransposeTime() );
+
+    printf ( "%s: All done, exiting\n", prog );
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include <cmath> // Without this, abs is the wrong function!
+#include <complex>
+#include <vector>
+
+#include "interface.hpp"
+#include "transformlib.hpp"
+
+typedef std::complex<double> cplx;
+
+// Max difference between the interleaved array a_ref and the planes a_re, a_im.
+static double maxDiff ( const std::vector<cplx>& a_ref, const std::vector<double>& a_re,
+                        const std::vector<double>& a_im, double a_scale = 1. )
+{
+    double err = 0.;
+    for ( size_t i = 0; i < a_ref.size(); i++ )
+        err = std::max ( err, std::abs ( cplx ( a_re[i], a_im[i] ) * a_scale - a_ref[i] ) );
+    return err;
+}
+
+static const char * formatName ( fftx::complexFormat a_format )
+{
+    return ( a_format == fftx::SPLIT ) ? "split" : "interleaved";
+}
+
+int main(int argc, char* argv[])
+{
+    int mm = 12, nn = 10, kk = 8; // default cube dimensions
+    int batch = 2;
+    char *prog = argv[0];
+    int baz = 0;
+
+    while ( argc > 1 && argv[1][0] == '-' ) {
+        switch ( argv[1][1] ) {
+        case 's':
+            argv++, argc--;
+            mm = atoi ( argv[1] );
+            while ( argv[1][baz] != 'x' ) baz++;
+            baz++ ;
+            nn = atoi ( & argv[1][baz] );
+            while ( argv[1][baz] != 'x' ) baz++;
+            baz++ ;
+            kk = atoi ( & argv[1][baz] );
+            break;
+        case 'b':
+            argv++, argc--;
+            batch = atoi ( argv[1] );
+            break;
+        case 'h':
+            printf ( "Usage: %s: [ -s MMxNNxKK ] [ -b batch ] [ -h (print help message) ]\n", argv[0] );
+            exit (0);
+        default:
+            printf ( "%s: unknown argument: %s ... ignored\n", prog, argv[1] );
+        }
+        argv++, argc--;
+    }
+
+    std::vector<int> sizes = mdSizes ( std::vector<int>{ mm, nn, kk }, batch );
+    size_t npts = (size_t) mm * nn * kk * batch;
+    std::vector<cplx> X ( npts ), Y ( npts );
+    for ( auto& v : X )
+        v = cplx ( 1 - ((double) rand()) / (double) (RAND_MAX/2),
+                   1 - ((double) rand()) / (double) (RAND_MAX/2) );
+    MDDFTProblem mdpRef ( std::vector<void*>{ Y.data(), X.data(), nullptr }, sizes, "mddft" );
+    mdpRef.transform();
+
+    // a split-complex argument is the pair of planes { re, im }
+    std::vector<double> Xre ( npts ), Xim ( npts ), Yre ( npts ), Yim ( npts ), Zre ( npts ), Zim ( npts );
+    for ( size_t i = 0; i < npts; i++ ) {
+        Xre[i] = X[i].real();
+        Xim[i] = X[i].imag();
+    }
+    double * Xsplit[2] = { Xre.data(), Xim.data() };
+    double * Ysplit[2] = { Yre.data(), Yim.data() };
+    double * Zsplit[2] = { Zre.data(), Zim.data() };
+
+    // complex DFT from split to split, and back
+    fftx::layout_t split ( FFTX_ROW_MAJOR_ORDER, FFTX_COMPLEX_TRUNC_LAST, fftx::SOA, fftx::SOA,
+                           fftx::SPLIT, fftx::SPLIT );
+    MDDFTProblem mdp ( std::vector<void*>{ Ysplit, Xsplit, nullptr }, sizes, "mddft" );
+    mdp.setLayout ( split );
+    mdp.transform();
+    IMDDFTProblem imdp ( std::vector<void*>{ Zsplit, Ysplit, nullptr }, sizes, "imddft" );
+    imdp.setLayout ( split );
+    imdp.transform();
+    printf ( "MDDFT %dx%dx%d batch %d, split to split: max error %E, inverse max error %E\n",
+             mm, nn, kk, batch, maxDiff ( Y, Yre, Yim ), maxDiff ( X, Zre, Zim, 1. / ( npts / batch ) ) );
+
+    // one argument split, the other interleaved
+    for ( int out = 0; out < 2; out++ ) {
+        fftx::complexFormat outFormat = out ? fftx::SPLIT : fftx::INTERLEAVED;
+        fftx::complexFormat inFormat = out ? fftx::INTERLEAVED : fftx::SPLIT;
+        std::vector<cplx> Yint ( npts );
+        MDDFTProblem mix ( std::vector<void*>{ out ? (void*) Ysplit : (void*) Yint.data(),
+                                               out ? (void*) X.data() : (void*) Xsplit, nullptr },
+                           sizes, "mddft" );
+        mix.setLayout ( fftx::layout_t ( FFTX_ROW_MAJOR_ORDER, FFTX_COMPLEX_TRUNC_LAST, fftx::SOA, fftx::SOA,
+                                         outFormat, inFormat ) );
+        std::fill ( Yre.begin(), Yre.end(), 0. );
+        std::fill ( Yim.begin(), Yim.end(), 0. );
+        mix.transform();
+        double err = 0.;
+        for ( size_t i = 0; i < npts; i++ )
+            err = std::max ( err, std::abs ( ( out ? cplx ( Yre[i], Yim[i] ) : Yint[i] ) - Y[i] ) );
+        printf ( "MDDFT %dx%dx%d batch %d, %s to %s: max error %E\n",
+                 mm, nn, kk, batch, formatName ( inFormat ), formatName ( outFormat ), err );
+    }
+
+    // real-to-complex DFT to a split spectrum, and back
+    std::vector<double> R ( npts ), Rback ( npts );
+    for ( size_t i = 0; i < npts; i++ )
+        R[i] = Xre[i];
+    size_t nspec = npts / kk * ( kk/2 + 1 );
+    std::vector<cplx> S ( nspec );
+    std::vector<double> Sre ( nspec ), Sim ( nspec );
+    double * Ssplit[2] = { Sre.data(), Sim.data() };
+    MDPRDFTProblem rpRef ( std::vector<void*>{ S.data(), R.data(), nullptr }, sizes, "mdprdft" );
+    rpRef.transform();
+    MDPRDFTProblem rp ( std::vector<void*>{ Ssplit, R.data(), nullptr }, sizes, "mdprdft" );
+    rp.setLayout ( fftx::layout_t ( FFTX_ROW_MAJOR_ORDER, FFTX_COMPLEX_TRUNC_LAST, fftx::SOA, fftx::SOA,
+                                    fftx::SPLIT, fftx::INTERLEAVED ) );
+    rp.transform();
+    IMDPRDFTProblem irp ( std::vector<void*>{ Rback.data(), Ssplit, nullptr }, sizes, "imdprdft" );
+    irp.setLayout ( fftx::layout_t ( FFTX_ROW_MAJOR_ORDER, FFTX_COMPLEX_TRUNC_LAST, fftx::SOA, fftx::SOA,
+                                     fftx::INTERLEAVED, fftx::SPLIT ) );
+    irp.transform();
+    double errRInv = 0.;
+    for ( size_t i = 0; i < npts; i++ )
+        errRInv = std::max ( errRInv, std::abs ( Rback[i] / (double) ( npts / batch ) - R[i] ) );
+    printf ( "MDPRDFT %dx%dx%d batch %d, split spectrum: max error %E, inverse max error %E\n",
+             mm, nn, kk, batch, maxDiff ( S, Sre, Sim ), errRInv );
+
+    printf ( "%s: All done, exiting\n", prog );
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include <cmath> // Without this, abs is the wrong function!
+#include <vector>
+
+#include "interface.hpp"
+#include "transformlib.hpp"
+
+// Entry (j, k) of the unscaled 1D transform of a_kind of size a_n (see r2rlib.hpp).
+static double r2rEntry ( int a_kind, int a_n, int j, int k )
+{
+    switch ( a_kind ) {
+    case fftx_native::R2R_DCT1: return ( a_n == 1 ) ? 1. : cos ( M_PI * j * k / ( a_n - 1 ) );
+    case fftx_native::R2R_DCT2: return cos ( M_PI * ( 2*j + 1 ) * k / ( 2. * a_n ) );
+    case fftx_native::R2R_DCT3: return cos ( M_PI * j * ( 2*k + 1 ) / ( 2. * a_n ) );
+    case fftx_native::R2R_DST1: return sin ( M_PI * ( j + 1 ) * ( k + 1 ) / ( a_n + 1. ) );
+    case fftx_native::R2R_DST2: return sin ( M_PI * ( 2*j + 1 ) * ( k + 1 ) / ( 2. * a_n ) );
+    default:                    return sin ( M_PI * ( j + 1 ) * ( 2*k + 1 ) / ( 2. * a_n ) );
+    }
+}
+
+// Max difference between a_out and the direct transform of a_in (a batch of 3D arrays).
+static double directError ( int a_kind, const std::vector<int>& a_n, int a_batch,
+                            const std::vector<double>& a_in, const std::vector<double>& a_out )
+{
+    size_t npts = (size_t) a_n[0] * a_n[1] * a_n[2];
+    double err = 0.;
+    for ( int b = 0; b < a_batch; b++ )
+        for ( int i = 0; i < a_n[0]; i++ )
+            for ( int j = 0; j < a_n[1]; j++ )
+                for ( int k = 0; k < a_n[2]; k++ ) {
+                    double sum = 0.;
+                    for ( int ii = 0; ii < a_n[0]; ii++ )
+                        for ( int jj = 0; jj < a_n[1]; jj++ )
+                            for ( int kk = 0; kk < a_n[2]; kk++ )
+                                sum += r2rEntry ( a_kind, a_n[0], ii, i ) *
+                                    r2rEntry ( a_kind, a_n[1], jj, j ) *
+                                    r2rEntry ( a_kind, a_n[2], kk, k ) *
+                                    a_in[b*npts + ((size_t)ii * a_n[1] + jj) * a_n[2] + kk];
+                    size_t pos = b*npts + ((size_t)i * a_n[1] + j) * a_n[2] + k;
+                    err = std::max ( err, std::abs ( sum - a_out[pos] ) );
+                }
+    return err;
+}
+
+int main(int argc, char* argv[])
+{
+    int mm = 12, nn = 10, kk = 14; // default cube dimensions
+    int batch = 2;
+    char *prog = argv[0];
+    int baz = 0;
+
+    while ( argc > 1 && argv[1][0] == '-' ) {
+        switch ( argv[1][1] ) {
+        case 'b':
+            argv++, argc--;
+            batch = atoi ( argv[1] );
+            break;
+        case 's':
+            argv++, argc--;
+            mm = atoi ( argv[1] );
+            while ( argv[1][baz] != 'x' ) baz++;
+            baz++ ;
+            nn = atoi ( & argv[1][baz] );
+            while ( argv[1][baz] != 'x' ) baz++;
+            baz++ ;
+            kk = atoi ( & argv[1][baz] );
+            break;
+        case 'h':
+            printf ( "Usage: %s: [ -b batch ] [ -s MMxNNxKK ] [ -h (print help message) ]\n", argv[0] );
+            exit (0);
+        default:
+            printf ( "%s: unknown argument: %s ... ignored\n", prog, argv[1] );
+        }
+        argv++, argc--;
+    }
+
+    static const char * names[] = { "dct1", "dct2", "dct3", "dst1", "dst2", "dst3" };
+    std::vector<int> cube{ mm, nn, kk }, plane{ 1, nn, kk };
+    size_t npts = (size_t) mm * nn * kk;
+    std::vector<double> X ( npts * batch ), Y ( npts * batch ), Z ( npts * batch );
+    for ( auto& v : X )
+        v = 1 - ((double) rand()) / (double) (RAND_MAX/2);
+
+    for ( int kind = 0; kind < 6; kind++ ) {
+        // one 3D transform, then a batch of 2D transforms on the planes of X
+        std::string name = std::string ( "md" ) + names[kind];
+        R2RProblem cp ( std::vector<void*>{ Y.data(), X.data(), nullptr },
+                        r2rSizes ( (fftx_native::r2rKind) kind, cube ), name );
+        cp.transform();
+        double err3 = directError ( kind, cube, 1, X, Y );
+        R2RProblem pp ( std::vector<void*>{ Y.data(), X.data(), nullptr },
+                        r2rSizes ( (fftx_native::r2rKind) kind, { nn, kk }, mm * batch ), name + "_2d" );
+        pp.transform();
+        double err2 = directError ( kind, plane, mm * batch, X, Y );
+        printf ( "%s %dx%dx%d max error %E, %d batched %dx%d max error %E\n", names[kind],
+                 mm, nn, kk, err3, mm * batch, nn, kk, err2 );
+    }
+
+    // DCT3 undoes DCT2, and DST3 undoes DST2, up to npts/8 once the
+    // coefficients of index 0 (n-1 for DST) along each axis are halved
+    DCT2Problem dct ( std::vector<void*>{ Y.data(), X.data(), nullptr }, cube, "mddct" );
+    DCT3Problem idct ( std::vector<void*>{ Z.data(), Y.data(), nullptr }, cube, "imddct" );
+    DST2Problem dst ( std::vector<void*>{ Y.data(), X.data(), nullptr }, cube, "mddst" );
+    DST3Problem idst ( std::vector<void*>{ Z.data(), Y.data(), nullptr }, cube, "imddst" );
+    double errc = 0., errs = 0.;
+    for ( int sine = 0; sine < 2; sine++ ) {
+        if ( sine ) dst.transform(); else dct.transform();
+        for ( int i = 0; i < mm; i++ )
+            for ( int j = 0; j < nn; j++ )
+                for ( int k = 0; k < kk; k++ ) {
+                    bool hi = ( i == ( sine ? mm-1 : 0 ) ), hj = ( j == ( sine ? nn-1 : 0 ) ),
+                        hk = ( k == ( sine ? kk-1 : 0 ) );
+                    Y[((size_t)i * nn + j) * kk + k] *= ( hi ? 0.5 : 1. ) * ( hj ? 0.5 : 1. ) * ( hk ? 0.5 : 1. );
+                }
+        if ( sine ) idst.transform(); else idct.transform();
+        double& err = sine ? errs : errc;
+        for ( size_t i = 0; i < npts; i++ )
+            err = std::max ( err, std::abs ( Z[i] * 8. / npts - X[i] ) );
+    }
+    printf ( "DCT2/DCT3 round trip max error %E, DST2/DST3 round trip max error %E\n", errc, errs );
+
+    printf ( "%s: All done, exiting\n", prog );
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include <cmath> // Without this, abs is the wrong function!
+#include <vector>
+
+#include "interface.hpp"
+#include "transformlib.hpp"
+
+// Band-limited test field: a few modes below the Nyquist frequency of every
+// grid used, so that resampling to the centred grid and back reproduces it.
+static double field ( int a_field, double x, double y, double z )
+{
+    return cos ( 2. * M_PI * ( x + 2. * y ) + 0.1 * a_field ) + 0.25 * sin ( 2. * M_PI * ( 3. * z - y ) ) +
+        0.1 * a_field;
+}
+
+static double maxDiff ( const std::vector<double>& a, const std::vector<double>& b )
+{
+    double err = 0.;
+    for ( size_t i = 0; i < a.size(); i++ )
+        err = std::max ( err, std::abs ( a[i] - b[i] ) );
+    return err;
+}
+
+int main(int argc, char* argv[])
+{
+    int mm = 12, nn = 10, kk = 8; // default grid dimensions nx, ny, nz
+    char *prog = argv[0];
+    int baz = 0;
+
+    while ( argc > 1 && argv[1][0] == '-' ) {
+        switch ( argv[1][1] ) {
+        case 's':
+            argv++, argc--;
+            mm = atoi ( argv[1] );
+            while ( argv[1][baz] != 'x' ) baz++;
+            baz++ ;
+            nn = atoi ( & argv[1][baz] );
+            while ( argv[1][baz] != 'x' ) baz++;
+            baz++ ;
+            kk = atoi ( & argv[1][baz] );
+            break;
+        case 'h':
+            printf ( "Usage: %s: [ -s MMxNNxKK ] [ -h (print help message) ]\n", argv[0] );
+            exit (0);
+        default:
+            printf ( "%s: unknown argument: %s ... ignored\n", prog, argv[1] );
+        }
+        argv++, argc--;
+    }
+
+    std::vector<int> sizes{ mm, nn, kk };
+    size_t nspec = (size_t) kk * nn * ( mm/2 + 1 );
+
+    // the fields on their staggered grids, [nz][ny][nx], sampled at (i / extent)
+    std::vector<std::vector<double>> X ( PSATD_INPUTS ), Y ( PSATD_OUTPUTS );
+    double * Xptr[PSATD_INPUTS], * Yptr[PSATD_OUTPUTS];
+    for ( int f = 0; f < PSATD_INPUTS; f++ ) {
+        std::vector<int> ext = psatdExtents ( sizes, f );
+        X[f].resize ( (size_t) ext[0] * ext[1] * ext[2] );
+        for ( int k = 0; k < ext[0]; k++ )
+            for ( int j = 0; j < ext[1]; j++ )
+                for ( int i = 0; i < ext[2]; i++ )
+                    X[f][((size_t)k * ext[1] + j) * ext[2] + i] =
+                        field ( f, (double) i / ext[2], (double) j / ext[1], (double) k / ext[0] );
+        Xptr[f] = X[f].data();
+        if ( f < PSATD_OUTPUTS ) {
+            Y[f].resize ( X[f].size() );
+            Yptr[f] = Y[f].data();
+        }
+    }
+
+    // symbols: wavenumbers, and C, S_ck, X1, X2, X3 uniform over the spectrum
+    std::vector<std::vector<double>> S ( 8 );
+    double * Sptr[8];
+    int klen[3] = { mm/2 + 1, nn, kk };
+    for ( int d = 0; d < 3; d++ )
+        for ( int i = 0; i < klen[d]; i++ )
+            S[d].push_back ( 2. * M_PI * ( ( 2*i < klen[d] || d == 0 ) ? i : i - klen[d] ) );
+    double symval[5] = { 1., 0., 0., 0., 0. };
+    for ( int s = 3; s < 8; s++ )
+        S[s].assign ( nspec, symval[s-3] );
+    for ( int s = 0; s < 8; s++ )
+        Sptr[s] = S[s].data();
+
+    PSATDProblem psatd ( std::vector<void*>{ Yptr, Xptr, Sptr }, sizes, "psatd" );
+
+    // C = 1 and the rest 0: E and B come back unchanged through the resampling and transforms
+    psatd.transform();
+    double errIdentity = 0.;
+    for ( int r = 0; r < PSATD_OUTPUTS; r++ )
+        errIdentity = std::max ( errIdentity, maxDiff ( Y[r], X[r] ) );
+    printf ( "PSATD %dx%dx%d, C = 1: max error %E\n", mm, nn, kk, errIdentity );
+
+    // constant fields only have the k = 0 mode: E' = C E - S_ck J / ep0, B' = C B
+    // (the wavenumbers are zeroed too, so that c^2 S_ck k does not amplify rounding)
+    double cval = 0.5, sval = 2.e-12;
+    for ( int f = 0; f < PSATD_INPUTS; f++ )
+        std::fill ( X[f].begin(), X[f].end(), 1. + f );
+    for ( int d = 0; d < 3; d++ )
+        std::fill ( S[d].begin(), S[d].end(), 0. );
+    std::fill ( S[3].begin(), S[3].end(), cval );
+    std::fill ( S[4].begin(), S[4].end(), sval );
+    for ( int s = 5; s < 8; s++ )
+        std::fill ( S[s].begin(), S[s].end(), 1. );
+    psatd.transform();
+    double errConst = 0.;
+    for ( int r = 0; r < PSATD_OUTPUTS; r++ ) {
+        double expect = cval * ( 1. + r ) - ( ( r < 3 ) ? sval / PSATD_EP0 * ( 1. + r + 6 ) : 0. );
+        for ( double v : Y[r] )
+            errConst = std::max ( errConst, std::abs ( v - expect ) );
+    }
+    printf ( "PSATD %dx%dx%d, constant fields: max error %E\n", mm, nn, kk, errConst );
+
+    bool ok = ( errIdentity < 1.e-10 && errConst < 1.e-10 );
+    printf ( "%s: %s\n", prog, ok ? "PASSED" : "FAILED" );
+    printf ( "%s: All done, exiting\n", prog );
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+#include <cmath> // Without this, abs is the wrong function!
+#include <vector>
+
+#include "interface.hpp"
+#include "transformlib.hpp"
+
+// Band-limited test field: a few modes below the Nyquist frequency of every
+// grid used, so that resampling reproduces it exactly at any point.
+static double field ( double x, double y, double z )
+{
+    return 0.5 + cos ( 2. * M_PI * ( x + 2. * y ) ) + 0.25 * sin ( 2. * M_PI * ( 3. * z - y ) ) +
+        0.1 * cos ( 2. * M_PI * ( 2. * x + z ) + 0.3 );
+}
+
+// Sample field on extents a_n at the points (i + a_shift) / a_n.
+static void sample ( std::vector<double>& a_out, const std::vector<int>& a_n,
+                     const std::vector<double>& a_shift )
+{
+    a_out.resize ( (size_t) a_n[0] * a_n[1] * a_n[2] );
+    for ( int i = 0; i < a_n[0]; i++ )
+        for ( int j = 0; j < a_n[1]; j++ )
+            for ( int k = 0; k < a_n[2]; k++ )
+                a_out[((size_t)i * a_n[1] + j) * a_n[2] + k] =
+                    field ( ( i + a_shift[0] ) / a_n[0], ( j + a_shift[1] ) / a_n[1],
+                            ( k + a_shift[2] ) / a_n[2] );
+}
+
+static double maxDiff ( const std::vector<double>& a, const std::vector<double>& b )
+{
+    double err = 0.;
+    for ( size_t i = 0; i < a.size(); i++ )
+        err = std::max ( err, std::abs ( a[i] - b[i] ) );
+    return err;
+}
+
+int main(int argc, char* argv[])
+{
+    int mm = 16, nn = 12, kk = 20; // default cube dimensions
+    char *prog = argv[0];
+    int baz = 0;
+
+    while ( argc > 1 && argv[1][0] == '-' ) {
+        switch ( argv[1][1] ) {
+        case 's':
+            argv++, argc--;
+            mm = atoi ( argv[1] );
+            while ( argv[1][baz] != 'x' ) baz++;
+            baz++ ;
+            nn = atoi ( & argv[1][baz] );
+            while ( argv[1][baz] != 'x' ) baz++;
+            baz++ ;
+            kk = atoi ( & argv[1][baz] );
+            break;
+        case 'h':
+            printf ( "Usage: %s: [ -s MMxNNxKK ] [ -h (print help message) ]\n", argv[0] );
+            exit (0);
+        default:
+            printf ( "%s: unknown argument: %s ... ignored\n", prog, argv[1] );
+        }
+        argv++, argc--;
+    }
+
+    std::vector<int> coarse{ mm, nn, kk }, fine{ 2*mm, 2*nn, 2*kk };
+    std::vector<int> mixed{ 3*mm/2, nn/2 + 8, kk };
+    std::vector<double> zero{ 0., 0., 0. }, half{ 0.5, 0.5, 0.5 }, stagger{ 0., -0.5, 0.25 };
+    std::vector<double> X, Y, ref;
+    sample ( X, coarse, zero );
+
+    // refinement by 2, cell-centred on the fine grid
+    Y.resize ( fine[0] * fine[1] * fine[2] );
+    ResampleProblem up ( std::vector<void*>{ Y.data(), X.data(), nullptr },
+                         resampleSizes ( coarse, fine, half ), "resample" );
+    up.transform();
+    sample ( ref, fine, half );
+    printf ( "refine %dx%dx%d -> %dx%dx%d shift (0.5, 0.5, 0.5): max error %E\n",
+             mm, nn, kk, fine[0], fine[1], fine[2], maxDiff ( Y, ref ) );
+
+    // coarsening of the fine samples back to the original grid
+    std::vector<double> F, C ( X.size() );
+    sample ( F, fine, zero );
+    ResampleProblem down ( std::vector<void*>{ C.data(), F.data(), nullptr },
+                           resampleSizes ( fine, coarse, zero ), "resample" );
+    down.transform();
+    printf ( "coarsen %dx%dx%d -> %dx%dx%d: max error %E\n",
+             fine[0], fine[1], fine[2], mm, nn, kk, maxDiff ( C, X ) );
+
+    // up along one axis, down along another, with a staggered shift
+    Y.resize ( (size_t) mixed[0] * mixed[1] * mixed[2] );
+    ResampleProblem mix ( std::vector<void*>{ Y.data(), X.data(), nullptr },
+                          resampleSizes ( coarse, mixed, stagger ), "resample" );
+    mix.transform();
+    sample ( ref, mixed, stagger );
+    printf ( "resample %dx%dx%d -> %dx%dx%d shift (0, -0.5, 0.25): max error %E\n",
+             mm, nn, kk, mixed[0], mixed[1], mixed[2], maxDiff ( Y, ref ) );
+
+    printf ( "%s: All done, exiting\n", prog );
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <cmath> // Without this, abs is the wrong function!
+#include <vector>
+
+#include "interface.hpp"
+#include "transformlib.hpp"
+
+// Periodic test fields on the box [0, L0) x [0, L1) x [0, L2), with their
+// derivatives: phi = sin(a x) cos(b y) + cos(c z), a = 2 pi / L0, b = 4 pi / L1,
+// c = 2 pi / L2, and the divergence-free v = (sin(b y), sin(c z), sin(a x)).
+struct fields
+{
+    double a, b, c;
+    double phi ( double x, double y, double z ) const { return sin ( a*x ) * cos ( b*y ) + cos ( c*z ); }
+    double dphi ( int d, double x, double y, double z ) const {
+        if ( d == 0 ) return a * cos ( a*x ) * cos ( b*y );
+        if ( d == 1 ) return -b * sin ( a*x ) * sin ( b*y );
+        return -c * sin ( c*z );
+    }
+    // phi without its mean has the inverse Laplacian psi
+    double psi ( double x, double y, double z ) const {
+        return -sin ( a*x ) * cos ( b*y ) / ( a*a + b*b ) - cos ( c*z ) / ( c*c );
+    }
+    double v ( int d, double x, double y, double z ) const {
+        return ( d == 0 ) ? sin ( b*y ) : ( d == 1 ) ? sin ( c*z ) : sin ( a*x );
+    }
+    // curl v = (-c cos(c z), -a cos(a x), -b cos(b y))
+    double curlv ( int d, double x, double y, double z ) const {
+        return ( d == 0 ) ? -c * cos ( c*z ) : ( d == 1 ) ? -a * cos ( a*x ) : -b * cos ( b*y );
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    int mm = 24, nn = 20, kk = 16; // default cube dimensions
+    char *prog = argv[0];
+    int baz = 0;
+
+    while ( argc > 1 && argv[1][0] == '-' ) {
+        switch ( argv[1][1] ) {
+        case 's':
+            argv++, argc--;
+            mm = atoi ( argv[1] );
+            while ( argv[1][baz] != 'x' ) baz++;
+            baz++ ;
+            nn = atoi ( & argv[1][baz] );
+            while ( argv[1][baz] != 'x' ) baz++;
+            baz++ ;
+            kk = atoi ( & argv[1][baz] );
+            break;
+        case 'h':
+            printf ( "Usage: %s: [ -s MMxNNxKK ] [ -h (print help message) ]\n", argv[0] );
+            exit (0);
+        default:
+            printf ( "%s: unknown argument: %s ... ignored\n", prog, argv[1] );
+        }
+        argv++, argc--;
+    }
+
+    std::vector<int> n{ mm, nn, kk };
+    std::vector<double> L{ 2.0, 1.5, 3.0 };
+    fields f{ 2. * M_PI / L[0], 4. * M_PI / L[1], 2. * M_PI / L[2] };
+    size_t npts = (size_t) mm * nn * kk;
+    std::vector<double> phi ( npts ), v ( 3 * npts ), psi ( npts ), grad ( 3 * npts ), curl ( 3 * npts );
+    std::vector<double> out ( 3 * npts ), out2 ( 3 * npts );
+    for ( int i = 0; i < mm; i++ )
+        for ( int j = 0; j < nn; j++ )
+            for ( int k = 0; k < kk; k++ ) {
+                double x = i * L[0] / mm, y = j * L[1] / nn, z = k * L[2] / kk;
+                size_t p = ((size_t)i * nn + j) * kk + k;
+                phi[p] = f.phi ( x, y, z );
+                psi[p] = f.psi ( x, y, z );
+                for ( int d = 0; d < 3; d++ ) {
+                    v[d*npts + p] = f.v ( d, x, y, z );
+                    grad[d*npts + p] = f.dphi ( d, x, y, z );
+                    curl[d*npts + p] = f.curlv ( d, x, y, z );
+                }
+            }
+    auto maxDiff = [] ( const double *a, const double *b, size_t len ) {
+        double err = 0.;
+        for ( size_t i = 0; i < len; i++ )
+            err = std::max ( err, std::abs ( a[i] - b[i] ) );
+        return err;
+    };
+
+    spectralSymbol sym ( n, L );
+
+    SpectralProblem gp ( std::vector<void*>{ out.data(), phi.data(), sym.pointers() },
+                         spectralSizes ( SPECTRAL_GRAD, n ), "grad" );
+    gp.transform();
+    printf ( "grad %dx%dx%d max error %E\n", mm, nn, kk, maxDiff ( out.data(), grad.data(), 3 * npts ) );
+
+    // div of grad phi is the Laplacian of phi; invLaplacian brings phi (of mean 0) back
+    SpectralProblem dp ( std::vector<void*>{ out2.data(), out.data(), sym.pointers() },
+                         spectralSizes ( SPECTRAL_DIV, n ), "div" );
+    dp.transform();
+    SpectralProblem lp ( std::vector<void*>{ out.data(), out2.data(), sym.pointers() },
+                         spectralSizes ( SPECTRAL_INVLAPLACIAN, n ), "invlaplacian" );
+    lp.transform();
+    printf ( "invLaplacian(div(grad phi)) max error %E\n", maxDiff ( out.data(), phi.data(), npts ) );
+    lp.args = std::vector<void*>{ out.data(), phi.data(), sym.pointers() };
+    lp.transform();
+    printf ( "invLaplacian max error %E\n", maxDiff ( out.data(), psi.data(), npts ) );
+
+    SpectralProblem cp ( std::vector<void*>{ out.data(), v.data(), sym.pointers() },
+                         spectralSizes ( SPECTRAL_CURL, n ), "curl" );
+    cp.transform();
+    printf ( "curl max error %E\n", maxDiff ( out.data(), curl.data(), 3 * npts ) );
+
+    // Leray: v is divergence-free and kept, grad phi is removed
+    for ( size_t i = 0; i < 3 * npts; i++ )
+        out2[i] = v[i] + grad[i];
+    SpectralProblem pp ( std::vector<void*>{ out.data(), out2.data(), sym.pointers() },
+                         spectralSizes ( SPECTRAL_LERAY, n ), "leray" );
+    pp.transform();
+    printf ( "Leray projection max error %E\n", maxDiff ( out.data(), v.data(), 3 * npts ) );
+
+    printf ( "%s: All done, exiting\n", prog );
+    return 0;
+}
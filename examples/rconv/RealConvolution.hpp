@@ -64,6 +64,21 @@ fftx::point_t<DIM> truncatedComplexDimensions(fftx::point_t<DIM>& a_size)
   return truncSize;
 }
 
+/*
+ Real 3D convolution plan.
+
+ The plan owns its workspace: on GPU, device buffers for input, output and
+ symbol are allocated on first use and kept until the plan is destroyed,
+ and a fixed-size library transform is initialized once rather than on
+ every call.  A symbol set with setSymbol (or given to the constructor) is
+ copied once, and uploaded once on GPU; apply(input, output) then runs the
+ convolution with no allocation and no copies other than those of input
+ and output between host and device.  On GPU, applyDevice takes input and
+ output already on the device and does no copies at all.
+
+ exec(input, output, symbol) is the one-shot form: it sets the symbol and
+ applies.  Copies of a plan share nothing; each sets up its own workspace.
+*/
 template<int DIM>
 class RealConvolution
 {
@@ -90,6 +105,43 @@ public:
     m_fdomain = a_fdomain;
     m_tp = FFTX_HANDLE;
   }
+
+  // constructor with FFTX handle and a fixed symbol
+  RealConvolution(RCONVProblem rp,
+                  std::vector<int>& sizes,
+                  fftx::box_t<DIM> a_domain,
+                  fftx::box_t<DIM> a_fdomain,
+                  fftx::array_t<DIM, double>& a_symbol)
+    : RealConvolution(rp, sizes, a_domain, a_fdomain)
+  {
+    setSymbol(a_symbol);
+  }
+
+  RealConvolution(const RealConvolution& a_other)
+  {
+    *this = a_other;
+  }
+
+  RealConvolution& operator=(const RealConvolution& a_other)
+  {
+    if (this != &a_other)
+      {
+        release();
+        m_tp = a_other.m_tp;
+        m_rp = a_other.m_rp;
+        m_sizes = a_other.m_sizes;
+        m_domain = a_other.m_domain;
+        m_fdomain = a_other.m_fdomain;
+        m_symbol = a_other.m_symbol;
+        m_symbolStale = true;
+      }
+    return *this;
+  }
+
+  virtual ~RealConvolution()
+  {
+    release();
+  }
   
   // // constructor with FFTX library transformer
   // RealConvolution(fftx::rconv<DIM>* a_transformerPtr)
@@ -110,6 +162,40 @@ public:
   fftx::box_t<DIM>& fdomain()
   { return m_fdomain; }
 
+  // Set the symbol used by apply; it is copied, so a_symbol may be reused.
+  void setSymbol(fftx::array_t<DIM, double>& a_symbol)
+  {
+    const double* symbolPtr = a_symbol.m_data.local();
+    m_symbol.assign(symbolPtr, symbolPtr + m_fdomain.size());
+    m_symbolStale = true;
+  }
+
+  // Convolve a_input with the symbol set by setSymbol into a_output.
+  void apply(fftx::array_t<DIM, double>& a_input,
+             fftx::array_t<DIM, double>& a_output)
+  {
+    if (!ready("apply")) return;
+#if defined(FFTX_CUDA) || defined(FFTX_HIP)
+    auto bytes = m_domain.size() * sizeof(double);
+    DEVICE_MEM_COPY((void*)m_inputWork, a_input.m_data.local(), bytes,
+                    MEM_COPY_HOST_TO_DEVICE);
+    run(m_inputWork, m_outputWork);
+    DEVICE_MEM_COPY(a_output.m_data.local(), (void*)m_outputWork, bytes,
+                    MEM_COPY_DEVICE_TO_HOST);
+#else
+    run(a_input.m_data.local(), a_output.m_data.local());
+#endif
+  }
+
+#if defined(FFTX_CUDA) || defined(FFTX_HIP)
+  // apply on input and output buffers already on the device.
+  void applyDevice(double* a_inputDevice, double* a_outputDevice)
+  {
+    if (!ready("applyDevice")) return;
+    run(a_inputDevice, a_outputDevice);
+  }
+#endif
+
   virtual void exec(fftx::array_t<DIM, double>& a_input,
                     fftx::array_t<DIM, double>& a_output,
                     fftx::array_t<DIM, double>& a_symbol)
@@ -120,78 +206,8 @@ public:
       }
     else if (m_tp == FFTX_HANDLE || m_tp == FFTX_LIB)
       {
-#if defined(FFTX_CUDA) || defined(FFTX_HIP)
-        // on GPU
-        auto input_size = m_domain.size();
-        auto output_size = m_domain.size();
-        auto symbol_size = m_fdomain.size();
-
-        auto input_bytes = input_size * sizeof(double);
-        auto output_bytes = output_size * sizeof(double);
-        auto symbol_bytes = symbol_size * sizeof(double);
-
-#if defined FFTX_HIP 
-        hipDeviceptr_t inputPtr;
-        hipDeviceptr_t outputPtr;
-        hipDeviceptr_t symbolPtr;
-#else
-        CUdeviceptr inputPtr;
-        CUdeviceptr outputPtr;
-        CUdeviceptr symbolPtr;
-#endif      
-        DEVICE_MALLOC((void **)&inputPtr, input_bytes);
-        DEVICE_MALLOC((void **)&outputPtr, output_bytes);
-        DEVICE_MALLOC((void **)&symbolPtr, symbol_bytes);
-
-        DEVICE_MEM_COPY((void*)inputPtr, a_input.m_data.local(), input_bytes,
-                        MEM_COPY_HOST_TO_DEVICE);
-        DEVICE_MEM_COPY((void*)symbolPtr, a_symbol.m_data.local(), symbol_bytes,
-                        MEM_COPY_HOST_TO_DEVICE);
-
-#if defined FFTX_HIP
-        fftx::array_t<DIM, hipDeviceptr_t> inputDevice(fftx::global_ptr<hipDeviceptr_t>
-                                               (&inputPtr, 0, 1), m_domain);
-        fftx::array_t<DIM, hipDeviceptr_t> outputDevice(fftx::global_ptr<hipDeviceptr_t>
-                                                (&outputPtr, 0, 1), m_domain);
-        fftx::array_t<DIM, hipDeviceptr_t> symbolDevice(fftx::global_ptr<hipDeviceptr_t>
-                                                (&symbolPtr, 0, 1), m_fdomain);
-
-        std::vector<void*> args{outputPtr, inputPtr, symbolPtr};
-#else
-        fftx::array_t<DIM, CUdeviceptr> inputDevice(fftx::global_ptr<CUdeviceptr>
-                                               (&inputPtr, 0, 1), m_domain);
-        fftx::array_t<DIM, CUdeviceptr> outputDevice(fftx::global_ptr<CUdeviceptr>
-                                                (&outputPtr, 0, 1), m_domain);
-        fftx::array_t<DIM, CUdeviceptr> symbolDevice(fftx::global_ptr<CUdeviceptr>
-                                                (&symbolPtr, 0, 1), m_fdomain);
-
-        std::vector<void*> args{&outputPtr, &inputPtr, &symbolPtr};
-#endif      
-        m_rp.setArgs(args);
-        m_rp.setSizes(m_sizes);
-        m_rp.transform();
-
-        // if (m_tp == FFTX_HANDLE)
-        //   {
-        //     (*m_functionPtr)(inputDevice, outputDevice, symbolDevice);
-        //   }
-        // else if (m_tp == FFTX_LIB)
-        //   {
-        //     m_transformerPtr->transform(inputDevice, outputDevice, symbolDevice);
-        //   }
-        DEVICE_MEM_COPY(a_output.m_data.local(), (void*)outputPtr, output_bytes,
-                        MEM_COPY_DEVICE_TO_HOST);
-
-        DEVICE_FREE((void*)inputPtr);
-        DEVICE_FREE((void*)outputPtr);
-#else
-        std::vector<void*> args{(void*)a_output.m_data.local(),
-                                (void*)a_input.m_data.local(),
-                                (void*)a_symbol.m_data.local()};
-        m_rp.setArgs(args);
-        m_rp.setSizes(m_sizes);
-        m_rp.transform();
-#endif
+        setSymbol(a_symbol);
+        apply(a_input, a_output);
       }
   }
 
@@ -212,6 +228,108 @@ protected:
   
   // case FFTX_LIB
   // fftx::rconv<DIM>* m_transformerPtr;
+
+  // Workspace, set up on first use by prepare().
+  bool m_prepared = false;
+  std::vector<double> m_symbol;
+  bool m_symbolStale = true;
+  transformTuple_t* m_tupl = nullptr;
+  std::vector<void*> m_args;
+  // Arguments of the current transform; on CUDA m_args points to these.
+  double* m_inputPtr = nullptr;
+  double* m_outputPtr = nullptr;
+  double* m_symbolPtr = nullptr;
+#if defined(FFTX_CUDA) || defined(FFTX_HIP)
+  double* m_inputWork = nullptr;
+  double* m_outputWork = nullptr;
+  double* m_symbolWork = nullptr;
+#endif
+
+  bool ready(const char* a_caller)
+  {
+    if (m_tp == EMPTY)
+      {
+        std::cout << "calling " << a_caller << " on empty RealConvolution" << std::endl;
+        return false;
+      }
+    if (m_symbol.size() != m_fdomain.size())
+      {
+        std::cout << "calling " << a_caller << " on RealConvolution with no symbol" << std::endl;
+        return false;
+      }
+    if (!m_prepared) prepare();
+    if (m_symbolStale)
+      {
+#if defined(FFTX_CUDA) || defined(FFTX_HIP)
+        DEVICE_MEM_COPY((void*)m_symbolWork, m_symbol.data(),
+                        m_symbol.size() * sizeof(double),
+                        MEM_COPY_HOST_TO_DEVICE);
+#endif
+        m_symbolStale = false;
+      }
+    return true;
+  }
+
+  void prepare()
+  {
+#if defined(FFTX_CUDA) || defined(FFTX_HIP)
+    DEVICE_MALLOC((void **)&m_inputWork, m_domain.size() * sizeof(double));
+    DEVICE_MALLOC((void **)&m_outputWork, m_domain.size() * sizeof(double));
+    DEVICE_MALLOC((void **)&m_symbolWork, m_fdomain.size() * sizeof(double));
+    m_symbolPtr = m_symbolWork;
+#else
+    m_symbolPtr = m_symbol.data();
+#endif
+#if defined FFTX_CUDA
+    m_args = std::vector<void*>{&m_outputPtr, &m_inputPtr, &m_symbolPtr};
+#else
+    m_args = std::vector<void*>{(void*)m_outputPtr, (void*)m_inputPtr, (void*)m_symbolPtr};
+#endif
+    m_rp.setSizes(m_sizes);
+    m_tupl = getLibTransform(m_rp.name, m_sizes);
+    if (m_tupl != nullptr)
+      {
+        ( * m_tupl->initfp )();
+      }
+    m_prepared = true;
+  }
+
+  void run(double* a_inputPtr, double* a_outputPtr)
+  {
+    m_inputPtr = a_inputPtr;
+    m_outputPtr = a_outputPtr;
+#if !defined FFTX_CUDA
+    m_args[0] = (void*)m_outputPtr;
+    m_args[1] = (void*)m_inputPtr;
+    m_args[2] = (void*)m_symbolPtr;
+#endif
+    if (m_tupl != nullptr)
+      { // library size, initialized once in prepare()
+        ( * m_tupl->runfp )( m_outputPtr, m_inputPtr, m_symbolPtr );
+      }
+    else
+      {
+        m_rp.setArgs(m_args);
+        m_rp.transform();
+      }
+  }
+
+  void release()
+  {
+    if (m_prepared)
+      {
+        if (m_tupl != nullptr) ( * m_tupl->destroyfp )();
+#if defined(FFTX_CUDA) || defined(FFTX_HIP)
+        DEVICE_FREE((void*)m_inputWork);
+        DEVICE_FREE((void*)m_outputWork);
+        DEVICE_FREE((void*)m_symbolWork);
+        m_inputWork = m_outputWork = m_symbolWork = nullptr;
+#endif
+        m_tupl = nullptr;
+        m_prepared = false;
+      }
+    m_symbolStale = true;
+  }
 };
 
 template<int DIM>
@@ -238,6 +356,7 @@ public:
 
     double err = 0.;
     updateMax(err, testConstantSymbol());
+    updateMax(err, testCachedSymbol());
     updateMax(err, testDelta());
     updateMax(err, testPoisson());
     printf("%dD tests in %d rounds max error %11.5e\n",
@@ -300,6 +419,42 @@ protected:
     return errConstantSymbol;
   }
 
+  // Same as testConstantSymbol, with the symbol set once and apply per round.
+  double testCachedSymbol()
+  {
+    if (m_verbosity >= SHOW_CATEGORIES)
+      {
+        printf("calling testCachedSymbol<%d>\n", DIM);
+      }
+    fftx::array_t<DIM, double> input(m_domain);
+    fftx::array_t<DIM, double> output(m_domain);
+    fftx::array_t<DIM, double> symbol(m_fdomain);
+    
+    double scaling = 1. / (m_domain.size()*1.);
+    setConstant(symbol, scaling);
+    m_tfm.setSymbol(symbol);
+    setConstant(symbol, 0.); // the plan keeps its own copy
+    double errCachedSymbol = 0.;
+    for (int itn = 1; itn <= m_rounds; itn++)
+      {
+        unifRealArray(input);
+        m_tfm.apply(input, output);
+        double err = absMaxDiffArray(input, output);
+        updateMax(errCachedSymbol, err);
+        if (m_verbosity >= SHOW_ROUNDS)
+          {
+            printf("%dD random input with cached constant symbol max error %11.5e\n",
+                   DIM, err);
+          }
+      }
+    if (m_verbosity >= SHOW_CATEGORIES)
+      {
+        printf("%dD random input with cached constant symbol in %d rounds: max error %11.5e\n",
+               DIM, m_rounds, errCachedSymbol);
+      }
+    return errCachedSymbol;
+  }
+
   double testDelta()
   {
     if (m_verbosity >= SHOW_CATEGORIES)
@@ -0,0 +1,380 @@
+#ifndef TILED_CONVOLUTION_HEADER
+#define TILED_CONVOLUTION_HEADER
+
+#include <cmath>
+#include <thread>
+#include <atomic>
+#include <stdexcept>
+
+#include "RealConvolution.hpp"
+
+/*
+ Non-periodic convolution of a large real array with a compact kernel,
+ by overlap-save over tiles of a size the rconv transform supports.
+
+   output(x) = sum_y kernel(x - y) input(y),
+
+ with input taken as zero outside its domain.  The kernel is given in real
+ space on a box containing the origin, and reaches a radius r[d] along each
+ dimension d.  The output domain is cut into blocks of tile[d] - 2*r[d]
+ points; each block is convolved as a periodic tile of size tile[d] holding
+ the block and a halo of r[d] points on each side, and only the block is
+ kept, where the periodic wraparound of the tile does not reach.  The cost
+ is linear in the size of the domain.
+
+ rconv multiplies the spectrum by a real symbol, which applies only the
+ even part of a kernel, so the kernel must be symmetric, kernel(-x) =
+ kernel(x); the constructor throws std::invalid_argument if it is not.
+
+ Each worker thread has its own RealConvolution plan and tile buffers, and
+ takes tiles one at a time.  Generated and library kernels may keep their
+ temporaries in globals, so by default tiles run concurrently only on the
+ native CPU engine, with FFTX_NATIVE_THREADS workers; otherwise one tile
+ runs at a time, each as fast as the kernel goes.
+*/
+
+// rconv sizes in the FFTX library, candidates for TiledConvolution::chooseTile.
+inline std::vector<fftx::point_t<3>> rconvLibrarySizes()
+{
+  std::vector<fftx::point_t<3>> sizes;
+  fftx::point_t<3> *ents = fftx_rconv_QuerySizes ();
+  for ( int ind = 0; ents != nullptr && ents[ind][0] != 0; ind++ )
+    {
+      sizes.push_back(ents[ind]);
+    }
+  return sizes;
+}
+
+template<int DIM>
+class TiledConvolution
+{
+public:
+  TiledConvolution()
+  {
+    m_defined = false;
+  }
+
+  /*
+    Convolution with a_kernel on tiles of size a_tile, on a_threads worker
+    threads (0 to choose as described above).
+  */
+  TiledConvolution(const fftx::point_t<DIM>& a_tile,
+                   fftx::array_t<DIM, double>& a_kernel,
+                   int a_threads = 0)
+  {
+    m_defined = false;
+    m_tile = a_tile;
+    fftx::box_t<DIM> kbox = a_kernel.m_domain;
+    for (int d = 0; d < DIM; d++)
+      {
+        if (kbox.lo[d] > 0 || kbox.hi[d] < 0)
+          {
+            std::cout << "TiledConvolution: kernel domain " << kbox
+                      << " does not contain the origin" << std::endl;
+            return;
+          }
+        m_radius[d] = std::max(-kbox.lo[d], kbox.hi[d]);
+        m_block[d] = m_tile[d] - 2 * m_radius[d];
+        if (m_block[d] <= 0)
+          {
+            std::cout << "TiledConvolution: tile " << m_tile
+                      << " too small for kernel domain " << kbox << std::endl;
+            return;
+          }
+      }
+    if (!isEven(a_kernel))
+      {
+        throw std::invalid_argument("TiledConvolution: kernel is not symmetric,"
+                                    " and rconv applies only its even part");
+      }
+
+    fftx::point_t<DIM> truncTile = truncatedComplexDimensions(m_tile);
+    m_tileDomain = domainFromSize(m_tile);
+    m_tileFdomain = domainFromSize(truncTile);
+    fftx::array_t<DIM, double> symbol(m_tileFdomain);
+    kernelSymbol(a_kernel, symbol);
+
+    std::vector<int> sizes(m_tile.x, m_tile.x + DIM);
+    int nthreads = (a_threads > 0) ? a_threads : autoThreads(sizes);
+    RCONVProblem rp("rconv");
+    RealConvolution<DIM> plan(rp, sizes, m_tileDomain, m_tileFdomain, symbol);
+    m_plans.assign(nthreads, plan);
+    m_inputTiles.assign(nthreads, std::vector<double>(m_tileDomain.size()));
+    m_outputTiles.assign(nthreads, std::vector<double>(m_tileDomain.size()));
+    m_defined = true;
+  }
+
+  /*
+    Tile size among a_candidates with the least estimated work, N log N per
+    tile, to convolve a domain of extents a_extents with a kernel of radius
+    a_radius.  Without candidates (no library), cubes of powers of 2 from 16
+    to 256.
+  */
+  static fftx::point_t<DIM> chooseTile(const std::vector<fftx::point_t<DIM>>& a_candidates,
+                                       const fftx::point_t<DIM>& a_radius,
+                                       const fftx::point_t<DIM>& a_extents)
+  {
+    std::vector<fftx::point_t<DIM>> cands = a_candidates;
+    if (cands.empty())
+      {
+        for (int n = 16; n <= 256; n *= 2)
+          {
+            fftx::point_t<DIM> cube;
+            for (int d = 0; d < DIM; d++) cube[d] = n;
+            cands.push_back(cube);
+          }
+      }
+    fftx::point_t<DIM> best = cands.back();
+    double bestCost = 0.;
+    for (const auto& cand : cands)
+      {
+        double npts = 1., ntiles = 1.;
+        bool fits = true;
+        for (int d = 0; d < DIM; d++)
+          {
+            int blk = cand[d] - 2*a_radius[d];
+            fits = fits && (blk > 0);
+            npts *= cand[d];
+            ntiles *= (blk > 0) ? (a_extents[d] + blk - 1) / blk : 0;
+          }
+        if (!fits) continue;
+        double cost = ntiles * npts * log2(npts);
+        if (bestCost == 0. || cost < bestCost)
+          {
+            bestCost = cost;
+            best = cand;
+          }
+      }
+    return best;
+  }
+
+  bool isDefined()
+  { return m_defined; }
+
+  fftx::point_t<DIM> tile()
+  { return m_tile; }
+
+  fftx::point_t<DIM> radius()
+  { return m_radius; }
+
+  fftx::point_t<DIM> block()
+  { return m_block; }
+
+  int threads()
+  { return m_plans.size(); }
+
+  // Number of tiles in the last call to exec.
+  size_t tiles()
+  { return m_tiles; }
+
+  // Set a_output on its domain to the convolution of a_input with the kernel.
+  void exec(fftx::array_t<DIM, double>& a_input,
+            fftx::array_t<DIM, double>& a_output)
+  {
+    if (!m_defined)
+      {
+        std::cout << "calling exec on undefined TiledConvolution" << std::endl;
+        return;
+      }
+    fftx::box_t<DIM> outDomain = a_output.m_domain;
+    fftx::point_t<DIM> outExtents = outDomain.extents();
+    fftx::point_t<DIM> counts;
+    m_tiles = 1;
+    for (int d = 0; d < DIM; d++)
+      {
+        counts[d] = (outExtents[d] + m_block[d] - 1) / m_block[d];
+        m_tiles *= counts[d];
+      }
+    fftx::box_t<DIM> tileGrid = domainFromSize(counts);
+
+    std::atomic<size_t> next(0);
+#if !defined(FFTX_CUDA) && !defined(FFTX_HIP)
+    bool wasParallel = fftx_native::inParallel();
+#endif
+    auto worker = [&](int a_worker)
+      {
+#if !defined(FFTX_CUDA) && !defined(FFTX_HIP)
+        // the workers already fill the cores
+        if (m_plans.size() > 1) fftx_native::inParallel() = true;
+#endif
+        size_t t;
+        while ((t = next++) < m_tiles)
+          {
+            fftx::point_t<DIM> index = pointFromPositionBox(t, tileGrid);
+            fftx::point_t<DIM> blockLo;
+            for (int d = 0; d < DIM; d++)
+              {
+                blockLo[d] = outDomain.lo[d] + (index[d] - tileGrid.lo[d]) * m_block[d];
+              }
+            convolveTile(a_worker, blockLo, a_input, a_output);
+          }
+      };
+    size_t nworkers = std::min(m_plans.size(), m_tiles);
+    std::vector<std::thread> threads;
+    for (size_t w = 1; w < nworkers; w++)
+      {
+        threads.push_back(std::thread(worker, (int) w));
+      }
+    worker(0);
+#if !defined(FFTX_CUDA) && !defined(FFTX_HIP)
+    fftx_native::inParallel() = wasParallel;
+#endif
+    for (auto& thr : threads) thr.join();
+  }
+
+protected:
+
+  bool m_defined;
+  fftx::point_t<DIM> m_tile;
+  fftx::point_t<DIM> m_radius;
+  fftx::point_t<DIM> m_block;
+  fftx::box_t<DIM> m_tileDomain;
+  fftx::box_t<DIM> m_tileFdomain;
+  size_t m_tiles = 0;
+
+  // per worker
+  std::vector<RealConvolution<DIM>> m_plans;
+  std::vector<std::vector<double>> m_inputTiles;
+  std::vector<std::vector<double>> m_outputTiles;
+
+  static int autoThreads(const std::vector<int>& a_sizes)
+  {
+#if defined(FFTX_CUDA) || defined(FFTX_HIP)
+    return 1;
+#else
+    bool cached = haveEnv("FFTX_HOME") &&
+      (bool) std::ifstream(getFromCache("rconv", a_sizes));
+    bool native = !haveEnv("SPIRAL_HOME") && !cached &&
+      (getLibTransform("rconv", a_sizes) == nullptr);
+    return native ? fftx_native::numThreads() : 1;
+#endif
+  }
+
+  bool isEven(fftx::array_t<DIM, double>& a_kernel)
+  {
+    fftx::box_t<DIM> kbox = a_kernel.m_domain;
+    const double* kernelPtr = a_kernel.m_data.local();
+    double kmax = 0., diff = 0.;
+    for (size_t ind = 0; ind < kbox.size(); ind++)
+      {
+        fftx::point_t<DIM> p = pointFromPositionBox(ind, kbox);
+        fftx::point_t<DIM> pneg = p * (-1);
+        double mirror = isInBox(pneg, kbox) ? kernelPtr[positionInBox(pneg, kbox)] : 0.;
+        kmax = std::max(kmax, std::abs(kernelPtr[ind]));
+        diff = std::max(diff, std::abs(kernelPtr[ind] - mirror));
+      }
+    return (diff <= 1.e-12 * kmax);
+  }
+
+  /*
+    Symbol of the kernel on a periodic tile, the real part of its DFT
+    scaled by the number of points of the tile, computed one dimension at
+    a time from the kernel's own support.
+  */
+  void kernelSymbol(fftx::array_t<DIM, double>& a_kernel,
+                    fftx::array_t<DIM, double>& a_symbol)
+  {
+    fftx::box_t<DIM> kbox = a_kernel.m_domain;
+    fftx::point_t<DIM> kext = kbox.extents();
+    fftx::point_t<DIM> fext = m_tileFdomain.extents();
+    const double* kernelPtr = a_kernel.m_data.local();
+
+    // current extents, in order of dimension with the last fastest
+    std::vector<int> ext(kext.x, kext.x + DIM);
+    std::vector<std::complex<double>> cur(kbox.size());
+    for (size_t ind = 0; ind < kbox.size(); ind++)
+      {
+        fftx::point_t<DIM> p = pointFromPositionBox(ind, kbox);
+        size_t pos = 0;
+        for (int d = 0; d < DIM; d++) pos = pos * ext[d] + (p[d] - kbox.lo[d]);
+        cur[pos] = kernelPtr[ind];
+      }
+    for (int d = 0; d < DIM; d++)
+      {
+        size_t outer = 1, inner = 1;
+        for (int e = 0; e < d; e++) outer *= ext[e];
+        for (int e = d + 1; e < DIM; e++) inner *= ext[e];
+        std::vector<std::complex<double>> twiddle((size_t) fext[d] * ext[d]);
+        for (int k = 0; k < fext[d]; k++)
+          for (int j = 0; j < ext[d]; j++)
+            {
+              long long x = kbox.lo[d] + j;
+              long long phase = ((k * x) % m_tile[d] + m_tile[d]) % m_tile[d];
+              double th = -2. * M_PI * phase / (m_tile[d] * 1.);
+              twiddle[(size_t) k * ext[d] + j] = std::complex<double>(cos(th), sin(th));
+            }
+        std::vector<std::complex<double>> next(outer * fext[d] * inner, 0.);
+        for (size_t o = 0; o < outer; o++)
+          for (int k = 0; k < fext[d]; k++)
+            for (int j = 0; j < ext[d]; j++)
+              {
+                std::complex<double> w = twiddle[(size_t) k * ext[d] + j];
+                const std::complex<double>* src = &cur[(o * ext[d] + j) * inner];
+                std::complex<double>* dst = &next[(o * fext[d] + k) * inner];
+                for (size_t i = 0; i < inner; i++) dst[i] += w * src[i];
+              }
+        cur.swap(next);
+        ext[d] = fext[d];
+      }
+
+    double scaling = 1. / (m_tileDomain.size() * 1.);
+    double* symbolPtr = a_symbol.m_data.local();
+    for (size_t ind = 0; ind < m_tileFdomain.size(); ind++)
+      {
+        fftx::point_t<DIM> p = pointFromPositionBox(ind, m_tileFdomain);
+        size_t pos = 0;
+        for (int d = 0; d < DIM; d++) pos = pos * ext[d] + (p[d] - m_tileFdomain.lo[d]);
+        symbolPtr[ind] = cur[pos].real() * scaling;
+      }
+  }
+
+  // Convolve the tile of the block with low corner a_blockLo.
+  void convolveTile(int a_worker,
+                    const fftx::point_t<DIM>& a_blockLo,
+                    fftx::array_t<DIM, double>& a_input,
+                    fftx::array_t<DIM, double>& a_output)
+  {
+    fftx::box_t<DIM> inDomain = a_input.m_domain;
+    fftx::box_t<DIM> outDomain = a_output.m_domain;
+    const double* inputPtr = a_input.m_data.local();
+    double* outputPtr = a_output.m_data.local();
+    double* inTile = m_inputTiles[a_worker].data();
+    double* outTile = m_outputTiles[a_worker].data();
+
+    // tile point p holds input at a_blockLo - radius + (p - tile lo)
+    fftx::point_t<DIM> shift;
+    for (int d = 0; d < DIM; d++)
+      {
+        shift[d] = a_blockLo[d] - m_radius[d] - m_tileDomain.lo[d];
+      }
+    size_t npts = m_tileDomain.size();
+    for (size_t ind = 0; ind < npts; ind++)
+      {
+        fftx::point_t<DIM> p = pointFromPositionBox(ind, m_tileDomain);
+        for (int d = 0; d < DIM; d++) p[d] += shift[d];
+        inTile[ind] = isInBox(p, inDomain) ? inputPtr[positionInBox(p, inDomain)] : 0.;
+      }
+
+    fftx::array_t<DIM, double> inArray(fftx::global_ptr<double>(inTile), m_tileDomain);
+    fftx::array_t<DIM, double> outArray(fftx::global_ptr<double>(outTile), m_tileDomain);
+    m_plans[a_worker].apply(inArray, outArray);
+
+    for (size_t ind = 0; ind < npts; ind++)
+      {
+        fftx::point_t<DIM> p = pointFromPositionBox(ind, m_tileDomain);
+        bool inBlock = true;
+        for (int d = 0; d < DIM; d++)
+          {
+            int off = p[d] - m_tileDomain.lo[d] - m_radius[d];
+            inBlock = inBlock && (off >= 0) && (off < m_block[d]);
+            p[d] += shift[d];
+          }
+        if (inBlock && isInBox(p, outDomain))
+          {
+            outputPtr[positionInBox(p, outDomain)] = outTile[ind];
+          }
+      }
+  }
+};
+
+#endif
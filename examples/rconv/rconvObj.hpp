@@ -48,4 +48,27 @@ public:
 
         closeScalarDAG(intermediates, name.c_str());
     }
+#if !defined (FFTX_CUDA) && !defined (FFTX_HIP)
+    bool nativeTransform() {
+        std::vector<int> n(sizes.begin(), sizes.begin() + 3);
+        int trunc = FFTX_COMPLEX_TRUNC_LAST ? 2 : 0;
+        #if !FFTX_ROW_MAJOR_ORDER
+        std::reverse(n.begin(), n.end());
+        trunc = 2 - trunc;
+        #endif
+        size_t nspec = (size_t)n[0] * n[1] * n[2] / n[trunc] * (n[trunc]/2 + 1);
+        if(work.size() != nspec)
+            work.resize(nspec);
+        fftx_native::mdprdft(3, n.data(), trunc, work.data(), (double*)args.at(1));
+        const double * symbol = (const double*)args.at(2);
+        for(size_t i = 0; i < nspec; i++)
+            work[i] *= symbol[i];
+        fftx_native::imdprdft(3, n.data(), trunc, (double*)args.at(0), work.data());
+        return true;
+    }
+
+protected:
+    // spectrum, kept between calls of the same size
+    std::vector<std::complex<double>> work;
+#endif
 };
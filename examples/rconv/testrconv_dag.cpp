@@ -0,0 +1,150 @@
+#include <cmath> // Without this, abs is the wrong function!
+#include <random>
+#include <vector>
+
+#include "daglib.hpp"
+
+// Periodic convolution of a_input with the 27-point stencil that is the
+// tensor product of [a_side, a_centre, a_side] along each axis.
+void stencilConvolution(const std::vector<double>& a_input,
+                        std::vector<double>& a_output,
+                        const std::vector<int>& a_n,
+                        double a_centre, double a_side)
+{
+  double w[3] = {a_side, a_centre, a_side};
+  for (int i = 0; i < a_n[0]; i++)
+    for (int j = 0; j < a_n[1]; j++)
+      for (int k = 0; k < a_n[2]; k++)
+        {
+          double sum = 0.;
+          for (int di = -1; di <= 1; di++)
+            for (int dj = -1; dj <= 1; dj++)
+              for (int dk = -1; dk <= 1; dk++)
+                {
+                  int ii = (i + di + a_n[0]) % a_n[0];
+                  int jj = (j + dj + a_n[1]) % a_n[1];
+                  int kk = (k + dk + a_n[2]) % a_n[2];
+                  sum += w[di+1] * w[dj+1] * w[dk+1] *
+                    a_input[((size_t)ii * a_n[1] + jj) * a_n[2] + kk];
+                }
+          a_output[((size_t)i * a_n[1] + j) * a_n[2] + k] = sum;
+        }
+}
+
+// Real-to-complex DFT, pointwise multiply, complex-to-real DFT, in one graph.
+fftx_dag::graph convolutionGraph(const std::vector<int>& a_n)
+{
+  fftx_dag::graph g;
+  std::vector<int> h = fftx_dag::halfExtents(a_n);
+  fftx_dag::var x = g.input(a_n);
+  fftx_dag::var y = g.output(a_n);
+  fftx_dag::var spectrum = g.local(h, fftx_dag::COMPLEX);
+  fftx_dag::var product = g.local(h, fftx_dag::COMPLEX);
+  g.prdft(spectrum, x, a_n);
+  g.diagonal(product, spectrum);
+  g.iprdft(y, product, a_n);
+  return g;
+}
+
+int main(int argc, char* argv[])
+{
+  int mm = 24, nn = 32, kk = 40; // default cube dimensions
+  char *prog = argv[0];
+  int baz = 0;
+  int rounds = 2;
+  while ( argc > 1 && argv[1][0] == '-' ) {
+      switch ( argv[1][1] ) {
+      case 'i':
+          argv++, argc--;
+          rounds = atoi ( argv[1] );
+          break;
+      case 's':
+          argv++, argc--;
+          mm = atoi ( argv[1] );
+          while ( argv[1][baz] != 'x' ) baz++;
+          baz++ ;
+          nn = atoi ( & argv[1][baz] );
+          while ( argv[1][baz] != 'x' ) baz++;
+          baz++ ;
+          kk = atoi ( & argv[1][baz] );
+          break;
+      case 'h':
+          printf ( "Usage: %s: [ -i rounds ] [ -s MMxNNxKK ] [ -h (print help message) ]\n", argv[0] );
+          exit (0);
+      default:
+          printf ( "%s: unknown argument: %s ... ignored\n", prog, argv[1] );
+      }
+      argv++, argc--;
+  }
+
+  std::vector<int> n{mm, nn, kk};
+  fftx_dag::graph g = convolutionGraph(n);
+  if (g.hashString() != convolutionGraph(n).hashString())
+    {
+      printf("%s: graph hash is not stable\n", prog);
+      return 1;
+    }
+
+  // symbol of the stencil, scaled by 1/N for the unnormalized inverse
+  std::mt19937 generator(std::random_device{}());
+  std::uniform_real_distribution<double> unif(-0.5, 0.5);
+  double centre = unif(generator), side = unif(generator);
+  std::vector<int> h = fftx_dag::halfExtents(n);
+  std::vector<double> symbol(g.symbolDoubles());
+  double npts = (double) mm * nn * kk;
+  for (int i = 0; i < h[0]; i++)
+    for (int j = 0; j < h[1]; j++)
+      for (int k = 0; k < h[2]; k++)
+        {
+          double si = centre + 2. * side * cos(2. * M_PI * i / mm);
+          double sj = centre + 2. * side * cos(2. * M_PI * j / nn);
+          double sk = centre + 2. * side * cos(2. * M_PI * k / kk);
+          symbol[((size_t)i * h[1] + j) * h[2] + k] = si * sj * sk / npts;
+        }
+
+  std::vector<double> input(mm * nn * kk), output(mm * nn * kk), reference(mm * nn * kk);
+  double* X[1] = {input.data()};
+  double* Y[1] = {output.data()};
+  DAGProblem conv(std::vector<void*>{(void*)Y, (void*)X, (void*)symbol.data()}, g);
+
+  double err = 0.;
+  for (int itn = 1; itn <= rounds; itn++)
+    {
+      for (double& v : input) v = unif(generator);
+      conv.transform();
+      stencilConvolution(input, reference, n, centre, side);
+      for (size_t i = 0; i < output.size(); i++)
+        err = std::max(err, std::abs(output[i] - reference[i]));
+    }
+  printf("%dx%dx%d fused convolution %s in %d rounds max error %11.5e\n",
+         mm, nn, kk, conv.name.c_str(), rounds, err);
+  printf("fused %d chain(s), %lu bytes of intermediate arrays removed\n",
+         conv.fusion().chains, (unsigned long) (8 * conv.fusion().doublesSaved));
+
+  // the same problem with another graph of one input and one output: the
+  // real DFT and its inverse, N times the input, not the convolution
+  fftx_dag::graph round;
+  {
+    fftx_dag::var x = round.input(n);
+    fftx_dag::var y = round.output(n);
+    fftx_dag::var spectrum = round.local(h, fftx_dag::COMPLEX);
+    round.prdft(spectrum, x, n);
+    round.iprdft(y, spectrum, n);
+  }
+  std::string convName = conv.name;
+  conv.setGraph(round);
+  if (conv.name == convName || !conv.executors.empty())
+    {
+      printf("%s: setGraph kept the kernel of the previous graph\n", prog);
+      return 1;
+    }
+  conv.transform();
+  double errRound = 0.;
+  for (size_t i = 0; i < output.size(); i++)
+    errRound = std::max(errRound, std::abs(output[i] / npts - input[i]));
+  printf("%dx%dx%d second graph %s on the same problem max error %11.5e\n",
+         mm, nn, kk, conv.name.c_str(), errRound);
+
+  printf("%s: All done, exiting\n", prog);
+  return 0;
+}
@@ -0,0 +1,128 @@
+#include <cmath> // Without this, abs is the wrong function!
+#include <random>
+#include <vector>
+
+#include "hockneylib.hpp"
+#include "daglib.hpp"
+#include "transformlib.hpp"
+
+// Smoothed Coulomb kernel, even in each coordinate.
+double green(int a_i, int a_j, int a_k)
+{
+  return 1. / sqrt(1. + a_i*a_i + a_j*a_j + a_k*a_k);
+}
+
+// Direct free-space convolution of a_input (zero outside the box) with green.
+void directConvolution(const std::vector<double>& a_input,
+                       std::vector<double>& a_output,
+                       const std::vector<int>& a_n)
+{
+  for (int i = 0; i < a_n[0]; i++)
+    for (int j = 0; j < a_n[1]; j++)
+      for (int k = 0; k < a_n[2]; k++)
+        {
+          double sum = 0.;
+          for (int ii = 0; ii < a_n[0]; ii++)
+            for (int jj = 0; jj < a_n[1]; jj++)
+              for (int kk = 0; kk < a_n[2]; kk++)
+                {
+                  sum += green(i - ii, j - jj, k - kk) *
+                    a_input[((size_t)ii * a_n[1] + jj) * a_n[2] + kk];
+                }
+          a_output[((size_t)i * a_n[1] + j) * a_n[2] + k] = sum;
+        }
+}
+
+int main(int argc, char* argv[])
+{
+  int mm = 12, nn = 16, kk = 20; // default cube dimensions
+  char *prog = argv[0];
+  int baz = 0;
+  int rounds = 2;
+  while ( argc > 1 && argv[1][0] == '-' ) {
+      switch ( argv[1][1] ) {
+      case 'i':
+          argv++, argc--;
+          rounds = atoi ( argv[1] );
+          break;
+      case 's':
+          argv++, argc--;
+          mm = atoi ( argv[1] );
+          while ( argv[1][baz] != 'x' ) baz++;
+          baz++ ;
+          nn = atoi ( & argv[1][baz] );
+          while ( argv[1][baz] != 'x' ) baz++;
+          baz++ ;
+          kk = atoi ( & argv[1][baz] );
+          break;
+      case 'h':
+          printf ( "Usage: %s: [ -i rounds ] [ -s MMxNNxKK ] [ -h (print help message) ]\n", argv[0] );
+          exit (0);
+      default:
+          printf ( "%s: unknown argument: %s ... ignored\n", prog, argv[1] );
+      }
+      argv++, argc--;
+  }
+
+  std::vector<int> n{mm, nn, kk};
+  std::vector<int> padded{2*mm, 2*nn, 2*kk};
+
+  // symbol: real DFT of the kernel on the doubled domain, scaled by 1/(8N)
+  std::vector<double> kernel(padded[0] * padded[1] * padded[2]);
+  for (int i = 0; i < padded[0]; i++)
+    for (int j = 0; j < padded[1]; j++)
+      for (int k = 0; k < padded[2]; k++)
+        {
+          int di = (i < mm) ? i : i - padded[0];
+          int dj = (j < nn) ? j : j - padded[1];
+          int dk = (k < kk) ? k : k - padded[2];
+          kernel[((size_t)i * padded[1] + j) * padded[2] + k] = green(di, dj, dk);
+        }
+  std::vector<int> h = fftx_dag::halfExtents(padded);
+  std::vector<std::complex<double>> spectrum(h[0] * h[1] * h[2]);
+  MDPRDFTProblem mdp(std::vector<void*>{(void*)spectrum.data(), (void*)kernel.data(), nullptr},
+                     padded, "mdprdft");
+  mdp.transform();
+  std::vector<double> symbol(spectrum.size());
+  double npts = 8. * mm * nn * kk;
+  for (size_t i = 0; i < symbol.size(); i++)
+    symbol[i] = spectrum[i].real() / npts;
+
+  std::vector<double> input(mm * nn * kk), output(mm * nn * kk), reference(mm * nn * kk);
+  HockneyProblem hp(std::vector<void*>{(void*)output.data(), (void*)input.data(), (void*)symbol.data()},
+                    n, "hockney");
+
+  // the same convolution as a runtime graph: the fusion pass folds the
+  // zero embedding and the extraction into the convolution
+  fftx_dag::graph g = freeSpaceConvolutionGraph(n);
+  std::vector<double> dagOutput(mm * nn * kk);
+  double* X[1] = {input.data()};
+  double* Y[1] = {dagOutput.data()};
+  DAGProblem dp(std::vector<void*>{(void*)Y, (void*)X, (void*)symbol.data()}, g);
+
+  std::mt19937 generator(std::random_device{}());
+  std::uniform_real_distribution<double> unif(-0.5, 0.5);
+  double err = 0., errDag = 0.;
+  for (int itn = 1; itn <= rounds; itn++)
+    {
+      for (double& v : input) v = unif(generator);
+      hp.transform();
+      dp.transform();
+      directConvolution(input, reference, n);
+      for (size_t i = 0; i < output.size(); i++)
+        {
+          err = std::max(err, std::abs(output[i] - reference[i]));
+          errDag = std::max(errDag, std::abs(dagOutput[i] - reference[i]));
+        }
+    }
+  printf("%dx%dx%d free-space convolution in %d rounds max error %11.5e\n",
+         mm, nn, kk, rounds, err);
+  printf("%dx%dx%d free-space convolution graph %s max error %11.5e\n",
+         mm, nn, kk, dp.name.c_str(), errDag);
+  printf("fused %d chain(s) with %d box(es), %lu bytes of intermediate arrays removed\n",
+         dp.fusion().chains, dp.fusion().prunedBoxes,
+         (unsigned long) (8 * dp.fusion().doublesSaved));
+
+  printf("%s: All done, exiting\n", prog);
+  return 0;
+}
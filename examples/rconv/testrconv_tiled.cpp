@@ -0,0 +1,162 @@
+#include <cmath> // Without this, abs is the wrong function!
+#include <random>
+#include <chrono>
+
+#include "TiledConvolution.hpp"
+#include "fftx3utilities.h"
+
+// Direct non-periodic convolution of a_input with a_kernel on the domain of a_output.
+void directConvolution(fftx::array_t<3, double>& a_input,
+                       fftx::array_t<3, double>& a_kernel,
+                       fftx::array_t<3, double>& a_output)
+{
+  fftx::box_t<3> inDomain = a_input.m_domain;
+  fftx::box_t<3> kDomain = a_kernel.m_domain;
+  fftx::box_t<3> outDomain = a_output.m_domain;
+  auto inputPtr = a_input.m_data.local();
+  auto kernelPtr = a_kernel.m_data.local();
+  auto outputPtr = a_output.m_data.local();
+  for (size_t ind = 0; ind < outDomain.size(); ind++)
+    {
+      fftx::point_t<3> p = pointFromPositionBox(ind, outDomain);
+      double sum = 0.;
+      for (size_t kind = 0; kind < kDomain.size(); kind++)
+        {
+          fftx::point_t<3> k = pointFromPositionBox(kind, kDomain);
+          fftx::point_t<3> q;
+          for (int d = 0; d < 3; d++) q[d] = p[d] - k[d];
+          if (isInBox(q, inDomain))
+            {
+              sum += kernelPtr[kind] * inputPtr[positionInBox(q, inDomain)];
+            }
+        }
+      outputPtr[ind] = sum;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+  int mm = 100, nn = 80, kk = 60; // default domain dimensions
+  int offx = 3, offy = 5, offz = 11; // offsets
+  char *prog = argv[0];
+  int baz = 0;
+  int radius = 3;
+  int threads = 0;
+  int tile = 0;
+  int rounds = 2;
+  while ( argc > 1 && argv[1][0] == '-' ) {
+      switch ( argv[1][1] ) {
+      case 'i':
+          argv++, argc--;
+          rounds = atoi ( argv[1] );
+          break;
+      case 'r':
+          argv++, argc--;
+          radius = atoi ( argv[1] );
+          break;
+      case 'n':
+          argv++, argc--;
+          tile = atoi ( argv[1] );
+          break;
+      case 't':
+          argv++, argc--;
+          threads = atoi ( argv[1] );
+          break;
+      case 's':
+          argv++, argc--;
+          mm = atoi ( argv[1] );
+          while ( argv[1][baz] != 'x' ) baz++;
+          baz++ ;
+          nn = atoi ( & argv[1][baz] );
+          while ( argv[1][baz] != 'x' ) baz++;
+          baz++ ;
+          kk = atoi ( & argv[1][baz] );
+          break;
+      case 'h':
+          printf ( "Usage: %s: [ -i rounds ] [ -r kernel radius ] [ -n tile cube size (default: chosen) ] [ -t threads (default: automatic) ] [ -s MMxNNxKK ] [ -h (print help message) ]\n", argv[0] );
+          exit (0);
+      default:
+          printf ( "%s: unknown argument: %s ... ignored\n", prog, argv[1] );
+      }
+      argv++, argc--;
+  }
+
+  std::random_device rd;
+  generator = std::mt19937(rd());
+  unifRealDist = std::uniform_real_distribution<double>(-0.5, 0.5);
+
+  fftx::point_t<3> extents({{mm, nn, kk}});
+  fftx::point_t<3> offsets({{offx, offy, offz}});
+  fftx::box_t<3> domain3 = domainFromSize(extents, offsets);
+
+  // random even kernel on [-radius, radius]^3
+  fftx::point_t<3> rad({{radius, radius, radius}});
+  fftx::box_t<3> kdomain3(rad * (-1), fftx::point_t<3>(rad));
+  fftx::array_t<3, double> kernel(kdomain3);
+  auto kernelPtr = kernel.m_data.local();
+  for (size_t ind = 0; ind < kdomain3.size(); ind++)
+    {
+      fftx::point_t<3> p = pointFromPositionBox(ind, kdomain3);
+      size_t mirror = positionInBox(p * (-1), kdomain3);
+      kernelPtr[ind] = (mirror < ind) ? kernelPtr[mirror] : unifReal();
+    }
+
+  fftx::point_t<3> tileSize({{tile, tile, tile}});
+  if (tile == 0)
+    {
+      tileSize = TiledConvolution<3>::chooseTile(rconvLibrarySizes(), rad, extents);
+    }
+  TiledConvolution<3> conv(tileSize, kernel, threads);
+  if (!conv.isDefined())
+    {
+      return 1;
+    }
+
+  fftx::array_t<3, double> input(domain3);
+  fftx::array_t<3, double> output(domain3);
+  fftx::array_t<3, double> reference(domain3);
+  // roundoff of the tile transforms grows with the sum of |kernel| times
+  // the largest input value; a wrong result is off by far more
+  double kernelSum = 0.;
+  for (size_t ind = 0; ind < kdomain3.size(); ind++)
+    {
+      kernelSum += std::abs(kernelPtr[ind]);
+    }
+  double tol = 0.;
+  double err = 0.;
+  double msec = 0.;
+  for (int itn = 1; itn <= rounds; itn++)
+    {
+      unifRealArray(input);
+      auto start = std::chrono::high_resolution_clock::now();
+      conv.exec(input, output);
+      auto stop = std::chrono::high_resolution_clock::now();
+      std::chrono::duration<double, std::milli> duration = stop - start;
+      msec = (itn == 1) ? duration.count() : std::min(msec, duration.count());
+      updateMax(tol, 1.e-12 * kernelSum * absMaxArray(input));
+      directConvolution(input, kernel, reference);
+      updateMax(err, absMaxDiffArray(output, reference));
+    }
+  printf("%dx%dx%d domain, kernel radius %d, %d tiles of size %dx%dx%d on %d threads: %.3f ms\n",
+         mm, nn, kk, radius, (int) conv.tiles(),
+         tileSize[0], tileSize[1], tileSize[2], conv.threads(), msec);
+  bool ok = (err < tol);
+  printf("tiled convolution in %d rounds max error %11.5e (tolerance %11.5e) ... %s\n",
+         rounds, err, tol, ok ? "PASSED" : "FAILED");
+
+  // an asymmetric kernel must be rejected, not replaced by its even part
+  kernelPtr[positionInBox(rad, kdomain3)] += 1.;
+  bool rejected = false;
+  try
+    {
+      TiledConvolution<3> bad(tileSize, kernel, threads);
+    }
+  catch (const std::invalid_argument&)
+    {
+      rejected = true;
+    }
+  printf("asymmetric kernel %s\n", rejected ? "rejected" : "NOT rejected");
+
+  printf("%s: All done, exiting\n", prog);
+  return (ok && rejected) ? 0 : 1;
+}
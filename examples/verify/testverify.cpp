@@ -5,10 +5,8 @@
 #include "device_macros.h"
 
 #include "VerifyTransform.hpp"
-#include "mddftObj.hpp"
-#include "imddftObj.hpp"
-#include "mdprdftObj.hpp"
-#include "imdprdftObj.hpp"
+#include "mddftlib.hpp"
+#include "mdprdftlib.hpp"
 
 template<int DIM>
 void verifyDimension(fftx::box_t<DIM> a_domain,
@@ -98,6 +96,7 @@ void verifyDimension(fftx::point_t<DIM>& a_fullExtents, // need for templating
                      MDPRDFTProblem& a_mdprdft,
                      IMDPRDFTProblem& a_imdprdft,
                      int a_rounds,
+                     int a_samples,
                      int a_verbosity)
 {
   {
@@ -106,8 +105,12 @@ void verifyDimension(fftx::point_t<DIM>& a_fullExtents, // need for templating
               << a_fullExtents << std::endl;
     TransformFunction<DIM, std::complex<double>, std::complex<double>>
       funprob(&a_mddft, -1);
-    VerifyTransform<DIM, std::complex<double>, std::complex<double>>
-      (funprob, a_rounds, a_verbosity);
+    if (a_samples > 0)
+      VerifySampledTransform<DIM, std::complex<double>, std::complex<double>>
+        (funprob, a_samples, a_verbosity);
+    else
+      VerifyTransform<DIM, std::complex<double>, std::complex<double>>
+        (funprob, a_rounds, a_verbosity);
   }
 
   {
@@ -116,8 +119,12 @@ void verifyDimension(fftx::point_t<DIM>& a_fullExtents, // need for templating
               << a_fullExtents << std::endl;
     TransformFunction<DIM, std::complex<double>, std::complex<double>>
       funprob(&a_imddft, 1);
-    VerifyTransform<DIM, std::complex<double>, std::complex<double>>
-      (funprob, a_rounds, a_verbosity);
+    if (a_samples > 0)
+      VerifySampledTransform<DIM, std::complex<double>, std::complex<double>>
+        (funprob, a_samples, a_verbosity);
+    else
+      VerifyTransform<DIM, std::complex<double>, std::complex<double>>
+        (funprob, a_rounds, a_verbosity);
   }
 
   {
@@ -126,8 +133,12 @@ void verifyDimension(fftx::point_t<DIM>& a_fullExtents, // need for templating
               << a_fullExtents << std::endl;
     TransformFunction<DIM, double, std::complex<double>>
       funprob(&a_mdprdft, -1);
-    VerifyTransform<DIM, double, std::complex<double>>
-      (funprob, a_rounds, a_verbosity);
+    if (a_samples > 0)
+      VerifySampledTransform<DIM, double, std::complex<double>>
+        (funprob, a_samples, a_verbosity);
+    else
+      VerifyTransform<DIM, double, std::complex<double>>
+        (funprob, a_rounds, a_verbosity);
   }
 
   {
@@ -136,8 +147,12 @@ void verifyDimension(fftx::point_t<DIM>& a_fullExtents, // need for templating
               << a_fullExtents << std::endl;
     TransformFunction<DIM, std::complex<double>, double>
       funprob(&a_imdprdft, 1);
-    VerifyTransform<DIM, std::complex<double>, double>
-      (funprob, a_rounds, a_verbosity);
+    if (a_samples > 0)
+      VerifySampledTransform<DIM, std::complex<double>, double>
+        (funprob, a_samples, a_verbosity);
+    else
+      VerifyTransform<DIM, std::complex<double>, double>
+        (funprob, a_rounds, a_verbosity);
   }
 }
                     
@@ -150,6 +165,7 @@ int main(int argc, char* argv[])
   int baz = 0;
   int verbosity = 0;
   int rounds = 2;
+  int samples = 0;
   while ( argc > 1 && argv[1][0] == '-' ) {
       switch ( argv[1][1] ) {
       case 'i':
@@ -170,8 +186,12 @@ int main(int argc, char* argv[])
           argv++, argc--;
           verbosity = atoi ( argv[1] );
           break;
+      case 'd':
+          argv++, argc--;
+          samples = atoi ( argv[1] );
+          break;
       case 'h':
-          printf ( "Usage: %s: [ -i rounds ] [-v verbosity: 0 for summary, 1 for categories, 2 for subtests, 3 for all iterations] [ -s MMxNNxKK ] [ -h (print help message) ]\n", argv[0] );
+          printf ( "Usage: %s: [ -i rounds ] [-v verbosity: 0 for summary, 1 for categories, 2 for subtests, 3 for all iterations] [ -s MMxNNxKK ] [ -d samples (check samples against direct DFT instead) ] [ -h (print help message) ]\n", argv[0] );
           exit (0);
       default:
           printf ( "%s: unknown argument: %s ... ignored\n", prog, argv[1] );
@@ -239,7 +259,7 @@ int main(int argc, char* argv[])
   IMDPRDFTProblem imdprdft(args, sizes, "imdprdft");
   fftx::point_t<3> fullExtents({{mm, nn, kk}});
   verifyDimension(fullExtents, mddft, imddft, mdprdft, imdprdft,
-                  rounds, verbosity);
+                  rounds, samples, verbosity);
 
   /*
   // printf("Call mddft3::init()\n");
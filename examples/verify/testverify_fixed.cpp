@@ -0,0 +1,60 @@
+#include <cmath> // Without this, abs returns zero!
+#include <random>
+
+#include "fftx_mddft_cpu_public.h"
+#include "mddft.fftx.precompile.hpp"
+
+#include "fftx3utilities.h"
+
+#include "device_macros.h"
+#include "VerifyTransform.hpp"
+
+// The first size in the compile-time size table of the mddft library,
+// so the fixed-size transform below always names a size that was built.
+static constexpr int NX = fftx_mddft_ConstSizes[0][0];
+static constexpr int NY = fftx_mddft_ConstSizes[0][1];
+static constexpr int NZ = fftx_mddft_ConstSizes[0][2];
+static_assert ( fftx_mddft_NumSizes > 0, "testverify_fixed: the mddft library has no sizes" );
+
+int main(int argc, char* argv[])
+{
+  char *prog = argv[0];
+  int verbosity = 0;
+  int samples = 16;
+  while ( argc > 1 && argv[1][0] == '-' ) {
+      switch ( argv[1][1] ) {
+      case 'd':
+          argv++, argc--;
+          samples = atoi ( argv[1] );
+          break;
+      case 'v':
+          argv++, argc--;
+          verbosity = atoi ( argv[1] );
+          break;
+      case 'h':
+          printf ( "Usage: %s: [ -d samples ] [-v verbosity: 0 for summary, 1 for categories, 2 for subtests, 3 for all iterations] [ -h (print help message) ]\n", argv[0] );
+          exit (0);
+      default:
+          printf ( "%s: unknown argument: %s ... ignored\n", prog, argv[1] );
+      }
+      argv++, argc--;
+  }
+
+  std::random_device rd;
+  generator = std::mt19937(rd());
+  unifRealDist = std::uniform_real_distribution<double>(-0.5, 0.5);
+
+  // mddft_fixed binds the generated functions of its size directly; the
+  // reference is a direct DFT at sampled output points, not another
+  // lookup of the same library kernel
+  fftx::mddft_fixed<NX, NY, NZ> tfm;
+  TransformFunction<3, std::complex<double>, std::complex<double>> fun ( &tfm, -1 );
+  VerifySampledTransform<3, std::complex<double>, std::complex<double>>
+    check ( fun, samples, verbosity );
+
+  bool ok = ( check.error() < 1.e-12 );
+  printf ( "%s %dx%dx%d against direct DFT: %s\n",
+           tfm.shortname().c_str(), NX, NY, NZ, ok ? "PASSED" : "FAILED" );
+  printf ( "%s: All done, exiting\n", prog );
+  return ok ? 0 : 1;
+}
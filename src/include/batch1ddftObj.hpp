@@ -1,3 +1,4 @@
+#pragma once
 
 static std::string batch1ddft_script = "transform := let(\n\
          TFCall(TRC(TTensorI(DFT(N, sign), B, write, read)),\n\
@@ -27,4 +28,12 @@ public:
         std::cout << "name := \""<< name << "_spiral" << "\";" << std::endl;
         std::cout << batch1ddft_script << std::endl;
     }
+#if !defined (FFTX_CUDA) && !defined (FFTX_HIP)
+    bool nativeTransform() {
+        fftx_native::batchdft(sizes.at(0), sizes.at(1), sizes.at(2), sizes.at(3),
+                              (std::complex<double>*)args.at(0),
+                              (std::complex<double>*)args.at(1), -1);
+        return true;
+    }
+#endif
 };
@@ -46,6 +46,7 @@
 #include <cstring>
 #include <chrono>
 #include <regex>
+#include <functional>
 #pragma once
 
 #if defined ( PRINTDEBUG )
@@ -94,6 +95,8 @@ class Executor {
     private:
         void * shared_lib;
         float CPUTime;
+        std::string dir = "temp";   // build directory, one per generated kernel
+        void load();
     public:
         float initAndLaunch(std::vector<void*>& args, std::string name);
         void execute(std::string file_name);
@@ -101,15 +104,18 @@ class Executor {
         //void returnData(std::vector<fftx::array_t<3,std::complex<double>>> &out1);
 };
 
-float Executor::initAndLaunch(std::vector<void*>& args, std::string name) {
+// Load the library built in dir; the library stays loaded for the life of
+// the program, since copies of the executor (e.g., in the executors of an
+// FFTXProblem) share it.
+void Executor::load() {
     if ( DEBUGOUT) std::cout << "Loading shared library\n";
 
     #if defined (_WIN32) || defined (_WIN64)
-        shared_lib = (void *)LoadLibrary("temp/Release/tmp.dll");
+        shared_lib = (void *)LoadLibrary((dir + "/Release/tmp.dll").c_str());
     #elif defined(__APPLE__)
-        shared_lib = dlopen("temp/libtmp.dylib", RTLD_LAZY);
+        shared_lib = dlopen((dir + "/libtmp.dylib").c_str(), RTLD_LAZY);
     #else
-        shared_lib = dlopen("temp/libtmp.so", RTLD_LAZY); 
+        shared_lib = dlopen((dir + "/libtmp.so").c_str(), RTLD_LAZY); 
     #endif
 
     if(!shared_lib) {
@@ -125,7 +131,9 @@ float Executor::initAndLaunch(std::vector<void*>& args, std::string name) {
         #endif
         exit(0);
     }
+}
 
+float Executor::initAndLaunch(std::vector<void*>& args, std::string name) {
     std::ostringstream oss;
     std::ostringstream oss1;
     std::ostringstream oss2;
@@ -146,31 +154,26 @@ float Executor::initAndLaunch(std::vector<void*>& args, std::string name) {
         void (*fn3) ()= (void (*)())dlsym(shared_lib, destroy.c_str());
     #endif
 
-    auto start = std::chrono::high_resolution_clock::now();
     if(fn1) {
         fn1();
     }else {
         std::cout << init << "function didnt run" << std::endl;
     }
+    // the kernel time is the transform alone, as for the library transforms
+    auto start = std::chrono::high_resolution_clock::now();
     if(fn2) {
         fn2((double*)args.at(0),(double*)args.at(1), (double*)args.at(2));
     }else {
         std::cout << transform << "function didnt run" << std::endl;
     }
+    auto stop = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<float, std::milli> duration = stop - start;
+    CPUTime = duration.count();
     if(fn3){
         fn3();
     }else {
         std::cout << destroy << "function didnt run" << std::endl;
     }
-    auto stop = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<float, std::milli> duration = stop - start;
-    CPUTime = duration.count();
-        
-    #if defined (_WIN32) || defined (_WIN64)
-        FreeLibrary ( (HMODULE) shared_lib );
-    #else
-        dlclose(shared_lib);
-    #endif
 
     return getKernelTime();
 }
@@ -184,30 +187,35 @@ void Executor::execute(std::string result) {
     char* getcwdret = getcwd( buff, FILENAME_MAX );
     std::string current_working_dir(buff);
 
+    std::string result2 = result.substr(result.find("#include"));
+
+    // Each kernel gets its own build directory, so that several executors
+    // (e.g., the passes of a pencil transform) can be loaded side by side.
+    dir = "temp_" + std::to_string(std::hash<std::string>()(result2));
+
     struct stat sb;
 
     int systemret;
-    if(stat((current_working_dir+"/temp").c_str(), &sb) == 0)
-        systemret = system("rm -rf temp");
+    if(stat((current_working_dir+"/"+dir).c_str(), &sb) == 0)
+        systemret = system(("rm -rf " + dir).c_str());
         
     if ( DEBUGOUT) {
         std::cout << "created compile\n";
     }
 
-    std::string result2 = result.substr(result.find("#include"));
     #if defined (_WIN32) || defined (_WIN64)
-        int check = _mkdir("temp");
+        int check = _mkdir(dir.c_str());
     #else
-        int check = mkdir("temp", 0777);
+        int check = mkdir(dir.c_str(), 0777);
     #endif
     if(check != 0) {
         std::cout << "failed to create temp directory for runtime code\n";
         exit(-1);
     }
-    std::ofstream out("temp/spiral_generated.c");
+    std::ofstream out(dir + "/spiral_generated.c");
     out << result2;
     out.close();
-    std::ofstream cmakelists("temp/CMakeLists.txt");
+    std::ofstream cmakelists(dir + "/CMakeLists.txt");
     if(DEBUGOUT)
         cmakelists << "set ( _addl_options -Wall )" << std::endl;       //  -Wextra
 
@@ -216,7 +224,7 @@ void Executor::execute(std::string result) {
     if ( DEBUGOUT )
         std::cout << "compiling\n";
     
-    check = chdir("temp");
+    check = chdir(dir.c_str());
     if(check != 0) {
         std::cout << "failed to change to temp directory for runtime code\n";
         exit(-1);
@@ -244,6 +252,13 @@ void Executor::execute(std::string result) {
     // systemret = system("cd ..;");
     if ( DEBUGOUT )
         std::cout << "finished compiling\n";
+
+    // once loaded the library no longer needs its build directory (Windows
+    // keeps a loaded DLL locked, so the directory stays there)
+    load();
+    #if !defined (_WIN32) && !defined (_WIN64)
+        systemret = system(("rm -rf " + dir).c_str());
+    #endif
 }
 
 float Executor::getKernelTime() {
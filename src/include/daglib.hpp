@@ -0,0 +1,316 @@
+#ifndef FFTX_DAGLIB_HEADER
+#define FFTX_DAGLIB_HEADER
+
+//  Copyright (c) 2018-2022, Carnegie Mellon University
+//  See LICENSE for details
+
+#include "interface.hpp"
+#include "fftxdag.hpp"
+
+/*
+ Fused pipelines built at run time.  A DAGProblem takes an fftx_dag::graph
+ (see fftxdag.hpp), generates one kernel for the whole graph, and caches it
+ like the other problems: in memory, and on disk under the graph's hash, so
+ the same pipeline built by another run is not generated again.
+
+ args are {Y, X, sym}: Y and X arrays of pointers to the output and input
+ fields, in the order the graph declared them, and sym the buffer of the
+ pointwise symbols (graph.symbolDoubles() doubles; nullptr if none).  On
+ the GPU backends these are device pointers, passed as for the other
+ problems.
+
+     fftx_dag::graph g;
+     fftx_dag::var x = g.input({nz, ny, nx});
+     fftx_dag::var y = g.output({nz, ny, nx});
+     fftx_dag::var s = g.local({nz, ny, nx/2+1}, fftx_dag::COMPLEX);
+     fftx_dag::var t = g.local({nz, ny, nx/2+1}, fftx_dag::COMPLEX);
+     g.prdft(s, x, {nz, ny, nx});
+     g.diagonal(t, s);
+     g.iprdft(y, t, {nz, ny, nx});
+
+     double* X[1] = {in};
+     double* Y[1] = {out};
+     DAGProblem conv(std::vector<void*>{Y, X, symbol}, g);
+     conv.transform();
+
+ FFT-pointwise-IFFT chains in the graph are fused first, with a zero
+ embedding before and an extraction after them, and extractions of a box
+ of the output of a transform are folded into it (see fuse() in
+ fftxdag.hpp; fusion() reports what was fused).  On CPU, without SPIRAL,
+ the graph is evaluated node by node on the native engine (all nodes
+ except RAW); fused free-space convolutions and sub-box transforms run the
+ pruned transforms of fftxnative.hpp, and RESAMPLE nodes the fused line
+ resampling of mdresample.
+*/
+
+class DAGProblem: public FFTXProblem {
+public:
+    DAGProblem() {
+    }
+    DAGProblem(const fftx_dag::graph& g) {
+        setGraph(g);
+    }
+    DAGProblem(const std::vector<void*>& args1, const fftx_dag::graph& g) {
+        args = args1;
+        setGraph(g);
+    }
+
+    // The kernel is named, and cached, after the hash of the fused graph.
+    // The in-memory executors are keyed by sizes, which only count the
+    // inputs and outputs, so those of the previous graph are dropped.
+    void setGraph(const fftx_dag::graph& g) {
+        dag = g;
+        fused = fftx_dag::fusionEnabled() ? dag.fuse() : fftx_dag::fusionReport();
+        name = "dag_" + dag.hashString();
+        sizes = std::vector<int>{dag.inputs(), dag.outputs()};
+        executors.clear();
+        #if !defined (FFTX_CUDA) && !defined (FFTX_HIP)
+        locals.clear();
+        #endif
+    }
+    const fftx_dag::graph& graph() const { return dag; }
+    const fftx_dag::fusionReport& fusion() const { return fused; }
+
+    void randomProblemInstance() {
+    }
+    void semantics() {
+        std::cout << "name := \""<< name << "_spiral" << "\";" << std::endl;
+        std::cout << dag.script() << std::endl;
+    }
+#if !defined (FFTX_CUDA) && !defined (FFTX_HIP)
+    bool nativeTransform();
+#endif
+
+protected:
+    fftx_dag::graph dag;
+    fftx_dag::fusionReport fused;
+#if !defined (FFTX_CUDA) && !defined (FFTX_HIP)
+    std::vector<std::vector<double>> locals;   // storage of the LOCAL variables, by id
+    std::vector<double> spectrum;              // intermediate of the FUSED nodes
+    double * address(int id);
+    bool runNode(const fftx_dag::node& nd, double * dst, double * src);
+    bool runFused(const fftx_dag::node& nd, double * dst, double * src);
+    bool runBox(const fftx_dag::node& nd, double * dst, double * src);
+    bool prunable(const fftx_dag::node& box, const fftx_dag::node& nd, int padded);
+    void copyBox(double * big, const double * small, const fftx_dag::node& nd,
+                 const fftx_dag::variable& vbig, const fftx_dag::variable& vsmall, bool embed);
+#endif
+};
+
+#if !defined (FFTX_CUDA) && !defined (FFTX_HIP)
+
+inline double * DAGProblem::address(int id) {
+    const fftx_dag::variable& v = dag.at(id);
+    switch(v.bind) {
+    case fftx_dag::INPUT:
+        return (v.index < 0) ? (double*)args.at(1) : ((double**)args.at(1))[v.index];
+    case fftx_dag::OUTPUT:
+        return (v.index < 0) ? (double*)args.at(0) : ((double**)args.at(0))[v.index];
+    case fftx_dag::COMPONENT:
+        return address(v.parent) + v.index * v.doubles();
+    default:
+        return locals.at(id - 1).data();
+    }
+}
+
+// Copy the box of vsmall at nd.lo between big and small, into big if embed.
+inline void DAGProblem::copyBox(double * big, const double * small, const fftx_dag::node& nd,
+                                const fftx_dag::variable& vbig, const fftx_dag::variable& vsmall,
+                                bool embed) {
+    int dim = vbig.extents.size();
+    int elem = (vbig.type == fftx_dag::COMPLEX) ? 2 : 1;
+    size_t line = (size_t)elem * vsmall.extents.back();
+    std::vector<size_t> stride(dim, elem);
+    for(int d = dim - 2; d >= 0; d--)
+        stride[d] = stride[d+1] * vbig.extents[d+1];
+    size_t lines = vsmall.elements() / vsmall.extents.back();
+    std::vector<int> idx(dim, 0);
+    for(size_t l = 0; l < lines; l++) {
+        size_t pos = 0;
+        for(int d = 0; d < dim; d++)
+            pos += (idx[d] + nd.lo[d]) * stride[d];
+        if(embed)
+            std::copy(small + l*line, small + (l+1)*line, big + pos);
+        else
+            std::copy(big + pos, big + pos + line, (double*)small + l*line);
+        for(int d = dim - 2; d >= 0; d--) {
+            if(++idx[d] < vsmall.extents[d])
+                break;
+            idx[d] = 0;
+        }
+    }
+}
+
+inline bool DAGProblem::runNode(const fftx_dag::node& nd, double * dst, double * src) {
+    typedef std::complex<double> cplx;
+    const double * sym = (const double*)args.at(2);
+    int dim = nd.n.size();
+    int batch = std::max(nd.batch, 1);
+    size_t npts = fftx_dag::product(nd.n);
+    size_t nspec = nd.n.empty() ? 0 : fftx_dag::product(fftx_dag::halfExtents(nd.n));
+    switch(nd.op) {
+    case fftx_dag::DFT:
+        for(int b = 0; b < batch; b++)
+            fftx_native::mddft(dim, nd.n.data(), (cplx*)dst + b*npts, (cplx*)src + b*npts, nd.sign);
+        break;
+    case fftx_dag::PRDFT:
+        for(int b = 0; b < batch; b++)
+            fftx_native::mdprdft(dim, nd.n.data(), dim - 1, (cplx*)dst + b*nspec, src + b*npts);
+        break;
+    case fftx_dag::IPRDFT:
+        for(int b = 0; b < batch; b++)
+            fftx_native::imdprdft(dim, nd.n.data(), dim - 1, dst + b*npts, (cplx*)src + b*nspec);
+        break;
+    case fftx_dag::DIAGONAL:
+        fftx_native::parallelFor(nd.length, 4, [&](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++) {
+                double s = sym[nd.offset + i];
+                dst[2*i] = src[2*i] * s;
+                dst[2*i+1] = src[2*i+1] * s;
+            }
+        });
+        break;
+    case fftx_dag::RC_DIAGONAL: {
+        const cplx * s = (const cplx*)(sym + nd.offset);
+        fftx_native::parallelFor(nd.length/2, 8, [&](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++)
+                ((cplx*)dst)[i] = ((cplx*)src)[i] * s[i];
+        });
+        break;
+    }
+    case fftx_dag::FUSED:
+        return runFused(nd, dst, src);
+    case fftx_dag::ZERO_EMBED:
+        std::fill(dst, dst + dag.at(nd.dst).doubles(), 0.);
+        copyBox(dst, src, nd, dag.at(nd.dst), dag.at(nd.src), true);
+        break;
+    case fftx_dag::EXTRACT:
+        copyBox(src, dst, nd, dag.at(nd.src), dag.at(nd.dst), false);
+        break;
+    case fftx_dag::COPY:
+        std::copy(src, src + dag.at(nd.src).doubles(), dst);
+        break;
+    case fftx_dag::RESAMPLE: {
+        const fftx_dag::variable& vdst = dag.at(nd.dst);
+        const fftx_dag::variable& vsrc = dag.at(nd.src);
+        if(vdst.type != fftx_dag::REAL || vsrc.type != fftx_dag::REAL)
+            return false;
+        fftx_native::mdresample(vsrc.extents.size(), vsrc.extents.data(), vdst.extents.data(),
+                                nd.shift.data(), dst, src);
+        break;
+    }
+    default:
+        return false;
+    }
+    return true;
+}
+
+// A box at the origin of the array of a single transform of the chain nd.
+inline bool DAGProblem::prunable(const fftx_dag::node& box, const fftx_dag::node& nd, int padded) {
+    return nd.batch <= 1 && dag.at(padded).extents == nd.n &&
+        std::count(box.lo.begin(), box.lo.end(), 0) == (int)box.lo.size();
+}
+
+// PRDFT, pointwise, IPRDFT through one spectrum buffer.  A zero embedding
+// before, or an extraction after, at the origin runs the pruned transforms
+// and never forms the padded array; elsewhere it goes through one.
+inline bool DAGProblem::runFused(const fftx_dag::node& nd, double * dst, double * src) {
+    typedef std::complex<double> cplx;
+    if(nd.parts.size() == 2)
+        return runBox(nd, dst, src);
+    const fftx_dag::node& first = nd.parts.front();
+    const fftx_dag::node& last = nd.parts.back();
+    bool embed = (first.op == fftx_dag::ZERO_EMBED);
+    bool extract = (last.op == fftx_dag::EXTRACT);
+    const fftx_dag::node& fwd = nd.parts.at(embed ? 1 : 0);
+    const fftx_dag::node& diag = nd.parts.at(embed ? 2 : 1);
+    const fftx_dag::node& inv = nd.parts.at(embed ? 3 : 2);
+    int dim = nd.n.size();
+    spectrum.resize(2 * std::max(nd.batch, 1) * fftx_dag::product(fftx_dag::halfExtents(nd.n)));
+    std::vector<double> padded;
+    if(embed && prunable(first, nd, first.dst)) {
+        fftx_native::mdprdftEmbedded(dim, nd.n.data(), dim - 1, (cplx*)spectrum.data(), src,
+                                     dag.at(first.src).extents.data());
+    } else {
+        if(embed) {
+            padded.resize(dag.at(first.dst).doubles());
+            runNode(first, padded.data(), src);
+            src = padded.data();
+        }
+        runNode(fwd, spectrum.data(), src);
+    }
+    if(!runNode(diag, spectrum.data(), spectrum.data()))
+        return false;
+    if(extract && prunable(last, nd, last.src)) {
+        fftx_native::imdprdftExtracted(dim, nd.n.data(), dim - 1, dst, (cplx*)spectrum.data(),
+                                       dag.at(last.dst).extents.data());
+    } else if(extract) {
+        padded.resize(dag.at(last.src).doubles());
+        runNode(inv, padded.data(), spectrum.data());
+        runNode(last, dst, padded.data());
+    } else {
+        runNode(inv, dst, spectrum.data());
+    }
+    return true;
+}
+
+// A transform and the extraction of a box of its output (pruneTransforms):
+// only the box is computed and stored, for each field of the batch.  The
+// box may have a leading batch axis, whole; other shapes go through the
+// full output.
+inline bool DAGProblem::runBox(const fftx_dag::node& nd, double * dst, double * src) {
+    typedef std::complex<double> cplx;
+    const fftx_dag::node& t = nd.parts.front();
+    const fftx_dag::node& box = nd.parts.back();
+    const fftx_dag::variable& full = dag.at(box.src);
+    int dim = t.n.size();
+    int batch = std::max(t.batch, 1);
+    std::vector<int> lo = box.lo, m = dag.at(box.dst).extents;
+    std::vector<int> ext = (t.op == fftx_dag::PRDFT) ? fftx_dag::halfExtents(t.n) : t.n;
+    if((int)lo.size() == dim + 1) {
+        ext.insert(ext.begin(), batch);
+        if(lo[0] == 0 && m[0] == batch) {
+            lo.erase(lo.begin());
+            m.erase(m.begin());
+        }
+    }
+    if(full.extents != ext || (int)lo.size() != dim) {
+        std::vector<double> temp(full.doubles());
+        return runNode(t, temp.data(), src) && runNode(box, dst, temp.data());
+    }
+    size_t inDoubles = dag.at(t.src).doubles() / batch;
+    size_t outDoubles = dag.at(box.dst).doubles() / batch;
+    for(int b = 0; b < batch; b++) {
+        double * in = src + b*inDoubles;
+        double * out = dst + b*outDoubles;
+        switch(t.op) {
+        case fftx_dag::DFT:
+            fftx_native::mddftBox(dim, t.n.data(), (cplx*)out, (cplx*)in, lo.data(), m.data(), t.sign);
+            break;
+        case fftx_dag::PRDFT:
+            fftx_native::mdprdftBox(dim, t.n.data(), dim - 1, (cplx*)out, in, lo.data(), m.data());
+            break;
+        default:
+            fftx_native::imdprdftExtracted(dim, t.n.data(), dim - 1, out, (cplx*)in, m.data(), lo.data());
+        }
+    }
+    return true;
+}
+
+inline bool DAGProblem::nativeTransform() {
+    for(const fftx_dag::node& nd : dag.nodes())
+        if(nd.op == fftx_dag::RAW)
+            return false;
+    locals.resize(dag.variables().size());
+    for(const fftx_dag::variable& v : dag.variables())
+        if(v.bind == fftx_dag::LOCAL && v.live)
+            locals[v.id - 1].resize(v.doubles());
+    for(const fftx_dag::node& nd : dag.nodes())
+        if(!runNode(nd, address(nd.dst), address(nd.src)))
+            return false;
+    return true;
+}
+
+#endif
+
+#endif
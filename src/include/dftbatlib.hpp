@@ -5,7 +5,7 @@ static constexpr auto dftbat_script{
 R"(
     ns := szns;
     name := transform_spiral;
-    tags := [[APar, APar], [APar, AVec], [AVec, APar]];
+    tags := [[APar, APar], [APar, AVec], [AVec, APar], [AVec, AVec]];
 
     t := let(
         name := name,
@@ -32,4 +32,15 @@ public:
             std::cout << "prefix := \"fftx_idftbat_\";" << std::endl;
         std::cout << dftbat_script << std::endl;
     }
+#if !defined (FFTX_CUDA) && !defined (FFTX_HIP)
+    bool nativeTransform() {
+        // [write, read] layouts for each stridetype, as in tags of dftbat_script
+        static const int tags[4][2] = {{0, 0}, {0, 1}, {1, 0}, {1, 1}};
+        const int * tag = tags[sizes.at(2) - 1];
+        fftx_native::batchdft(sizes.at(0), sizes.at(1), tag[1], tag[0],
+                              (std::complex<double>*)args.at(0),
+                              (std::complex<double>*)args.at(1), sizes.at(3));
+        return true;
+    }
+#endif
 };
@@ -22,6 +22,7 @@
 #include <chrono>
 
 #include <map>
+#include <mutex>
 #include <string>
 
 #include <array>
@@ -29,6 +30,9 @@
 #include <cassert>
 #include <complex>
 #include <iomanip>
+#include <cstdint>
+
+#include "fftxdag.hpp"
 /*! \mainpage FFTX Package
  *
  * \section intro_sec Introduction
@@ -43,24 +47,141 @@
  */
 
 // Set this to 1 for row-major order, 0 for column-major order.
+// This is the default layout; the MDDFT and MDPRDFT problems also take a
+// layout_t at run time.
+#ifndef FFTX_ROW_MAJOR_ORDER
 #define FFTX_ROW_MAJOR_ORDER 1
+#endif
 
 // Set this to 1 if truncating complex array in last dimension, 0 if in first.
+#ifndef FFTX_COMPLEX_TRUNC_LAST
 #define FFTX_COMPLEX_TRUNC_LAST 1
+#endif
 
 namespace fftx
 {
 
+  /** order of the components of a multi-component field (the fields of a batch): SOA, each
+      component packed after the other (APar), or AOS, the components of each point together
+      (AVec, interleaved). */
+  enum componentOrder { SOA = 0, AOS = 1 };
+
+  /** storage of complex values: INTERLEAVED, std::complex pairs, or SPLIT, the real and the
+      imaginary parts in two separate arrays of doubles (planar). */
+  enum complexFormat { INTERLEAVED = 0, SPLIT = 1 };
+
+  /** layout of the arrays of a transform: the order of the axes in memory, the axis along
+      which a real-to-complex half spectrum has n/2+1 points, the order of the components
+      and the complex format of the output and input.  Axes are numbered as in the problem
+      sizes; the default is the compile-time layout above, with components SOA and complex
+      values INTERLEAVED. */
+  struct layout_t
+  {
+    bool rowMajor;   // last axis fastest (C order); false for first axis fastest (Fortran order)
+    bool truncLast;  // half spectrum along the last axis, else along the first
+    componentOrder outComponents;
+    componentOrder inComponents;
+    complexFormat outComplex;
+    complexFormat inComplex;
+
+    layout_t(bool a_rowMajor = FFTX_ROW_MAJOR_ORDER, bool a_truncLast = FFTX_COMPLEX_TRUNC_LAST,
+             componentOrder a_outComponents = SOA, componentOrder a_inComponents = SOA,
+             complexFormat a_outComplex = INTERLEAVED, complexFormat a_inComplex = INTERLEAVED)
+      : rowMajor(a_rowMajor), truncLast(a_truncLast),
+        outComponents(a_outComponents), inComponents(a_inComponents),
+        outComplex(a_outComplex), inComplex(a_inComplex) { }
+
+    bool operator==(const layout_t& a_rhs) const
+    {
+      return rowMajor == a_rhs.rowMajor && truncLast == a_rhs.truncLast &&
+        outComponents == a_rhs.outComponents && inComponents == a_rhs.inComponents &&
+        outComplex == a_rhs.outComplex && inComplex == a_rhs.inComplex;
+    }
+    bool operator!=(const layout_t& a_rhs) const { return !(*this == a_rhs); }
+
+    /** true if the components of the output or input are interleaved */
+    bool interleaved() const { return outComponents == AOS || inComponents == AOS; }
+
+    /** true if the output or input is split complex */
+    bool split() const { return outComplex == SPLIT || inComplex == SPLIT; }
+
+    /** extents a_n in memory order, slowest varying first */
+    std::vector<int> physical(const std::vector<int>& a_n) const
+    {
+      return rowMajor ? a_n : std::vector<int>(a_n.rbegin(), a_n.rend());
+    }
+
+    /** truncated axis of an array of a_dim axes, in memory order */
+    int physicalTruncAxis(int a_dim) const
+    {
+      int axis = truncLast ? a_dim-1 : 0;
+      return rowMajor ? axis : a_dim-1 - axis;
+    }
+  };
+
+  /**
+   Tracing state of the calling thread.  The tracing functions below record the variables and
+   nodes of the traced program in a graph (fftxdag.hpp), which closeDAG()/closeScalarDAG()
+   serialize to the SPIRAL script.  Each thread traces on its own, and a trace starts afresh,
+   with variables numbered from 1, each time tracing is turned on.
+  */
+  struct traceContext
+  {
+    bool active = false;
+    fftx_dag::graph dag;
+    std::string inputType = "double";
+    std::string outputType = "double";
+    fftx_dag::fusionReport fusion;   // of the last plan closed
+  };
+
+  inline traceContext& currentTrace()
+  {
+    static thread_local traceContext context;
+    return context;
+  }
+
+  /**
+   Assignable flag for the tracing state of the calling thread.  The state is in
+   currentTrace(), so the flag holds none and one constant object serves every
+   translation unit.
+  */
+  struct traceFlag
+  {
+    operator bool() const { return currentTrace().active; }
+    const traceFlag& operator=(bool a_on) const
+    {
+      traceContext& context = currentTrace();
+      if (a_on && !context.active) context = traceContext();
+      context.active = a_on;
+      return *this;
+    }
+  };
+
+  /** Number of the next traced variable. */
+  struct traceCounter
+  {
+    operator uint64_t() const { return currentTrace().dag.variables().size() + 1; }
+  };
+
   /**
    Is this a FFTX codegen program, or is this application code using a generated transform.
   */
-  static bool tracing = false; // when creating a trace program user sets this to 'true'
+  constexpr traceFlag tracing{}; // when creating a trace program user sets this to 'true'
 
   /**
     counter for genereated variable names duringn FFTX codegen tracing.  Not meant for FFTX users but can be
     used when debugging codegen itself
   */
-  static uint64_t ID=1; // variable naming counter
+  constexpr traceCounter ID{}; // variable naming counter
+
+  /** SPIRAL script of the program traced so far on this thread. */
+  inline std::string traceScript() { return currentTrace().dag.script(); }
+
+  /** Structural hash of the program traced so far on this thread, a key for generated kernels. */
+  inline uint64_t traceHash() { return currentTrace().dag.hash(); }
+
+  /** Chains and boxes fused, and intermediate storage saved, in the last plan closed on this thread. */
+  inline fftx_dag::fusionReport traceFusion() { return currentTrace().fusion; }
   
   typedef int intrank_t; // just useful for self-documenting code.
 
@@ -156,8 +277,19 @@ namespace fftx
     }
   };
 
+  /** coordinates of a point as a list, for the traced graph */
+  template<int DIM>
+  inline std::vector<int> traceExtents(const point_t<DIM>& a_pt)
+  {
+    return std::vector<int>(a_pt.x, a_pt.x + DIM);
+  }
+
   /** non-owning view into a contiugous array of data.   This is a class that is foeshadowing a C++ class mdspan,
       a multi-dimensional extention to std::span
+
+      a view may also be strided (subArray(), or the constructor with strides), such as the interior
+      of a field with ghost cells; the transformer classes and the MDDFT and MDPRDFT problems
+      (FFTXProblem::setStrides) transform such views in place, forall() takes packed arrays only.
       
       if fftx::tracing == true, then array_t::array_t(const box_t<DIM>& ) construction is 
       a symbolic placeholder in a computational DAG that is translated into the code generator.
@@ -173,13 +305,16 @@ namespace fftx
     /** string constructor from an aliased global_ptr object.  This constructor is an error when fftx::tracing==true*/
     array_t(global_ptr<T>&& p, const box_t<DIM>& a_box)
       :m_data(p), m_domain(a_box) {;}
+    /** strided view of a_box in a larger allocation at p, a_strides[d] elements apart along
+        axis d, e.g. the interior of a field with ghost cells.  Does not own the data. */
+    array_t(global_ptr<T>&& p, const box_t<DIM>& a_box, const std::array<size_t, DIM>& a_strides)
+      :m_data(p), m_domain(a_box), m_strides(a_strides) {;}
     array_t(const box_t<DIM>& m_box):m_domain(m_box)
     {
       if(tracing)
         {
-          m_data = global_ptr<T>((T*)ID);
-          std::cout<<"var_"<<ID<<":= var(\"var_"<<ID<<"\", BoxND("<<m_box.extents()<<", TReal));\n";
-          ID++;
+          fftx_dag::var v = currentTrace().dag.local(traceExtents(m_box.extents()));
+          m_data = global_ptr<T>((T*)(uintptr_t)v.id);
         }
       else
         {
@@ -202,15 +337,60 @@ namespace fftx
       swap(first.m_local_data, second.m_local_data);
       swap(first.m_data, second.m_data);
       swap(first.m_domain, second.m_domain);
+      swap(first.m_strides, second.m_strides);
     }
 
     T* m_local_data = nullptr;
     global_ptr<T> m_data;
     box_t<DIM>    m_domain;
+    std::array<size_t, DIM> m_strides{};  // all 0 for data packed in m_domain
+    /** view of the points of subbox, which must be inside m_domain, without copying */
     array_t<DIM, T> subArray(box_t<DIM>&& subbox);
+    /** element strides along each axis; those of positionInBox() unless a strided view */
+    std::array<size_t, DIM> strides() const;
+    /** true if the data are packed in m_domain, in the order of positionInBox() */
+    bool contiguous() const { return strides() == packedStrides(m_domain); }
+    /** offset of a_pt from m_data, in elements */
+    size_t offset(const point_t<DIM>& a_pt) const;
+    /** strides of data packed in a_bx, in the order of positionInBox() */
+    static std::array<size_t, DIM> packedStrides(const box_t<DIM>& a_bx);
     uint64_t id() const { assert(tracing); return (uint64_t)m_data.local();}
   };
 
+  /** graph variable of a traced array */
+  template<int DIM, typename T>
+  inline fftx_dag::var traceVar(const array_t<DIM, T>& a_array)
+  {
+    fftx_dag::var v;
+    v.id = (int)a_array.id();
+    return v;
+  }
+
+  /** record a node of the traced program, returned for its parameters to be set */
+  template<int DIM1, typename T1, int DIM2, typename T2>
+  inline fftx_dag::node& traceNode(fftx_dag::opKind a_op,
+                                   const array_t<DIM1, T1>& destination,
+                                   const array_t<DIM2, T2>& source)
+  {
+    fftx_dag::node nd;
+    nd.op = a_op;
+    nd.dst = (int)destination.id();
+    nd.src = (int)source.id();
+    currentTrace().dag.addNode(nd);
+    return const_cast<fftx_dag::node&>(currentTrace().dag.nodes().back());
+  }
+
+  template<int DIM, int DIM1, typename T1, int DIM2, typename T2>
+  inline void traceTransform(fftx_dag::opKind a_op, const point_t<DIM>& extents, int batch, int sign,
+                             const array_t<DIM1, T1>& destination,
+                             const array_t<DIM2, T2>& source)
+  {
+    fftx_dag::node& nd = traceNode(a_op, destination, source);
+    nd.n = traceExtents(extents);
+    nd.batch = batch;
+    nd.sign = sign;
+  }
+
   
   /**
    * \defGroup FFA  global free functions in fftx namespace used in application programs
@@ -245,19 +425,22 @@ namespace fftx
   {
     box_t<DIM-1> b = array.m_domain.projectC();
     array_t<DIM-1, T> rtn(b);
-    std::cout<<"var_"<<(uint64_t)rtn.m_data.local()<<":=nth(var_"<<(uint64_t)array.m_data.local()<<","<<index<<");\n";
+    currentTrace().dag.bind(traceVar(rtn), fftx_dag::COMPONENT, index, traceVar(array));
     return rtn;
   }
 
   template<int DIM, typename T>
   void copy(array_t<DIM, T>& dest, const array_t<DIM, T>& src)
   {
-    std::cout<<"    TDAGNode(TGath(fBox("<<src.m_domain.extents()<<")),var_"<<dest.id()<<", var_"<<src.id()<<"),\n";
+    traceNode(fftx_dag::COPY, dest, src);
   }
 
   inline void rawScript(const std::string& a_rawScript)
   {
-    std::cout<<"\n"<<a_rawScript<<"\n";
+    fftx_dag::node nd;
+    nd.op = fftx_dag::RAW;
+    nd.text = "\n" + a_rawScript;
+    currentTrace().dag.addNode(nd);
   }
 
   template <typename T>
@@ -303,7 +486,7 @@ namespace fftx
              array_t<DIM, std::complex<double>>& destination,
              array_t<DIM, std::complex<double>>& source)
   {
-    std::cout<<"   TDAGNode(TTensorI(MDDFT("<<extents<<",-1),"<<batch<<",APar, APar), var_"<<destination.id()<<",var_"<<source.id()<<"),\n";
+    traceTransform(fftx_dag::DFT, extents, batch, -1, destination, source);
   }
   
   template<int DIM>
@@ -311,7 +494,7 @@ namespace fftx
              array_t<DIM, std::complex<double>>& destination,
              array_t<DIM, std::complex<double>>& source)
   {
-    std::cout<<"   TDAGNode(TTensorI(MDDFT("<<extents<<",1),"<<batch<<",APar, APar), var_"<<destination.id()<<",var_"<<source.id()<<"),\n";
+    traceTransform(fftx_dag::DFT, extents, batch, 1, destination, source);
   }
     
   template<int DIM>
@@ -319,7 +502,7 @@ namespace fftx
                array_t<DIM+1, double>& destination,
                array_t<DIM+1, double>& source)
   {
-    std::cout<<"    TDAGNode(TTensorI(MDPRDFT("<<extent<<",-1),"<<batch<<",APar,APar), var_"<<destination.id()<<",var_"<<source.id()<<"),\n";
+    traceTransform(fftx_dag::PRDFT, extent, batch, -1, destination, source);
   }
 
   template<int DIM>
@@ -327,7 +510,7 @@ namespace fftx
                array_t<DIM+1, double>& destination,
                array_t<DIM+1, double>& source)
   {
-    std::cout<<"    TDAGNode(TTensorI(IMDPRDFT("<<extent<<",1),"<<batch<<",APar,APar), var_"<<destination.id()<<",var_"<<source.id()<<"),\n";
+    traceTransform(fftx_dag::IPRDFT, extent, batch, 1, destination, source);
   }
 
   template<int DIM>
@@ -335,7 +518,7 @@ namespace fftx
              array_t<DIM, std::complex<double>>& destination,
              array_t<DIM, double>& source)
   {
-    std::cout<<"    TDAGNode(MDPRDFT("<<extent<<",-1), var_"<<destination.id()<<",var_"<<source.id()<<"),\n"; // FIXME: was 1, not -1.
+    traceTransform(fftx_dag::PRDFT, extent, 0, -1, destination, source); // FIXME: was 1, not -1.
   }
 
   template<int DIM>
@@ -343,7 +526,7 @@ namespace fftx
               array_t<DIM, double>& destination,
               array_t<DIM, std::complex<double>>& source)
   {
-    std::cout<<"    TDAGNode(IMDPRDFT("<<extent<<",1), var_"<<destination.id()<<",var_"<<source.id()<<"),\n"; // FIXME: was -1, not 1.
+    traceTransform(fftx_dag::IPRDFT, extent, 0, 1, destination, source); // FIXME: was -1, not 1.
   }
 
   template<int DIM>
@@ -351,7 +534,8 @@ namespace fftx
               array_t<DIM, std::complex<double>>& destination,
               const array_t<DIM, std::complex<double>>& source)
   {
-    std::cout<<"    TDAGNode(Diag(diagTensor(FDataOfs(symvar,"<<symbol.m_domain.size()<<",0),fConst(TReal, 2, 1))), var_"<<destination.id()<<",var_"<<source.id()<<"),\n";
+    fftx_dag::node& nd = traceNode(fftx_dag::DIAGONAL, destination, source);
+    nd.length = symbol.m_domain.size();
   }
 
   template<int DIM>
@@ -359,79 +543,65 @@ namespace fftx
               array_t<DIM, std::complex<double>>& destination,
               const array_t<DIM, std::complex<double>>& source)
   {
-    std::cout<<"    TDAGNode(RCDiag(FDataOfs(symvar,"<<2*symbol.m_domain.size()<<",0)), var_"<<destination.id()<<",var_"<<source.id()<<"),\n";
+    fftx_dag::node& nd = traceNode(fftx_dag::RC_DIAGONAL, destination, source);
+    nd.length = 2*symbol.m_domain.size();
   }
 
   inline void include(const char* includeFile)
   {
-    std::cout<<"opts.includes:=opts.includes::["<<includeFile<<"];\n";
+    currentTrace().dag.addScript(std::string("opts.includes:=opts.includes::[")+includeFile+"];");
   }
 
   template<int DIM, typename T>
   void zeroEmbedBox(array_t<DIM, T>& destination, const array_t<DIM, T>& source)
   {
-    std::cout<<"    TDAGNode(ZeroEmbedBox("<<destination.m_domain.extents()<<",[";
-    for(int i=0; i<DIM; i++)
-      {
-        std::cout<<"["<<source.m_domain.lo[i]<<".."<<source.m_domain.hi[i]<<"]";
-        if(i<DIM-1) std::cout<<",";
-      }
-    std::cout<<"]), var_"<<destination.id()<<",var_"<<source.id()<<"),\n";
+    fftx_dag::node& nd = traceNode(fftx_dag::ZERO_EMBED, destination, source);
+    nd.lo = traceExtents(source.m_domain.lo);
   }
 
   template<int DIM, typename T>
   void extractBox(array_t<DIM, T>& destination, const array_t<DIM, T>& source)
   {
-    std::cout<<"    TDAGNode(ExtractBox("<<source.m_domain.extents()<<",[";
-    for(int i=0; i<DIM; i++)
-      {
-        std::cout<<"["<<destination.m_domain.lo[i]<<".."<<destination.m_domain.hi[i]<<"]";
-        if(i<DIM-1) std::cout<<",";
-      }
-    std::cout<<"]), var_"<<destination.id()<<",var_"<<source.id()<<"),\n";
+    fftx_dag::node& nd = traceNode(fftx_dag::EXTRACT, destination, source);
+    nd.lo = traceExtents(destination.m_domain.lo);
   }
   
-  static std::string inputType = "double";
-  static int inputCount = 1;
-  static std::string outputType = "double";
-  static int outputCount = 1;
-
   template<int DIM, typename T, std::size_t COUNT>
   void setInputs(const std::array<array_t<DIM, T>, COUNT>& a_inputs)
   {
-    inputType = TypeName<T>::Get();
+    currentTrace().inputType = TypeName<T>::Get();
     for(int i=0; i<COUNT; i++)
       {
-        std::cout<<"var_"<<a_inputs[i].id()<<":= nth(X,"<<i<<");\n";
+        currentTrace().dag.bind(traceVar(a_inputs[i]), fftx_dag::INPUT, i);
       }
   }
   template<int DIM, typename T>
   void setInputs(const array_t<DIM, T>& a_inputs)
   {
-    inputType = TypeName<T>::Get();
-    std::cout<<"var_"<<a_inputs.id()<<":= X;\n";
+    currentTrace().inputType = TypeName<T>::Get();
+    currentTrace().dag.bind(traceVar(a_inputs), fftx_dag::INPUT, -1);
   }
   
   template<int DIM, typename T, std::size_t COUNT>
   void setOutputs(const std::array<array_t<DIM, T>, COUNT>& a_outputs)
   {
-    outputType = TypeName<T>::Get();
+    currentTrace().outputType = TypeName<T>::Get();
     for(int i=0; i<COUNT; i++)
       {
-        std::cout<<"var_"<<a_outputs[i].id()<<":= nth(Y,"<<i<<");\n";
+        currentTrace().dag.bind(traceVar(a_outputs[i]), fftx_dag::OUTPUT, i);
       }
   }
   template<int DIM, typename T>
   void setOutputs(const array_t<DIM, T>& a_outputs)
   {
-    outputType = TypeName<T>::Get();
-    std::cout<<"var_"<<a_outputs.id()<<":= Y;\n";
+    currentTrace().outputType = TypeName<T>::Get();
+    currentTrace().dag.bind(traceVar(a_outputs), fftx_dag::OUTPUT, -1);
   }
 
   template<int DIM, typename T, std::size_t COUNT>
   void setSymbol(const  std::array<array_t<DIM, T>, COUNT>& a_symbol)
   {
-    std::cout<<"symvar := var(\"sym\", TPtr(TPtr(TReal)));\n";
+    currentTrace().dag.setSymbolArrays(true);
   }
   
   template<int DIM, typename T>
@@ -439,28 +609,40 @@ namespace fftx
                 array_t<DIM,T>& destination,
                 const array_t<DIM,T>& source)
   {
-    std::cout<<"    TDAGNode(TResample("
-             <<destination.m_domain.extents()<<","
-             <<source.m_domain.extents()<<","<<shift<<"),"
-             <<"var_"<<destination.id()<<","
-             <<"var_"<<source.id()<<"),\n";
+    fftx_dag::node& nd = traceNode(fftx_dag::RESAMPLE, destination, source);
+    nd.shift.assign(shift.begin(), shift.end());
   }
+  /** Start the DAG of a plan with arrays of input, output and symbol pointers. */
   inline void openDAG()
   {
-  //  std::cout<<"conf := FFTXGlobals.defaultWarpXConf();\n";
-  //  std::cout<<"opts := FFTXGlobals.getOpts(conf);\n";                                     
-  //  std::cout<<"symvar := var(\"sym\", TPtr(TPtr(TReal)));\n";
-    std::cout<<"transform:= TFCall(TDecl(TDAG([\n";
+    currentTrace().dag.setPointerArgs(true);
   }
 
+  /** Start the DAG of a plan with one input, output and symbol buffer. */
   inline void openScalarDAG()
   {
-    std::cout<<"symvar := var(\"sym\", TPtr(TReal));\n";
-    std::cout<<"transform:= TFCall(TDecl(TDAG([\n";
+    currentTrace().dag.setSymbolArrays(false);
+    currentTrace().dag.setPointerArgs(false);
   }
   
  
  
+  /** write the script of the traced program, with the TDecl of a_locals, for the plan a_name */
+  inline void printTrace(const std::vector<fftx_dag::var>& a_locals, const char* a_name)
+  {
+    fftx_dag::graph& dag = currentTrace().dag;
+    dag.setLocals(a_locals);
+    dag.setFunctionName(std::string(a_name)+"_spiral");
+    fftx_dag::fusionReport& fusion = currentTrace().fusion;
+    fusion = fftx_dag::fusionEnabled() ? dag.fuse() : fftx_dag::fusionReport();
+    if(fusion.chains > 0 || fusion.prunedBoxes > 0)
+      std::cout<<"# fused "<<fusion.chains<<" convolution chain(s) and "
+               <<fusion.prunedBoxes<<" box(es), "
+               <<8*fusion.doublesSaved<<" bytes of intermediates removed\n";
+    std::cout<<dag.script();
+    std::cout<<"prefix:=\""<<a_name<<"\";\n";
+  }
+
   template<typename T, int DIM, unsigned long COUNT>
   void closeDAG(std::array<array_t<DIM,T>, COUNT>& localVars, const char* name)
   {
@@ -530,32 +712,23 @@ namespace fftx
    //DataTypeT<DEST> d;
    std::string header_text(header_template);
    header_text = std::regex_replace(header_text, std::regex("PLAN"),std::string(name));
-   header_text = std::regex_replace(header_text, std::regex("S_TYPE"), inputType);
-   header_text = std::regex_replace(header_text, std::regex("D_TYPE"), outputType);
+   header_text = std::regex_replace(header_text, std::regex("S_TYPE"), currentTrace().inputType);
+   header_text = std::regex_replace(header_text, std::regex("D_TYPE"), currentTrace().outputType);
    header_text = std::regex_replace(header_text, std::regex("DD"), std::to_string(DIM-1));
    
    headerFile<<header_text<<"\n";
    headerFile.close();
-   
-   std::cout<<"\n]),\n   [";
-   if(COUNT==0)
-     {}
-   else
-     {
-      std::cout<<"var_"<<(uint64_t)localVars[0].m_data.local();
-      for(int i=1; i<COUNT; i++) std::cout<<", var_"<<(uint64_t)localVars[i].m_data.local();
-     }
-     std::cout<<"]\n),\n";
-     std::cout<<"rec(XType:= TPtr(TPtr(TReal)), YType:=TPtr(TPtr(TReal)), fname:=\""<<name<<"_spiral\", params:= [symvar])\n"
-              <<");\n";
-     std::cout<<"prefix:=\""<<name<<"\";\n";
+
+   std::vector<fftx_dag::var> locals;
+   for(int i=0; i<COUNT; i++) locals.push_back(traceVar(localVars[i]));
+   printTrace(locals, name);
   }
 
   template<typename T, int DIM, unsigned long COUNT>
   std::string varNames(const std::array<array_t<DIM,T>, COUNT>& a_vars)
   {
    std::string rtn;
-   for(int i=0; i<COUNT; i++)
+   for(size_t i=0; i<COUNT; i++)
       {
         rtn +="var_";
         rtn += std::to_string((uint64_t)a_vars[i].m_data.local());
@@ -664,8 +837,8 @@ template<int DIM>
    //DataTypeT<DEST> d;
    std::string header_text(header_template);
    header_text = std::regex_replace(header_text,std::regex("PLAN"),std::string(name));
-   header_text = std::regex_replace(header_text, std::regex("S_TYPE"), inputType);
-   header_text = std::regex_replace(header_text, std::regex("D_TYPE"), outputType);
+   header_text = std::regex_replace(header_text, std::regex("S_TYPE"), currentTrace().inputType);
+   header_text = std::regex_replace(header_text, std::regex("D_TYPE"), currentTrace().outputType);
    header_text = std::regex_replace(header_text, std::regex("DD"), std::to_string(DIM));
 #ifdef FFTX_HIP
    header_text = std::regex_replace(header_text,std::regex("cuda"),std::string("hip"));
@@ -675,18 +848,15 @@ template<int DIM>
    headerFile<<header_text<<"\n";
    headerFile.close();
 
-   std::cout<<"\n]),\n   [";
-    // if(COUNT==0){}
-    // else
-    //   {
-    //     std::cout<<"var_"<<(uint64_t)localVars[0].m_data.local();
-    //     for(int i=1; i<COUNT; i++) std::cout<<", var_"<<(uint64_t)localVars[i].m_data.local();
-    //   }
-   std::cout <<localVarNames;
-   std::cout<<"]\n),\n";
-   std::cout<<"rec(fname:=\""<<name<<"_spiral\", params:= [symvar])\n"
-            <<");\n";
-   std::cout<<"prefix:=\""<<name<<"\";\n";
+   std::vector<fftx_dag::var> locals;
+   std::smatch m;
+   for(std::string s = localVarNames; std::regex_search(s, m, std::regex("var_([0-9]+)")); s = m.suffix())
+     {
+       fftx_dag::var v;
+       v.id = std::stoi(m[1]);
+       locals.push_back(v);
+     }
+   printTrace(locals, name);
 } 
  
  
@@ -704,6 +874,40 @@ template<typename T, typename T2, int DIM, unsigned long COUNT, unsigned long CO
     closeScalarDAG<DIM>(varNames(a_vars)+','+varNames(a_vars2), name);
 
   }
+
+  /** trace the plan a_name of the complex DFT (sign a_sign) of extents a_n, with a_n.size() == DIM, on a_batch fields */
+  template<int DIM>
+  void traceMDDFTPlan(const std::vector<int>& a_n, int a_batch, int a_sign, const char* a_name)
+  {
+    tracing = true;
+    point_t<DIM> hi;
+    for(int d=0; d<DIM; d++) hi[d] = a_n[d];
+    box_t<DIM> empty(point_t<DIM>::Unit(), point_t<DIM>::Zero());
+    box_t<DIM> domain(point_t<DIM>::Unit(), point_t<DIM>(hi));
+
+    std::array<array_t<DIM,std::complex<double>>,1> intermediates {{empty}};
+    array_t<DIM,std::complex<double>> inputs(domain);
+    array_t<DIM,std::complex<double>> outputs(domain);
+    setInputs(inputs);
+    setOutputs(outputs);
+
+    openScalarDAG();
+    traceTransform(fftx_dag::DFT, domain.extents(), a_batch, a_sign, outputs, inputs);
+    closeScalarDAG(intermediates, a_name);
+  }
+
+  /** traceMDDFTPlan for the dimension of a_n, 1 to 4; false for others */
+  inline bool traceMDDFTPlan(const std::vector<int>& a_n, int a_batch, int a_sign, const char* a_name)
+  {
+    switch(a_n.size())
+      {
+      case 1: traceMDDFTPlan<1>(a_n, a_batch, a_sign, a_name); return true;
+      case 2: traceMDDFTPlan<2>(a_n, a_batch, a_sign, a_name); return true;
+      case 3: traceMDDFTPlan<3>(a_n, a_batch, a_sign, a_name); return true;
+      case 4: traceMDDFTPlan<4>(a_n, a_batch, a_sign, a_name); return true;
+      default: return false;
+      }
+  }
   
   template<int DIM>
   inline point_t<DIM> lengthsBox(const box_t<DIM>& a_bx)
@@ -869,6 +1073,110 @@ template<typename T, typename T2, int DIM, unsigned long COUNT, unsigned long CO
     return rtn;
   } 
   
+  template<int DIM, typename T>
+  inline std::array<size_t, DIM> array_t<DIM, T>::packedStrides(const box_t<DIM>& a_bx)
+  {
+    point_t<DIM> lengths = lengthsBox(a_bx);
+    std::array<size_t, DIM> rtn;
+#if FFTX_ROW_MAJOR_ORDER
+    size_t stride = 1;
+    for (int d = DIM-1; d >= 0; d--)
+      {
+        rtn[d] = stride;
+        stride *= lengths[d];
+      }
+#else
+    size_t stride = 1;
+    for (int d = 0; d < DIM; d++)
+      {
+        rtn[d] = stride;
+        stride *= lengths[d];
+      }
+#endif
+    return rtn;
+  }
+
+  template<int DIM, typename T>
+  inline std::array<size_t, DIM> array_t<DIM, T>::strides() const
+  {
+    for (int d = 0; d < DIM; d++)
+      {
+        if (m_strides[d] != 0) return m_strides;
+      }
+    return packedStrides(m_domain);
+  }
+
+  template<int DIM, typename T>
+  inline size_t array_t<DIM, T>::offset(const point_t<DIM>& a_pt) const
+  {
+    std::array<size_t, DIM> s = strides();
+    size_t rtn = 0;
+    for (int d = 0; d < DIM; d++)
+      {
+        rtn += (a_pt[d] - m_domain.lo[d]) * s[d];
+      }
+    return rtn;
+  }
+
+  template<int DIM, typename T>
+  inline array_t<DIM, T> array_t<DIM, T>::subArray(box_t<DIM>&& subbox)
+  {
+    assert(!tracing);
+    assert(isInBox(subbox.lo, m_domain) && isInBox(subbox.hi, m_domain));
+    return array_t<DIM, T>(global_ptr<T>(m_data.local() + offset(subbox.lo),
+                                         m_data.where(), m_data.device()),
+                           subbox, strides());
+  }
+
+  /** owning container of several components of type T over one box, in SOA or AOS order
+      (componentOrder).  data() is the argument of a batched transform of the components:
+      mdSizes(extents, components()) with order() in the layout_t of the plan. */
+  template<int DIM, typename T>
+  class field_t
+  {
+  public:
+    field_t(const box_t<DIM>& a_box, int a_components, componentOrder a_order = SOA)
+      : m_box(a_box), m_components(a_components), m_order(a_order),
+        m_data(a_box.size() * a_components) { }
+
+    T* data() { return m_data.data(); }
+    const T* data() const { return m_data.data(); }
+    const box_t<DIM>& box() const { return m_box; }
+    int components() const { return m_components; }
+    componentOrder order() const { return m_order; }
+
+    /** distance between two components of a point, and between two points of a component */
+    size_t componentDistance() const { return (m_order == SOA) ? m_box.size() : 1; }
+    size_t pointDistance() const { return (m_order == SOA) ? 1 : m_components; }
+
+    T& operator()(int a_comp, const point_t<DIM>& a_pt)
+    {
+      return m_data[a_comp * componentDistance() + positionInBox(a_pt, m_box) * pointDistance()];
+    }
+    const T& operator()(int a_comp, const point_t<DIM>& a_pt) const
+    {
+      return m_data[a_comp * componentDistance() + positionInBox(a_pt, m_box) * pointDistance()];
+    }
+
+    /** component a_comp as an array_t, a strided view for AOS */
+    array_t<DIM, T> component(int a_comp)
+    {
+      std::array<size_t, DIM> strides = array_t<DIM, T>::packedStrides(m_box);
+      for (int d = 0; d < DIM; d++)
+        {
+          strides[d] *= pointDistance();
+        }
+      return array_t<DIM, T>(global_ptr<T>(data() + a_comp * componentDistance()),
+                             m_box, strides);
+    }
+
+  private:
+    box_t<DIM>     m_box;
+    int            m_components;
+    componentOrder m_order;
+    std::vector<T> m_data;
+  };
+
   template<int DIM, typename T, typename Func_P>
   struct forallHelper
   {
@@ -917,6 +1225,7 @@ template<typename T, typename T2, int DIM, unsigned long COUNT, unsigned long CO
   template<int DIM, typename T, typename Func>
   inline void forall(Func f, array_t<DIM, T>& array)
   {
+    assert(array.contiguous());
     int* lo=array.m_domain.lo.x;
     int* hi=array.m_domain.hi.x;
     point_t<DIM> p = array.m_domain.lo;
@@ -927,6 +1236,7 @@ template<typename T, typename T2, int DIM, unsigned long COUNT, unsigned long CO
   template<int DIM, typename T1, typename T2, typename Func>
   inline void forall(Func f, array_t<DIM, T1>& array, const array_t<DIM, T2>& array2)
   {
+    assert(array.contiguous() && array2.contiguous());
     int* lo=array.m_domain.lo.x;
     int* hi=array.m_domain.hi.x;
     point_t<DIM> p = array.m_domain.lo;
@@ -1017,11 +1327,33 @@ namespace fftx_helper
   }
 
 
+  /**
+     Twiddle table exp(-2 pi i DIR k / n) for k < n/2, built once per (n, DIR)
+     and shared, so that batchtransformRadix2 may run on several threads.
+  */
+  inline const std::vector<std::complex<double>>& radix2Twiddles(int n, int DIR)
+  {
+    static std::mutex tablesMutex;
+    static std::map<std::pair<int, int>, std::vector<std::complex<double>>> tables;
+    std::lock_guard<std::mutex> lock(tablesMutex);
+    std::vector<std::complex<double>>& expTable = tables[std::make_pair(n, DIR)];
+    if (expTable.size() != (size_t) (n/2))
+      {
+        expTable.resize(n/2);
+        // This must be int, not size_t, because we will negate it.
+        for (int i = 0; i < n / 2; i++)
+          {
+            double th = -(2*DIR*i)*M_PI/(n*1.);
+            expTable[i] = std::complex<double>(cos(th), sin(th));
+          }
+      }
+    return expTable;
+  }
+
   template<int BATCH, typename T, int DIR = 1>
   static void batchtransformRadix2(int n, int stride, T* dvec[])
 
   {  
-    static std::vector<std::complex<double>> expTable;
     int levels = 0;  // Compute levels = floor(log2(n))
     for (size_t temp = n; temp > 1U; temp >>= 1)
       {
@@ -1033,19 +1365,7 @@ namespace fftx_helper
       }
   
     // Trigonometric table
-    if (expTable.size() != n/2)
-      {
-        expTable.resize(n/2);
-        // This must be int, not size_t, because we will negate it.
-        for (int i = 0; i < n / 2; i++)
-          {
-            // std::complex<double> k = std::complex<double>(0, -(2*DIR*i)*M_PI/n);
-            // std::complex<double> tw = std::exp(k);
-            double th = -(2*DIR*i)*M_PI/(n*1.);
-            std::complex<double> tw = std::complex<double>(cos(th), sin(th));
-            expTable[i] = tw;
-          }
-      }
+    const std::vector<std::complex<double>>& expTable = radix2Twiddles(n, DIR);
     
     // Bit-reversed addressing permutation
     for (size_t i = 0; i < n; i++)
@@ -0,0 +1,390 @@
+#ifndef FFTX_CHECK_HEADER
+#define FFTX_CHECK_HEADER
+
+//  Copyright (c) 2018-2022, Carnegie Mellon University
+//  See LICENSE for details
+
+#include <complex>
+#include <vector>
+#include <deque>
+#include <string>
+#include <random>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include "fftx3.hpp"
+#if defined(FFTX_CUDA) || defined(FFTX_HIP)
+#include "device_macros.h"
+#endif
+
+/*
+ Online checked mode for production transforms.
+
+ When enabled, one call in every R of a transform (the first call, then
+ every R-th) is checked: the input and output are copied, and a background
+ thread verifies that
+
+   - the energy is conserved (Parseval): sum |X|^2 == N sum |x|^2, where
+     for the real transforms the truncated spectrum is weighted for the
+     Hermitian half that is not stored;
+   - a few randomly chosen output coefficients match a direct O(N) summation.
+
+ Errors are relative to the energy of the output (its root mean square for
+ the sampled coefficients); a check fails if either exceeds the tolerance.
+ Results go to a counter (checked, failed, dropped) and to a log, stderr by
+ default.  At most a few checks are queued at once; later sampled calls
+ are dropped rather than stalling the caller.
+
+ Checked mode is off by default.  It is set per transform object with
+ setCheckRate(R) (0 turns it off), with default from the environment:
+   FFTX_CHECK_RATE     sampling rate R
+   FFTX_CHECK_TOL      tolerance (default 1e-8)
+   FFTX_CHECK_SAMPLES  sampled coefficients per check (default 2)
+   FFTX_CHECK_LOG      file to append the log to
+*/
+
+namespace fftx_check
+{
+  typedef std::complex<double> cplx;
+
+  enum kind { C2C = 0, R2C = 1, C2R = 2 };
+
+  /** What a checked transform computes. */
+  struct spec
+  {
+    std::string name;
+    kind tp = C2C;
+    std::vector<int> n;    // full extents, slowest varying first
+    int truncAxis = 0;     // axis of n truncated to n/2+1 for R2C and C2R
+    int sign = -1;
+    int batch = 1;         // fields, stored one after another
+
+    size_t npts() const
+    {
+      size_t prod = 1;
+      for (int e : n) prod *= e;
+      return prod;
+    }
+
+    std::vector<int> spectrumExtents() const
+    {
+      std::vector<int> ext = n;
+      if (tp != C2C) ext[truncAxis] = n[truncAxis]/2 + 1;
+      return ext;
+    }
+
+    size_t spectrumPts() const
+    {
+      return (tp == C2C) ? npts() : npts() / n[truncAxis] * (n[truncAxis]/2 + 1);
+    }
+
+    /** Number of doubles of one field in the input and output buffers. */
+    size_t fieldInputDoubles() const
+    {
+      return (tp == R2C) ? npts() : 2 * spectrumPts();
+    }
+
+    size_t fieldOutputDoubles() const
+    {
+      return (tp == C2R) ? npts() : 2 * spectrumPts();
+    }
+
+    /** Number of doubles in the input and output buffers. */
+    size_t inputDoubles() const { return batch * fieldInputDoubles(); }
+    size_t outputDoubles() const { return batch * fieldOutputDoubles(); }
+  };
+
+  /**
+     Spec of a transform of extents a_sizes in a_layout (by default the
+     FFTX layout, FFTX_ROW_MAJOR_ORDER and FFTX_COMPLEX_TRUNC_LAST).
+  */
+  inline spec layoutSpec(const std::string& a_name, kind a_tp,
+                         const std::vector<int>& a_sizes, int a_sign,
+                         const fftx::layout_t& a_layout = fftx::layout_t())
+  {
+    spec s;
+    s.name = a_name;
+    s.tp = a_tp;
+    s.n = a_layout.physical(a_sizes);
+    s.truncAxis = a_layout.physicalTruncAxis(s.n.size());
+    s.sign = a_sign;
+    return s;
+  }
+
+  inline double envDouble(const char* a_var, double a_default)
+  {
+    const char* env = std::getenv(a_var);
+    return (env != nullptr && env[0] != '\0') ? atof(env) : a_default;
+  }
+
+  inline int defaultRate()
+  {
+    static const int rate = (int) envDouble("FFTX_CHECK_RATE", 0.);
+    return rate;
+  }
+
+  /** Decides which calls of one transform object are checked. */
+  class sampler
+  {
+  public:
+    sampler() : m_rate(defaultRate()), m_calls(0) { }
+
+    void setRate(int a_rate) { m_rate = a_rate; m_calls = 0; }
+    int rate() const { return m_rate; }
+
+    bool sample()
+    {
+      return (m_rate > 0) && (m_calls++ % m_rate == 0);
+    }
+
+  private:
+    int m_rate;
+    unsigned long m_calls;
+  };
+
+  /** Copy a buffer, which is on the device in GPU builds, to the host. */
+  inline std::vector<double> snapshot(const double* a_ptr, size_t a_count)
+  {
+    std::vector<double> host(a_count);
+#if defined(FFTX_CUDA) || defined(FFTX_HIP)
+    DEVICE_MEM_COPY(host.data(), (void*) a_ptr, a_count * sizeof(double), MEM_COPY_DEVICE_TO_HOST);
+#else
+    std::copy(a_ptr, a_ptr + a_count, host.begin());
+#endif
+    return host;
+  }
+
+  /** Energy of a spectrum array, weighted for the Hermitian half not stored. */
+  inline double spectrumEnergy(const spec& a_spec, const cplx* a_data)
+  {
+    std::vector<int> ext = a_spec.spectrumExtents();
+    size_t inner = 1;
+    for (size_t d = a_spec.truncAxis + 1; d < ext.size(); d++) inner *= ext[d];
+    int nt = a_spec.n[a_spec.truncAxis];
+    size_t total = a_spec.batch * a_spec.spectrumPts();
+    double energy = 0.;
+    for (size_t i = 0; i < total; i++)
+      {
+        double w = 1.;
+        if (a_spec.tp != C2C)
+          {
+            int k = (i / inner) % ext[a_spec.truncAxis];
+            w = (k == 0 || 2*k == nt) ? 1. : 2.;
+          }
+        energy += w * std::norm(a_data[i]);
+      }
+    return energy;
+  }
+
+  /**
+     Output coefficient at a_pt (indices into the output extents) by direct
+     summation over the input, with the same weighting for a truncated input.
+  */
+  inline cplx directCoefficient(const spec& a_spec, const std::vector<int>& a_pt,
+                                const double* a_in)
+  {
+    int dim = a_spec.n.size();
+    std::vector<int> inExt = (a_spec.tp == C2R) ? a_spec.spectrumExtents() : a_spec.n;
+    std::vector<std::vector<cplx>> tw(dim);
+    for (int d = 0; d < dim; d++)
+      {
+        long long n = a_spec.n[d];
+        tw[d].resize(inExt[d]);
+        for (int j = 0; j < inExt[d]; j++)
+          {
+            double th = a_spec.sign * 2. * M_PI * ((a_pt[d] * (long long) j) % n) / (n * 1.);
+            tw[d][j] = cplx(cos(th), sin(th));
+            if (a_spec.tp == C2R && d == a_spec.truncAxis && j != 0 && 2*j != n)
+              tw[d][j] *= 2.;
+          }
+      }
+    // Walk the input in storage order with an odometer over the indices.
+    std::vector<int> idx(dim, 0);
+    std::vector<cplx> prefix(dim + 1, cplx(1., 0.));
+    for (int d = 0; d < dim; d++) prefix[d+1] = prefix[d] * tw[d][0];
+    size_t total = 1;
+    for (int e : inExt) total *= e;
+    cplx sum = 0.;
+    for (size_t i = 0; i < total; i++)
+      {
+        cplx val = (a_spec.tp == R2C) ? cplx(a_in[i], 0.) : cplx(a_in[2*i], a_in[2*i+1]);
+        sum += prefix[dim] * val;
+        int d = dim - 1;
+        while (d >= 0 && ++idx[d] == inExt[d])
+          {
+            idx[d] = 0;
+            d--;
+          }
+        if (d < 0) break;
+        for (int e = d; e < dim; e++) prefix[e+1] = prefix[e] * tw[e][idx[e]];
+      }
+    return (a_spec.tp == C2R) ? cplx(sum.real(), 0.) : sum;
+  }
+
+  /** Background checker: a queue of snapshots and a worker thread. */
+  class checker
+  {
+  public:
+    static checker& instance()
+    {
+      static checker chk;
+      return chk;
+    }
+
+    long checked() const { return m_checked; }
+    long failed() const { return m_failed; }
+    long dropped() const { return m_dropped; }
+
+    void setTolerance(double a_tol) { m_tol = a_tol; }
+    double tolerance() const { return m_tol; }
+
+    void submit(const spec& a_spec, std::vector<double>&& a_in, std::vector<double>&& a_out)
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      if (m_queue.size() >= s_maxQueue)
+        {
+          m_dropped++;
+          return;
+        }
+      if (!m_worker.joinable())
+        m_worker = std::thread(&checker::run, this);
+      m_queue.push_back(job{a_spec, std::move(a_in), std::move(a_out)});
+      m_cond.notify_all();
+    }
+
+    /** Wait until all queued checks are done. */
+    void flush()
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cond.wait(lock, [this] { return m_queue.empty() && !m_busy; });
+    }
+
+    ~checker()
+    {
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stop = true;
+        m_cond.notify_all();
+      }
+      if (m_worker.joinable()) m_worker.join();
+      if (m_log != stderr && m_log != nullptr) fclose(m_log);
+    }
+
+  private:
+    struct job
+    {
+      spec sp;
+      std::vector<double> in;
+      std::vector<double> out;
+    };
+
+    static const size_t s_maxQueue = 4;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<job> m_queue;
+    std::thread m_worker;
+    bool m_stop = false;
+    bool m_busy = false;
+    std::atomic<long> m_checked{0};
+    std::atomic<long> m_failed{0};
+    std::atomic<long> m_dropped{0};
+    double m_tol;
+    int m_samples;
+    FILE* m_log;
+    std::mt19937 m_gen;
+
+    checker()
+    {
+      m_tol = envDouble("FFTX_CHECK_TOL", 1.e-8);
+      m_samples = (int) envDouble("FFTX_CHECK_SAMPLES", 2.);
+      const char* logname = std::getenv("FFTX_CHECK_LOG");
+      m_log = (logname != nullptr && logname[0] != '\0') ? fopen(logname, "a") : nullptr;
+      if (m_log == nullptr) m_log = stderr;
+    }
+
+    void run()
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      while (true)
+        {
+          m_cond.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+          if (m_queue.empty()) return;
+          job jb = std::move(m_queue.front());
+          m_queue.pop_front();
+          m_busy = true;
+          lock.unlock();
+          check(jb);
+          lock.lock();
+          m_busy = false;
+          m_cond.notify_all();
+        }
+    }
+
+    void check(const job& a_job)
+    {
+      const spec& sp = a_job.sp;
+      // Parseval: transforms are unnormalized in both directions, so the
+      // output energy is N times the input energy.
+      double inEnergy = 0., outEnergy = 0.;
+      const double* in = a_job.in.data();
+      const double* out = a_job.out.data();
+      if (sp.tp == R2C)
+        for (size_t i = 0; i < a_job.in.size(); i++) inEnergy += in[i] * in[i];
+      else
+        inEnergy = spectrumEnergy(sp, (const cplx*) in);
+      if (sp.tp == C2R)
+        for (size_t i = 0; i < a_job.out.size(); i++) outEnergy += out[i] * out[i];
+      else
+        outEnergy = spectrumEnergy(sp, (const cplx*) out);
+      double expected = inEnergy * sp.npts();
+      double energyErr = (expected > 0.) ? std::abs(outEnergy - expected) / expected : outEnergy;
+
+      // sampled coefficients, relative to the root mean square output value
+      std::vector<int> outExt = (sp.tp == R2C) ? sp.spectrumExtents() : sp.n;
+      double rms = std::sqrt(outEnergy / (sp.npts() * sp.batch));
+      double sampleErr = 0.;
+      for (int s = 0; s < m_samples; s++)
+        {
+          std::vector<int> pt(outExt.size());
+          size_t pos = 0;
+          for (size_t d = 0; d < outExt.size(); d++)
+            {
+              pt[d] = std::uniform_int_distribution<int>(0, outExt[d] - 1)(m_gen);
+              pos = pos * outExt[d] + pt[d];
+            }
+          int f = std::uniform_int_distribution<int>(0, sp.batch - 1)(m_gen);
+          cplx direct = directCoefficient(sp, pt, in + f * sp.fieldInputDoubles());
+          const double* fout = out + f * sp.fieldOutputDoubles();
+          cplx got = (sp.tp == C2R) ? cplx(fout[pos], 0.) : cplx(fout[2*pos], fout[2*pos+1]);
+          double err = std::abs(got - direct) / ((rms > 0.) ? rms : 1.);
+          sampleErr = std::max(sampleErr, err);
+        }
+
+      bool ok = (energyErr <= m_tol && sampleErr <= m_tol);
+      m_checked++;
+      if (!ok) m_failed++;
+      std::string sizes;
+      for (size_t d = 0; d < sp.n.size(); d++)
+        sizes += (d ? "x" : "") + std::to_string(sp.n[d]);
+      if (sp.batch > 1) sizes += " batch " + std::to_string(sp.batch);
+      fprintf(m_log, "fftx check: %s %s energy rel err %.3e, %d samples max rel err %.3e: %s\n",
+              sp.name.c_str(), sizes.c_str(), energyErr, m_samples, sampleErr,
+              ok ? "OK" : "FAILED");
+      fflush(m_log);
+    }
+  };
+
+  /** Queue a check of one transform call; a_in and a_out are as passed to the transform. */
+  inline void submit(const spec& a_spec, std::vector<double>&& a_in, const double* a_out)
+  {
+    checker::instance().submit(a_spec, std::move(a_in), snapshot(a_out, a_spec.outputDoubles()));
+  }
+}
+
+#endif
@@ -0,0 +1,803 @@
+#ifndef FFTX_DAG_HEADER
+#define FFTX_DAG_HEADER
+
+//  Copyright (c) 2018-2022, Carnegie Mellon University
+//  See LICENSE for details
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdlib>
+
+/*
+ In-memory description of a fused FFTX computation.
+
+ A graph holds typed variables (inputs, outputs, locals and components of
+ other variables) and the nodes that compute them: multidimensional DFTs,
+ pointwise multiplication by a symbol, box embedding and extraction,
+ resampling and copies.  It is built at run time, without tracing, and is
+ serialized on demand to the SPIRAL script of a single TDAG, which the
+ code generator turns into one fused kernel.
+
+ The generated kernel has the signature
+
+   void name(double** Y, double** X, double* sym)
+
+ with Y and X arrays of pointers to the output and input fields, in the
+ order they were declared, and sym one buffer that holds the symbols of all
+ the pointwise nodes one after another (see symbolDoubles()).  Extents are
+ given slowest varying first, as in the SPIRAL script; the real transforms
+ truncate the last axis to n/2+1.
+
+ Variables are numbered in the order they are declared, so two graphs built
+ the same way serialize to the same script and have the same hash() (FNV-1a
+ of the script), which serves as the kernel cache key.
+
+ The tracing API in fftx3.hpp records into a graph as well, through the
+ unchecked addNode() and bind(); traced programs set the kernel name, the
+ argument types and the declared locals to match the plan header they write.
+
+ fuseConvolutions() rewrites each chain real DFT -> pointwise symbol ->
+ inverse real DFT whose intermediates are used by nothing else into one
+ FUSED node, the composition of the three (TCompose, the form of
+ fftx_rconv-frame.g written as one operator), so the code generator
+ keeps the spectrum in registers and the two intermediate arrays are not
+ allocated.  A zero embedding before the chain and an extraction after it
+ are folded in as well; the composed operator is then a free-space
+ convolution, whose transforms are pruned to the nonzero input and the
+ kept output.  pruneTransforms() likewise folds an extraction of a box of
+ the output of any single transform into it.  Traced plans and DAGProblem
+ run both passes (fuse()) unless FFTX_FUSION is 0.
+*/
+
+namespace fftx_dag
+{
+  enum elementType { REAL = 0, COMPLEX = 1 };
+
+  enum bindKind { LOCAL = 0, INPUT = 1, OUTPUT = 2, COMPONENT = 3 };
+
+  enum opKind
+    {
+      DFT = 0,          // complex DFT, batched
+      PRDFT = 1,        // real-to-complex DFT, batched
+      IPRDFT = 2,       // complex-to-real DFT, batched
+      DIAGONAL = 3,     // complex field times a real symbol
+      RC_DIAGONAL = 4,  // complex field times a complex symbol
+      ZERO_EMBED = 5,   // source placed in a zero destination
+      EXTRACT = 6,      // box of the source
+      RESAMPLE = 7,     // band-limited resampling with a shift
+      COPY = 8,
+      RAW = 9,          // script text, written as is
+      FUSED = 10        // composition of parts, applied first to last
+    };
+
+  /** Handle to a variable of a graph. */
+  struct var
+  {
+    int id = 0;
+  };
+
+  struct variable
+  {
+    int id = 0;
+    std::vector<int> extents;  // in elements
+    elementType type = REAL;
+    bindKind bind = LOCAL;
+    int parent = 0;            // COMPONENT: the variable this is part of
+    int index = 0;             // INPUT, OUTPUT: field number, -1 for all of X or Y;
+                               // COMPONENT: part number
+    bool live = true;          // false once a pass has removed all its uses
+
+    size_t elements() const
+    {
+      size_t prod = 1;
+      for (int e : extents) prod *= e;
+      return prod;
+    }
+
+    size_t doubles() const { return (type == COMPLEX ? 2 : 1) * elements(); }
+
+    /** Extents as declared to SPIRAL, in doubles. */
+    std::vector<int> realExtents() const
+    {
+      std::vector<int> ext = extents;
+      if (type == COMPLEX && !ext.empty()) ext.back() *= 2;
+      return ext;
+    }
+  };
+
+  struct node
+  {
+    opKind op = COPY;
+    int dst = 0;
+    int src = 0;
+    std::vector<int> n;          // DFT, PRDFT, IPRDFT: transform extents
+    int sign = -1;               // DFT
+    int batch = 1;               // DFT, PRDFT, IPRDFT; 0 for one transform written
+                                 // without TTensorI (traced PRDFT, IPRDFT)
+    size_t offset = 0;           // DIAGONAL, RC_DIAGONAL: symbol slice, in doubles
+    size_t length = 0;
+    std::vector<int> lo;         // ZERO_EMBED: corner of the source in the destination;
+                                 // EXTRACT: corner of the destination in the source
+    std::vector<double> shift;   // RESAMPLE
+    std::string text;            // RAW
+    std::vector<node> parts;     // FUSED
+  };
+
+  /** What fuseConvolutions() did. */
+  struct fusionReport
+  {
+    int chains = 0;            // chains fused
+    size_t doublesSaved = 0;   // declared size of the intermediate arrays removed
+    int prunedBoxes = 0;       // ZERO_EMBED and EXTRACT nodes folded into transforms
+
+    fusionReport& operator+=(const fusionReport& a_other)
+    {
+      chains += a_other.chains;
+      doublesSaved += a_other.doublesSaved;
+      prunedBoxes += a_other.prunedBoxes;
+      return *this;
+    }
+  };
+
+  /** Whether passes run on traced and runtime graphs: FFTX_FUSION, default on. */
+  inline bool fusionEnabled()
+  {
+    const char* env = std::getenv("FFTX_FUSION");
+    return env == nullptr || env[0] == '\0' || std::atoi(env) != 0;
+  }
+
+  inline size_t product(const std::vector<int>& a_n)
+  {
+    size_t prod = 1;
+    for (int e : a_n) prod *= e;
+    return prod;
+  }
+
+  /** Extents of the spectrum of a real transform of extents a_n. */
+  inline std::vector<int> halfExtents(const std::vector<int>& a_n)
+  {
+    std::vector<int> h = a_n;
+    h.back() = h.back()/2 + 1;
+    return h;
+  }
+
+  template<typename T>
+  inline std::ostream& printList(std::ostream& os, const std::vector<T>& a_list)
+  {
+    os << "[";
+    for (size_t i = 0; i < a_list.size(); i++)
+      os << (i ? ", " : "") << a_list[i];
+    return os << "]";
+  }
+
+  class graph
+  {
+  public:
+    graph() { }
+
+    /** Field a_extents of the inputs X, outputs Y, or a temporary. */
+    var input(const std::vector<int>& a_extents, elementType a_type = REAL)
+    {
+      return declare(a_extents, a_type, INPUT, 0, m_inputs++);
+    }
+
+    var output(const std::vector<int>& a_extents, elementType a_type = REAL)
+    {
+      return declare(a_extents, a_type, OUTPUT, 0, m_outputs++);
+    }
+
+    var local(const std::vector<int>& a_extents, elementType a_type = REAL)
+    {
+      return declare(a_extents, a_type, LOCAL, 0, 0);
+    }
+
+    /** Part a_index of a_parent along its first (slowest) axis. */
+    var component(var a_parent, int a_index)
+    {
+      const variable& p = at(a_parent);
+      if (p.extents.size() < 2 || a_index < 0 || a_index >= p.extents[0])
+        throw std::out_of_range("fftx_dag::graph::component: no such part");
+      std::vector<int> ext(p.extents.begin() + 1, p.extents.end());
+      return declare(ext, p.type, COMPONENT, a_parent.id, a_index);
+    }
+
+    /** a_batch complex DFTs of extents a_n, fields one after another. */
+    void dft(var a_dst, var a_src, const std::vector<int>& a_n, int a_sign, int a_batch = 1)
+    {
+      node nd = transformNode(DFT, a_dst, a_src, a_n, a_batch);
+      nd.sign = a_sign;
+      require(a_dst, COMPLEX, a_batch * product(a_n));
+      require(a_src, COMPLEX, a_batch * product(a_n));
+      m_nodes.push_back(nd);
+    }
+
+    void prdft(var a_dst, var a_src, const std::vector<int>& a_n, int a_batch = 1)
+    {
+      require(a_dst, COMPLEX, a_batch * product(halfExtents(a_n)));
+      require(a_src, REAL, a_batch * product(a_n));
+      m_nodes.push_back(transformNode(PRDFT, a_dst, a_src, a_n, a_batch));
+    }
+
+    void iprdft(var a_dst, var a_src, const std::vector<int>& a_n, int a_batch = 1)
+    {
+      require(a_dst, REAL, a_batch * product(a_n));
+      require(a_src, COMPLEX, a_batch * product(halfExtents(a_n)));
+      m_nodes.push_back(transformNode(IPRDFT, a_dst, a_src, a_n, a_batch));
+    }
+
+    /**
+       a_dst = a_src times a real symbol, one value per point, taken from
+       the next a_src.elements() doubles of sym; returns its offset in sym.
+    */
+    size_t diagonal(var a_dst, var a_src)
+    {
+      return pointwise(DIAGONAL, a_dst, a_src, at(a_src).elements());
+    }
+
+    /** As diagonal, with a complex symbol (interleaved, two doubles a point). */
+    size_t rcDiagonal(var a_dst, var a_src)
+    {
+      return pointwise(RC_DIAGONAL, a_dst, a_src, 2 * at(a_src).elements());
+    }
+
+    void zeroEmbed(var a_dst, var a_src, const std::vector<int>& a_lo)
+    {
+      boxNode(ZERO_EMBED, a_dst, a_src, a_lo, at(a_src), at(a_dst));
+    }
+
+    void extract(var a_dst, var a_src, const std::vector<int>& a_lo)
+    {
+      boxNode(EXTRACT, a_dst, a_src, a_lo, at(a_dst), at(a_src));
+    }
+
+    void resample(var a_dst, var a_src, const std::vector<double>& a_shift)
+    {
+      node nd;
+      nd.op = RESAMPLE;
+      nd.dst = a_dst.id;
+      nd.src = a_src.id;
+      nd.shift = a_shift;
+      m_nodes.push_back(nd);
+    }
+
+    void copy(var a_dst, var a_src)
+    {
+      if (at(a_dst).doubles() != at(a_src).doubles())
+        throw std::invalid_argument("fftx_dag::graph::copy: sizes differ");
+      node nd;
+      nd.op = COPY;
+      nd.dst = a_dst.id;
+      nd.src = a_src.id;
+      m_nodes.push_back(nd);
+    }
+
+    /** Append a node without checking its variables (for tracing). */
+    void addNode(const node& a_node)
+    {
+      if (a_node.op != RAW)
+        {
+          at(a_node.dst);
+          at(a_node.src);
+        }
+      m_nodes.push_back(a_node);
+    }
+
+    /** Script text to write before the definition of transform. */
+    void addScript(const std::string& a_text) { m_preamble.push_back(a_text); }
+
+    /** Rebind a variable as input, output (a_index -1: all of X or Y) or part of a_parent. */
+    void bind(var a_var, bindKind a_bind, int a_index, var a_parent = var())
+    {
+      variable& v = m_vars.at(at(a_var).id - 1);
+      v.bind = a_bind;
+      v.index = a_index;
+      v.parent = a_parent.id;
+      if (a_bind == INPUT && a_index >= m_inputs) m_inputs = a_index + 1;
+      if (a_bind == OUTPUT && a_index >= m_outputs) m_outputs = a_index + 1;
+    }
+
+    /**
+       Options of script(): the variables declared by the TDecl (all LOCAL
+       variables by default), whether X and Y are arrays of pointers (true by
+       default), whether sym is an array of pointers (false by default), and
+       the kernel name (the SPIRAL variable name by default).
+    */
+    void setLocals(const std::vector<var>& a_locals) { m_locals = a_locals; m_explicitLocals = true; }
+    void setPointerArgs(bool a_pointers) { m_pointerArgs = a_pointers; }
+    void setSymbolArrays(bool a_arrays) { m_symbolArrays = a_arrays; }
+    void setFunctionName(const std::string& a_name) { m_fname = a_name; }
+
+    int inputs() const { return m_inputs; }
+    int outputs() const { return m_outputs; }
+    size_t symbolDoubles() const { return m_symbolDoubles; }
+
+    const std::vector<variable>& variables() const { return m_vars; }
+    const std::vector<node>& nodes() const { return m_nodes; }
+    const variable& at(var a_var) const { return at(a_var.id); }
+    const variable& at(int a_id) const
+    {
+      if (a_id < 1 || a_id > (int)m_vars.size())
+        throw std::out_of_range("fftx_dag::graph: no such variable");
+      return m_vars[a_id - 1];
+    }
+
+    /**
+       SPIRAL script defining transform, for a kernel named by the SPIRAL
+       variable name (set before the script, as for the other problems).
+    */
+    std::string script() const
+    {
+      std::ostringstream os;
+      os << std::setprecision(17);
+      os << "symvar := var(\"sym\", " << (m_symbolArrays ? "TPtr(TPtr(TReal))" : "TPtr(TReal)") << ");\n";
+      for (const variable& v : m_vars)
+        {
+          if (!v.live) continue;
+          os << "var_" << v.id << " := var(\"var_" << v.id << "\", BoxND(";
+          printList(os, v.realExtents()) << ", TReal));\n";
+        }
+      for (const variable& v : m_vars)
+        {
+          const char* arg = (v.bind == INPUT) ? "X" : "Y";
+          if ((v.bind == INPUT || v.bind == OUTPUT) && v.index < 0)
+            os << "var_" << v.id << " := " << arg << ";\n";
+          else if (v.bind == INPUT || v.bind == OUTPUT)
+            os << "var_" << v.id << " := nth(" << arg << ", " << v.index << ");\n";
+          else if (v.bind == COMPONENT)
+            os << "var_" << v.id << " := nth(var_" << v.parent << ", " << v.index << ");\n";
+        }
+      std::vector<var> locals = m_locals;
+      if (!m_explicitLocals)
+        for (const variable& v : m_vars)
+          if (v.bind == LOCAL && v.live)
+            {
+              var l;
+              l.id = v.id;
+              locals.push_back(l);
+            }
+      if (locals.empty())
+        os << "var_0 := var(\"var_0\", BoxND([0], TReal));\n";
+      for (const std::string& text : m_preamble)
+        os << text << "\n";
+
+      os << "transform := TFCall(TDecl(TDAG([\n";
+      for (const node& nd : m_nodes)
+        {
+          if (nd.op == RAW)
+            {
+              os << nd.text << "\n";
+              continue;
+            }
+          os << "    TDAGNode(";
+          printOp(os, nd);
+          os << ", var_" << nd.dst << ", var_" << nd.src << "),\n";
+        }
+      os << "]),\n   [";
+      for (size_t i = 0; i < locals.size(); i++)
+        os << (i ? ", " : "") << "var_" << locals[i].id;
+      if (locals.empty())
+        os << "var_0";
+      os << "]\n),\nrec(";
+      if (m_pointerArgs)
+        os << "XType := TPtr(TPtr(TReal)), YType := TPtr(TPtr(TReal)), ";
+      if (m_fname.empty())
+        os << "fname := name";
+      else
+        os << "fname := \"" << m_fname << "\"";
+      os << ", params := [symvar])\n);\n";
+      return os.str();
+    }
+
+    /** FNV-1a hash of script(). */
+    uint64_t hash() const
+    {
+      std::string text = script();
+      uint64_t h = 14695981039346656037ULL;
+      for (char c : text)
+        {
+          h ^= (unsigned char)c;
+          h *= 1099511628211ULL;
+        }
+      return h;
+    }
+
+    /** hash() in hexadecimal, for kernel and cache file names. */
+    std::string hashString() const
+    {
+      std::ostringstream os;
+      os << std::hex << std::setw(16) << std::setfill('0') << hash();
+      return os.str();
+    }
+
+    /**
+       Fuse every chain PRDFT(t1 <- x), DIAGONAL or RC_DIAGONAL (t2 <- t1),
+       IPRDFT(y <- t2) of the same extents and batch, where t1 and t2 are
+       local arrays used only by the chain and no node in between touches
+       x or y; the FUSED node takes the place of the last node of the chain.
+       A ZERO_EMBED that fills x, or an EXTRACT that reads y, joins the
+       chain on the same terms, so the generated kernel prunes the transforms
+       of the zero padding and of the part of y that is not kept (free-space
+       or Hockney convolution).
+    */
+    fusionReport fuseConvolutions()
+    {
+      fusionReport report;
+      bool changed = true;
+      while (changed)
+        {
+          changed = false;
+          for (size_t k = 0; k < m_nodes.size() && !changed; k++)
+            {
+              std::vector<size_t> chain;
+              if (!findChain(k, chain)) continue;
+              report.chains++;
+              node fused;
+              fused.op = FUSED;
+              fused.src = m_nodes[chain.front()].src;
+              fused.dst = m_nodes[chain.back()].dst;
+              fused.n = m_nodes[k].n;
+              fused.batch = m_nodes[k].batch;
+              for (size_t c = 0; c < chain.size(); c++)
+                {
+                  const node& nd = m_nodes[chain[c]];
+                  fused.parts.push_back(nd);
+                  if (nd.op == ZERO_EMBED || nd.op == EXTRACT) report.prunedBoxes++;
+                  if (c + 1 == chain.size()) continue;
+                  report.doublesSaved += at(nd.dst).doubles();
+                  kill(nd.dst);
+                }
+              m_nodes[chain.back()] = fused;
+              for (size_t c = chain.size() - 1; c-- > 0; )
+                m_nodes.erase(m_nodes.begin() + chain[c]);
+              changed = true;
+            }
+        }
+      return report;
+    }
+
+    /**
+       Fold each EXTRACT of a box of the output of a DFT, PRDFT or IPRDFT,
+       where that output is a local array used by nothing else, into a FUSED
+       node of the two: the generated kernel then skips the butterflies and
+       stores of the coefficients outside the box (output pruning), and the
+       full-size output array is not allocated.
+    */
+    fusionReport pruneTransforms()
+    {
+      fusionReport report;
+      for (size_t k = 0; k < m_nodes.size(); k++)
+        {
+          if (m_nodes[k].op != EXTRACT) continue;
+          std::vector<size_t> w = uses(m_nodes[k].src, true);
+          if (w.size() != 1 || w[0] >= k) continue;
+          size_t i = w[0];
+          const node& t = m_nodes[i];
+          if ((t.op != DFT && t.op != PRDFT && t.op != IPRDFT) ||
+              !privateLocal(t.dst, i, k))
+            continue;
+          int x = root(t.src), y = root(m_nodes[k].dst);
+          if (x == y || !untouched(i, k, {i, k}, x, y)) continue;
+          report.prunedBoxes++;
+          report.doublesSaved += at(t.dst).doubles();
+          kill(t.dst);
+          node fused;
+          fused.op = FUSED;
+          fused.src = t.src;
+          fused.dst = m_nodes[k].dst;
+          fused.n = t.n;
+          fused.batch = t.batch;
+          fused.parts = {t, m_nodes[k]};
+          m_nodes[k] = fused;
+          m_nodes.erase(m_nodes.begin() + i);
+          k--;
+        }
+      return report;
+    }
+
+    /** All the passes: fuseConvolutions(), then pruneTransforms(). */
+    fusionReport fuse()
+    {
+      fusionReport report = fuseConvolutions();
+      report += pruneTransforms();
+      return report;
+    }
+
+  private:
+    std::vector<variable> m_vars;
+    std::vector<node> m_nodes;
+    int m_inputs = 0;
+    int m_outputs = 0;
+    size_t m_symbolDoubles = 0;
+    std::vector<std::string> m_preamble;
+    std::vector<var> m_locals;
+    bool m_explicitLocals = false;
+    bool m_pointerArgs = true;
+    bool m_symbolArrays = false;
+    std::string m_fname;
+
+    var declare(const std::vector<int>& a_extents, elementType a_type,
+                bindKind a_bind, int a_parent, int a_index)
+    {
+      variable v;
+      v.id = m_vars.size() + 1;
+      v.extents = a_extents;
+      v.type = a_type;
+      v.bind = a_bind;
+      v.parent = a_parent;
+      v.index = a_index;
+      m_vars.push_back(v);
+      var rtn;
+      rtn.id = v.id;
+      return rtn;
+    }
+
+    void require(var a_var, elementType a_type, size_t a_elements) const
+    {
+      const variable& v = at(a_var);
+      if (v.type != a_type || v.elements() != a_elements)
+        throw std::invalid_argument("fftx_dag::graph: variable var_" + std::to_string(v.id) +
+                                    " does not match the transform");
+    }
+
+    node transformNode(opKind a_op, var a_dst, var a_src, const std::vector<int>& a_n, int a_batch) const
+    {
+      node nd;
+      nd.op = a_op;
+      nd.dst = a_dst.id;
+      nd.src = a_src.id;
+      nd.n = a_n;
+      nd.batch = a_batch;
+      return nd;
+    }
+
+    size_t pointwise(opKind a_op, var a_dst, var a_src, size_t a_length)
+    {
+      const variable& s = at(a_src);
+      if (s.type != COMPLEX)
+        throw std::invalid_argument("fftx_dag::graph: pointwise symbols apply to complex fields");
+      require(a_dst, COMPLEX, s.elements());
+      node nd;
+      nd.op = a_op;
+      nd.dst = a_dst.id;
+      nd.src = a_src.id;
+      nd.offset = m_symbolDoubles;
+      nd.length = a_length;
+      m_symbolDoubles += a_length;
+      m_nodes.push_back(nd);
+      return nd.offset;
+    }
+
+    void boxNode(opKind a_op, var a_dst, var a_src, const std::vector<int>& a_lo,
+                 const variable& a_small, const variable& a_big)
+    {
+      if (a_small.type != a_big.type || a_lo.size() != a_big.extents.size() ||
+          a_small.extents.size() != a_big.extents.size())
+        throw std::invalid_argument("fftx_dag::graph: box variables do not match");
+      for (size_t d = 0; d < a_lo.size(); d++)
+        if (a_lo[d] < 0 || a_lo[d] + a_small.extents[d] > a_big.extents[d])
+          throw std::out_of_range("fftx_dag::graph: box outside the variable");
+      node nd;
+      nd.op = a_op;
+      nd.dst = a_dst.id;
+      nd.src = a_src.id;
+      nd.lo = a_lo;
+      m_nodes.push_back(nd);
+    }
+
+    /** The variable a_id is part of, at the top. */
+    int root(int a_id) const
+    {
+      while (at(a_id).bind == COMPONENT) a_id = at(a_id).parent;
+      return a_id;
+    }
+
+    /** Nodes that write (a_writes) or read a_id. */
+    std::vector<size_t> uses(int a_id, bool a_writes) const
+    {
+      std::vector<size_t> rtn;
+      for (size_t i = 0; i < m_nodes.size(); i++)
+        if (m_nodes[i].op != RAW && (a_writes ? m_nodes[i].dst : m_nodes[i].src) == a_id)
+          rtn.push_back(i);
+      return rtn;
+    }
+
+    /** A local array used only by the nodes a_writer and a_reader. */
+    bool privateLocal(int a_id, size_t a_writer, size_t a_reader) const
+    {
+      const variable& v = at(a_id);
+      if (v.bind != LOCAL || !v.live) return false;
+      for (const variable& w : m_vars)
+        if (w.bind == COMPONENT && w.parent == a_id) return false;
+      std::vector<size_t> w = uses(a_id, true), r = uses(a_id, false);
+      return w.size() == 1 && w[0] == a_writer && r.size() == 1 && r[0] == a_reader;
+    }
+
+    /** Whether no node strictly between a_first and a_last but a_chain touches a_x or a_y. */
+    bool untouched(size_t a_first, size_t a_last, const std::vector<size_t>& a_chain,
+                   int a_x, int a_y) const
+    {
+      for (size_t m = a_first + 1; m < a_last; m++)
+        {
+          if (std::find(a_chain.begin(), a_chain.end(), m) != a_chain.end()) continue;
+          const node& nd = m_nodes[m];
+          if (nd.op == RAW) return false;
+          int d = root(nd.dst), s = root(nd.src);
+          if (d == a_x || d == a_y || s == a_x || s == a_y) return false;
+        }
+      return true;
+    }
+
+    /** The nodes, in order, of the chain ending with the IPRDFT a_nodes[k]. */
+    bool findChain(size_t k, std::vector<size_t>& a_chain) const
+    {
+      const node& inv = m_nodes[k];
+      if (inv.op != IPRDFT) return false;
+      std::vector<size_t> w2 = uses(inv.src, true);
+      if (w2.size() != 1 || w2[0] >= k) return false;
+      size_t j = w2[0];
+      const node& diag = m_nodes[j];
+      if (diag.op != DIAGONAL && diag.op != RC_DIAGONAL) return false;
+      std::vector<size_t> w1 = uses(diag.src, true);
+      if (w1.size() != 1 || w1[0] >= j) return false;
+      size_t i = w1[0];
+      const node& fwd = m_nodes[i];
+      if (fwd.op != PRDFT || fwd.n != inv.n || fwd.batch != inv.batch ||
+          diag.src == diag.dst ||
+          !privateLocal(diag.src, i, j) || !privateLocal(diag.dst, j, k))
+        return false;
+      a_chain = {i, j, k};
+      int x = root(fwd.src), y = root(inv.dst);
+      if (x == y || !untouched(i, k, a_chain, x, y)) return false;
+
+      // the zero padding of x and the part of y that is not kept
+      std::vector<size_t> we = uses(fwd.src, true);
+      if (we.size() == 1 && we[0] < i && m_nodes[we[0]].op == ZERO_EMBED &&
+          privateLocal(fwd.src, we[0], i))
+        {
+          std::vector<size_t> chain = a_chain;
+          chain.insert(chain.begin(), we[0]);
+          int xs = root(m_nodes[we[0]].src);
+          if (xs != y && untouched(we[0], k, chain, xs, y))
+            {
+              a_chain = chain;
+              x = xs;
+            }
+        }
+      std::vector<size_t> rx = uses(inv.dst, false);
+      if (rx.size() == 1 && rx[0] > k && m_nodes[rx[0]].op == EXTRACT &&
+          privateLocal(inv.dst, k, rx[0]))
+        {
+          std::vector<size_t> chain = a_chain;
+          chain.push_back(rx[0]);
+          int ys = root(m_nodes[rx[0]].dst);
+          if (ys != x && untouched(chain.front(), rx[0], chain, x, ys))
+            a_chain = chain;
+        }
+      return true;
+    }
+
+    void kill(int a_id)
+    {
+      m_vars[a_id - 1].live = false;
+      m_locals.erase(std::remove_if(m_locals.begin(), m_locals.end(),
+                                    [a_id](const var& v) { return v.id == a_id; }),
+                     m_locals.end());
+    }
+
+    /** Ranges of the box of a_small at a_lo, in doubles. */
+    void printRanges(std::ostream& os, const node& a_nd, const variable& a_small) const
+    {
+      std::vector<int> ext = a_small.realExtents();
+      os << "[";
+      for (size_t d = 0; d < ext.size(); d++)
+        {
+          int lo = a_nd.lo[d];
+          if (a_small.type == COMPLEX && d + 1 == ext.size()) lo *= 2;
+          os << (d ? ", " : "") << "[" << lo << ".." << lo + ext[d] - 1 << "]";
+        }
+      os << "]";
+    }
+
+    void printOp(std::ostream& os, const node& a_nd) const
+    {
+      switch (a_nd.op)
+        {
+        case DFT:
+          os << "TTensorI(MDDFT(";
+          printList(os, a_nd.n) << ", " << a_nd.sign << "), " << a_nd.batch << ", APar, APar)";
+          break;
+        case PRDFT:
+        case IPRDFT:
+          os << (a_nd.batch ? "TTensorI(" : "") << (a_nd.op == PRDFT ? "MDPRDFT(" : "IMDPRDFT(");
+          printList(os, a_nd.n) << (a_nd.op == PRDFT ? ", -1)" : ", 1)");
+          if (a_nd.batch)
+            os << ", " << a_nd.batch << ", APar, APar)";
+          break;
+        case DIAGONAL:
+          os << "Diag(diagTensor(FDataOfs(symvar, " << a_nd.length << ", " << a_nd.offset
+             << "), fConst(TReal, 2, 1)))";
+          break;
+        case RC_DIAGONAL:
+          os << "RCDiag(FDataOfs(symvar, " << a_nd.length << ", " << a_nd.offset << "))";
+          break;
+        case ZERO_EMBED:
+          os << "ZeroEmbedBox(";
+          printList(os, at(a_nd.dst).realExtents()) << ", ";
+          printRanges(os, a_nd, at(a_nd.src));
+          os << ")";
+          break;
+        case EXTRACT:
+          os << "ExtractBox(";
+          printList(os, at(a_nd.src).realExtents()) << ", ";
+          printRanges(os, a_nd, at(a_nd.dst));
+          os << ")";
+          break;
+        case RESAMPLE:
+          os << "TResample(";
+          printList(os, at(a_nd.dst).extents) << ", ";
+          printList(os, at(a_nd.src).extents) << ", ";
+          printList(os, a_nd.shift) << ")";
+          break;
+        case COPY:
+          os << "TGath(fBox(";
+          printList(os, at(a_nd.src).realExtents()) << "))";
+          break;
+        case RAW:
+          os << a_nd.text;
+          break;
+        case FUSED:
+          os << "TCompose([";
+          for (size_t p = a_nd.parts.size(); p-- > 0; )
+            {
+              printOp(os, a_nd.parts[p]);
+              os << (p ? ", " : "");
+            }
+          os << "])";
+          break;
+        }
+    }
+  };
+
+  /**
+     Graph of a_batch transforms a_op (DFT with a_sign, or PRDFT) of extents
+     a_n, of whose outputs only the box of extents a_m at a_lo is kept (a_lo
+     and a_m index the half spectrum for PRDFT).  X and Y are the plain
+     pointers to the fields, one after another; run fuse() (or
+     pruneTransforms()) to prune the transform to the box.
+  */
+  inline graph subBoxTransform(opKind a_op, const std::vector<int>& a_n,
+                               const std::vector<int>& a_lo, const std::vector<int>& a_m,
+                               int a_sign = -1, int a_batch = 1)
+  {
+    std::vector<int> in = a_n;
+    std::vector<int> full = (a_op == PRDFT) ? halfExtents(a_n) : a_n;
+    std::vector<int> box = a_m, lo = a_lo;
+    if (a_batch > 1)
+      {
+        in.insert(in.begin(), a_batch);
+        full.insert(full.begin(), a_batch);
+        box.insert(box.begin(), a_batch);
+        lo.insert(lo.begin(), 0);
+      }
+    graph g;
+    var x = g.input(in, (a_op == PRDFT) ? REAL : COMPLEX);
+    var y = g.output(box, COMPLEX);
+    var t = g.local(full, COMPLEX);
+    if (a_op == PRDFT)
+      g.prdft(t, x, a_n, a_batch);
+    else
+      g.dft(t, x, a_n, a_sign, a_batch);
+    g.extract(y, t, lo);
+    g.bind(x, INPUT, -1);
+    g.bind(y, OUTPUT, -1);
+    g.setPointerArgs(false);
+    return g;
+  }
+}
+
+#endif
@@ -14,7 +14,7 @@
 #if defined FFTX_HIP
 #include "hipbackend.hpp"
 #elif defined FFTX_CUDA
-#include "hipbackend.hpp"
+#include "cudabackend.hpp"
 #else
 #include "cpubackend.hpp"
 #endif
@@ -26,6 +26,7 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <memory>
+#include <mutex>
 
 #if defined(_WIN32) || defined (_WIN64)
   #include <io.h>
@@ -53,11 +54,15 @@ namespace fftx_cuFFT {
 #define CUFFT_FORWARD -1
 #define CUFFT_INVERSE 1
 
+#define FFTX_API_MAX_RANK 4
+
 typedef struct {
     int x;
     int y;
     int z;
     int batch;
+    int rank;
+    int n[FFTX_API_MAX_RANK];
 
 } cufftHandle;
 
@@ -92,118 +97,112 @@ typedef enum cufftResult_t {
 
 typedef std::complex<double> cufftComplex;
 
-typedef std::tuple<int, int, int, int> keys_t;
- 
-struct key_hash : public std::unary_function<keys_t, std::size_t>
-{
-std::size_t operator()(const keys_t& k) const
-{
-return std::get<0>(k) ^ std::get<1>(k) ^ std::get<2>(k) ^ std::get<3>(k);
+// The problem objects behind the API, one per transform.  Each keeps the
+// code it generates by sizes (mdSizes), so repeated calls of a size and
+// dimension only run.  They are shared by all threads, and apiRun holds
+// the lock of the problem for the whole call, so concurrent calls of one
+// transform run one after another.  (A problem per thread would generate
+// and load every kernel once per thread, in the same cache directories.)
+template<class PROBLEM>
+inline PROBLEM& apiProblem(const char * name) {
+    static PROBLEM prob(name);
+    return prob;
+}
+
+template<class PROBLEM>
+inline std::mutex& apiLock() {
+    static std::mutex lock;
+    return lock;
 }
-};
- 
-struct key_equal : public std::binary_function<keys_t, keys_t, bool>
-{
-bool operator()(const keys_t& v0, const keys_t& v1) const
-{
-return (
-std::get<0>(v0) == std::get<0>(v1) &&
-std::get<1>(v0) == std::get<1>(v1) &&
-std::get<2>(v0) == std::get<2>(v1) &&
-std::get<3>(v0) == std::get<3>(v1) 
-);
+
+template<class PROBLEM>
+inline void apiRun(const char * name, const std::vector<int>& sizes, const std::vector<void*>& args) {
+    std::lock_guard<std::mutex> guard(apiLock<PROBLEM>());
+    PROBLEM& prob = apiProblem<PROBLEM>(name);
+    prob.setSizes(sizes);
+    prob.setArgs(args);
+    prob.transform();
 }
-};
 
-typedef std::unordered_map<const keys_t,std::string,key_hash,key_equal> map_t;
+inline std::vector<int> apiSizes(int x, int y, int z, int batch) {
+    return mdSizes(std::vector<int>{x,y,z}, batch);
+}
 
-map_t stored_mddft_jit;
-map_t stored_mdprdft_jit;
+inline std::vector<int> apiSizes(int rank, const int * n, int batch) {
+    return mdSizes(std::vector<int>(n, n + rank), batch);
+}
+
+#if defined FFTX_HIP
+// unused symbol argument of the generated code
+inline hipDeviceptr_t apiSymbol() {
+    static hipDeviceptr_t dsym = [] {
+        hipDeviceptr_t p = nullptr;
+        hipMalloc((void **)&p,  1* sizeof(std::complex<double>));
+        return p;
+    }();
+    return dsym;
+}
+#else
+inline void * apiSymbol() {
+    static std::complex<double> dsym[1];
+    return (void*)dsym;
+}
+#endif
 
+template<class FWD, class INV>
+inline void apiTransform(const char * fname, const char * iname, int sign,
+                         const std::vector<int>& sizes, void * Y, void * X) {
+    std::vector<void*> args{Y,X,(void*)apiSymbol()};
+    if(sign == -1)
+        apiRun<FWD>(fname, sizes, args);
+    else
+        apiRun<INV>(iname, sizes, args);
+}
 
+// 3D DFTs of size [x, y, z] on batch fields stored one after another; one
+// generated kernel transforms all the fields.
 #if defined FFTX_HIP
-void mddft(int x, int y, int z, int sign, hipDeviceptr_t Y, hipDeviceptr_t X) {
+void mddft(int x, int y, int z, int sign, hipDeviceptr_t Y, hipDeviceptr_t X, int batch = 1) {
     if ( DEBUGOUT) std::cout << "Entered mddft fftx hip api call" << std::endl;
-    hipDeviceptr_t dsym;
-    hipMalloc((void **)&dsym,  1* sizeof(std::complex<double>));
-    std::vector<void*> args{Y,X,dsym};
-    std::vector<int> sizes{x,y,z};
-    if(stored_mddft_jit.find(std::make_tuple(x,y,z,sign)) != stored_mddft_jit.end()) {
-        if ( DEBUGOUT) std::cout << "running cached instance" << std::endl;
-        Executor e;
-        e.execute(stored_mddft_jit.at(std::make_tuple(x,y,z,sign)));
-    }
-    else {
-        if(sign == -1)
-            MDDFTProblem mdp(args, sizes, "mddft");
-        else 
-            IMDDFTProblem mdp(args, sizes, "imddft");
-        mdp.transform();
-        stored_mddft_jit[std::make_tuple(x,y,z,sign)] = mdp.returnJIT();
-    }
+    apiTransform<MDDFTProblem, IMDDFTProblem>("mddft", "imddft", sign, apiSizes(x,y,z,batch), Y, X);
 }
 
-void mdprdft(int x, int y, int z, int sign, hipDeviceptr_t Y, hipDeviceptr_t X) {
+void mdprdft(int x, int y, int z, int sign, hipDeviceptr_t Y, hipDeviceptr_t X, int batch = 1) {
     if ( DEBUGOUT) std::cout << "Entered mdprdft fftx hip api call" << std::endl;
-    hipDeviceptr_t dsym;
-    hipMalloc((void **)&dsym,  1* sizeof(std::complex<double>));
-    std::vector<void*> args{Y,X,dsym};
-    std::vector<int> sizes{x,y,z};
-    if(stored_mdprdft_jit.find(std::make_tuple(x,y,z,sign)) != stored_mdprdft_jit.end()) {
-        if ( DEBUGOUT) std::cout << "running cached instance" << std::endl;
-        Executor e;
-        e.execute(stored_mdprdft_jit.at(std::make_tuple(x,y,z,sign)));
-    }
-    else {
-        if(sign == -1)
-            MDPRDFTProblem mdp(args, sizes, "mdprdft");
-        else 
-            IMDPRDFTProblem mdp(args, sizes, "imdprdft");
-        mdp.transform();
-        stored_mdprdft_jit[std::make_tuple(x,y,z,sign)] = mdp.returnJIT();
-    }
+    apiTransform<MDPRDFTProblem, IMDPRDFTProblem>("mdprdft", "imdprdft", sign, apiSizes(x,y,z,batch), Y, X);
+}
+
+// DFTs of rank dimensions n[0 .. rank-1] (1D, 2D, 4D, ...), generated as
+// one kernel of that dimension rather than as batched lower-dimensional calls.
+void mddft(int rank, const int * n, int sign, hipDeviceptr_t Y, hipDeviceptr_t X, int batch = 1) {
+    apiTransform<MDDFTProblem, IMDDFTProblem>("mddft", "imddft", sign, apiSizes(rank,n,batch), Y, X);
+}
+
+void mdprdft(int rank, const int * n, int sign, hipDeviceptr_t Y, hipDeviceptr_t X, int batch = 1) {
+    apiTransform<MDPRDFTProblem, IMDPRDFTProblem>("mdprdft", "imdprdft", sign, apiSizes(rank,n,batch), Y, X);
 }
 
 #else
-void mddft(int x, int y, int z, int sign, double * Y, double * X) {
+void mddft(int x, int y, int z, int sign, double * Y, double * X, int batch = 1) {
     if ( DEBUGOUT) std::cout << "Entered mddft fftx cpu api call" << std::endl;
-    std::complex<double> * dsym = new std::complex<double>[1];
-    // hipMalloc((void **)&dsym,  1* sizeof(std::complex<double>));
-    std::vector<void*> args{(void*)Y,(void*)X,(void*)dsym};
-    std::vector<int> sizes{x,y,z};
-    if(stored_mddft_jit.find(std::make_tuple(x,y,z,sign)) != stored_mddft_jit.end()) {
-        if ( DEBUGOUT) std::cout << "running cached instance" << std::endl;
-        Executor e;
-        e.execute(stored_mddft_jit.at(std::make_tuple(x,y,z,sign)));
-    }
-    else {
-        if(sign == -1)
-            MDDFTProblem mdp(args, sizes, "mddft");
-        else 
-            IMDDFTProblem mdp(args, sizes, "imddft");
-        mdp.transform();
-        stored_mddft_jit[std::make_tuple(x,y,z,sign)] = mdp.returnJIT();
-    }
+    apiTransform<MDDFTProblem, IMDDFTProblem>("mddft", "imddft", sign, apiSizes(x,y,z,batch),
+                                              (void*)Y, (void*)X);
 }
-void mdprdft(int x, int y, int z, int sign, double * Y, double * X) {
-    if ( DEBUGOUT) std::cout << "Entered mddft fftx cpu api call" << std::endl;
-    std::complex<double> * dsym = new std::complex<double>[1];
-    // hipMalloc((void **)&dsym,  1* sizeof(std::complex<double>));
-    std::vector<void*> args{(void*)Y,(void*)X,(void*)dsym};
-    std::vector<int> sizes{x,y,z};
-    if(stored_mdprdft_jit.find(std::make_tuple(x,y,z,sign)) != stored_mdprdft_jit.end()) {
-        if ( DEBUGOUT) std::cout << "running cached instance" << std::endl;
-        Executor e;
-        e.execute(stored_mdprdft_jit.at(std::make_tuple(x,y,z,sign)));
-    }
-    else {
-        if(sign == -1)
-            MDPRDFTProblem mdp(args, sizes, "mdprdft");
-        else 
-            IMDPRDFTProblem mdp(args, sizes, "imdprdft");
-        mdp.transform();
-        stored_mdprdft_jit[std::make_tuple(x,y,z,sign)] = mdp.returnJIT();
-    }
+void mdprdft(int x, int y, int z, int sign, double * Y, double * X, int batch = 1) {
+    if ( DEBUGOUT) std::cout << "Entered mdprdft fftx cpu api call" << std::endl;
+    apiTransform<MDPRDFTProblem, IMDPRDFTProblem>("mdprdft", "imdprdft", sign, apiSizes(x,y,z,batch),
+                                                  (void*)Y, (void*)X);
+}
+
+// DFTs of rank dimensions n[0 .. rank-1] (1D, 2D, 4D, ...), generated as
+// one kernel of that dimension rather than as batched lower-dimensional calls.
+void mddft(int rank, const int * n, int sign, double * Y, double * X, int batch = 1) {
+    apiTransform<MDDFTProblem, IMDDFTProblem>("mddft", "imddft", sign, apiSizes(rank,n,batch),
+                                              (void*)Y, (void*)X);
+}
+void mdprdft(int rank, const int * n, int sign, double * Y, double * X, int batch = 1) {
+    apiTransform<MDPRDFTProblem, IMDPRDFTProblem>("mdprdft", "imdprdft", sign, apiSizes(rank,n,batch),
+                                                  (void*)Y, (void*)X);
 }
 #endif
 
@@ -223,16 +222,22 @@ void cudaMalloc(void** ptr, size_t size) {
     hipMalloc(ptr, size);
 }
 
+// Only contiguous data is supported: the fields of a batch one after
+// another, so the embed, stride and distance arguments are ignored.
 cufftResult cufftPlanMany(cufftHandle *plan, int rank, int *n, int *inembed,
         int istride, int idist, int *onembed, int ostride,
         int odist, cufftType type, int batch) {
-            if(rank != 3) {
-                std::cout << "only supports 3d ffts" << std::endl;
-                return CUFFT_SETUP_FAILED;
+            if(rank < 1 || rank > FFTX_API_MAX_RANK) {
+                std::cout << "only supports ffts of rank 1 to " << FFTX_API_MAX_RANK << std::endl;
+                return CUFFT_INVALID_SIZE;
             }
-            plan->x = n[0];
-            plan->y = n[1];
-            plan->z = n[2];
+            std::vector<int> sizes = apiSizes(rank, n, batch);
+            plan->x = sizes[0];
+            plan->y = sizes[1];
+            plan->z = sizes[2];
+            plan->batch = batch;
+            plan->rank = rank;
+            std::copy(n, n + rank, plan->n);
             return CUFFT_SUCCESS;
         }
 // cufftResult cufftExecC2C(cufftHandle plan, cufftComplex *idata,
@@ -240,23 +245,7 @@ cufftResult cufftPlanMany(cufftHandle *plan, int rank, int *n, int *inembed,
 cufftResult cufftExecC2C(cufftHandle plan, hipDeviceptr_t Y,
          hipDeviceptr_t X, int sign) {
     if ( DEBUGOUT) std::cout << "Entered mddft cuapi call for hip" << std::endl;
-    hipDeviceptr_t dsym;
-    hipMalloc((void **)&dsym,  1* sizeof(std::complex<double>));
-    std::vector<void*> args{Y,X,dsym};
-    std::vector<int> sizes{plan.x,plan.y,plan.z};
-    if(stored_jit.find(std::make_tuple(plan.x,plan.y,plan.z,sign)) != stored_jit.end()) {
-        if ( DEBUGOUT) std::cout << "running cached instance cuapi call for hip" << std::endl;
-        Executor e;
-        e.execute(stored_jit.at(std::make_tuple(plan.x,plan.y,plan.z,sign)));
-    }
-    else {
-        if(sign == -1)
-            MDDFTProblem mdp(args, sizes);
-        else 
-            IMDDFTProblem mdp(args, sizes);
-        mdp.transform();
-        stored_jit[std::make_tuple(plan.x,plan.y,plan.z,sign)] = mdp.returnJIT();
-    }
+    mddft(plan.rank, plan.n, sign, Y, X, plan.batch);
     return CUFFT_SUCCESS; 
 }
 #endif
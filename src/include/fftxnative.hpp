@@ -0,0 +1,1726 @@
+#ifndef FFTX_NATIVE_HEADER
+#define FFTX_NATIVE_HEADER
+
+//  Copyright (c) 2018-2022, Carnegie Mellon University
+//  See LICENSE for details
+
+#include <complex>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*
+ Native CPU FFT engine, used where SPIRAL-generated code is not available.
+
+ Sizes whose prime factors are all in {2, 3, 5, 7} run a Stockham autosort
+ mixed-radix FFT with radix-4, 2, 3, 5 and 7 butterflies; any other size
+ runs Bluestein's algorithm on top of a power-of-2 plan.  A plan (radices
+ and twiddle tables) is built once per size and shared between threads.
+ The butterflies run on complex vectors across the unit-stride loop of
+ each stage: two values at a time with AVX when the compiler targets it
+ (e.g. -mavx or -march=native), otherwise one with SSE2, which every
+ x86-64 build has, and plain scalar code elsewhere.
+
+ Real transforms (MDPRDFT/IMDPRDFT) run the complex engine on half-length
+ data: even-length real lines are packed into complex lines of half the
+ length, with a twiddle pass to separate the halves.
+
+ Transforms are unnormalized, with sign -1 for forward and +1 for inverse,
+ as for MDDFT and IMDDFT.  The real-to-real transforms (DCT and DST of
+ types I, II and III) reduce to complex or real FFTs of the same or
+ doubled length.
+*/
+
+namespace fftx_native
+{
+  typedef std::complex<double> cplx;
+
+  /** Complex multiply without the NaN/Inf recovery done by std::complex. */
+  inline cplx cmul(const cplx& a, const cplx& b)
+  {
+    return cplx(a.real()*b.real() - a.imag()*b.imag(),
+                a.real()*b.imag() + a.imag()*b.real());
+  }
+
+  /** Multiply by sign*i. */
+  inline cplx mulI(const cplx& a, int sign)
+  {
+    return (sign < 0) ? cplx(a.imag(), -a.real()) : cplx(-a.imag(), a.real());
+  }
+
+  /** exp(sign * 2 pi i * num / den), with num reduced modulo den. */
+  inline cplx root(long long num, long long den, int sign)
+  {
+    num %= den;
+    if (num < 0) num += den;
+    double th = sign * 2. * M_PI * num / (den * 1.);
+    return cplx(cos(th), sin(th));
+  }
+
+  /**
+     Complex vectors for the butterflies: width consecutive complex values,
+     loaded and stored unaligned, with the twiddle of a butterfly held in
+     the form its multiply needs (tw).  cvec1 is the scalar version, which
+     also runs the tail of each vector loop; cvecN is the widest one the
+     target has.
+  */
+  struct cvec1
+  {
+    static const int width = 1;
+    struct tw
+    {
+      cplx w;
+      tw() {}
+      explicit tw(const cplx& a_w) : w(a_w) {}
+    };
+    cplx v;
+    cvec1() {}
+    cvec1(const cplx& a_v) : v(a_v) {}
+    static cvec1 zero() { return cvec1(cplx(0.)); }
+    static cvec1 load(const cplx* a_p) { return cvec1(*a_p); }
+    void store(cplx* a_p) const { *a_p = v; }
+  };
+
+  inline cvec1 operator+(const cvec1& a, const cvec1& b) { return cvec1(a.v + b.v); }
+  inline cvec1 operator-(const cvec1& a, const cvec1& b) { return cvec1(a.v - b.v); }
+  inline cvec1 operator*(double a, const cvec1& b) { return cvec1(a * b.v); }
+  inline cvec1 cmul(const cvec1& a, const cvec1::tw& b) { return cvec1(cmul(a.v, b.w)); }
+  inline cvec1 mulI(const cvec1& a, int sign) { return cvec1(mulI(a.v, sign)); }
+
+#if defined(__AVX__)
+  struct cvecAVX
+  {
+    static const int width = 2;
+    struct tw
+    {
+      __m256d re, im;
+      tw() {}
+      explicit tw(const cplx& a_w) : re(_mm256_set1_pd(a_w.real())), im(_mm256_set1_pd(a_w.imag())) {}
+    };
+    __m256d v;
+    cvecAVX() {}
+    cvecAVX(__m256d a_v) : v(a_v) {}
+    static cvecAVX zero() { return _mm256_setzero_pd(); }
+    static cvecAVX load(const cplx* a_p) { return _mm256_loadu_pd(reinterpret_cast<const double*>(a_p)); }
+    void store(cplx* a_p) const { _mm256_storeu_pd(reinterpret_cast<double*>(a_p), v); }
+  };
+
+  inline cvecAVX operator+(const cvecAVX& a, const cvecAVX& b) { return _mm256_add_pd(a.v, b.v); }
+  inline cvecAVX operator-(const cvecAVX& a, const cvecAVX& b) { return _mm256_sub_pd(a.v, b.v); }
+  inline cvecAVX operator*(double a, const cvecAVX& b) { return _mm256_mul_pd(_mm256_set1_pd(a), b.v); }
+
+  inline cvecAVX cmul(const cvecAVX& a, const cvecAVX::tw& b)
+  {
+    __m256d swapped = _mm256_permute_pd(a.v, 0x5);
+    return _mm256_addsub_pd(_mm256_mul_pd(a.v, b.re), _mm256_mul_pd(swapped, b.im));
+  }
+
+  inline cvecAVX mulI(const cvecAVX& a, int sign)
+  {
+    // sign*i*(x + iy) = (-sign*y, sign*x): swap, then negate the real or imaginary lanes
+    __m256d neg = (sign < 0) ? _mm256_set_pd(-0., 0., -0., 0.) : _mm256_set_pd(0., -0., 0., -0.);
+    return _mm256_xor_pd(_mm256_permute_pd(a.v, 0x5), neg);
+  }
+
+  typedef cvecAVX cvecN;
+#elif defined(__SSE2__)
+  struct cvecSSE2
+  {
+    static const int width = 1;
+    struct tw
+    {
+      __m128d re, im;
+      tw() {}
+      explicit tw(const cplx& a_w) : re(_mm_set1_pd(a_w.real())), im(_mm_set1_pd(a_w.imag())) {}
+    };
+    __m128d v;
+    cvecSSE2() {}
+    cvecSSE2(__m128d a_v) : v(a_v) {}
+    static cvecSSE2 zero() { return _mm_setzero_pd(); }
+    static cvecSSE2 load(const cplx* a_p) { return _mm_loadu_pd(reinterpret_cast<const double*>(a_p)); }
+    void store(cplx* a_p) const { _mm_storeu_pd(reinterpret_cast<double*>(a_p), v); }
+  };
+
+  inline cvecSSE2 operator+(const cvecSSE2& a, const cvecSSE2& b) { return _mm_add_pd(a.v, b.v); }
+  inline cvecSSE2 operator-(const cvecSSE2& a, const cvecSSE2& b) { return _mm_sub_pd(a.v, b.v); }
+  inline cvecSSE2 operator*(double a, const cvecSSE2& b) { return _mm_mul_pd(_mm_set1_pd(a), b.v); }
+
+  inline cvecSSE2 cmul(const cvecSSE2& a, const cvecSSE2::tw& b)
+  {
+    // (ar br - ai bi, ai br + ar bi); SSE2 has no addsub, so negate the real lane
+    __m128d swapped = _mm_shuffle_pd(a.v, a.v, 1);
+    __m128d cross = _mm_xor_pd(_mm_mul_pd(swapped, b.im), _mm_set_pd(0., -0.));
+    return _mm_add_pd(_mm_mul_pd(a.v, b.re), cross);
+  }
+
+  inline cvecSSE2 mulI(const cvecSSE2& a, int sign)
+  {
+    __m128d neg = (sign < 0) ? _mm_set_pd(-0., 0.) : _mm_set_pd(0., -0.);
+    return _mm_xor_pd(_mm_shuffle_pd(a.v, a.v, 1), neg);
+  }
+
+  typedef cvecSSE2 cvecN;
+#else
+  typedef cvec1 cvecN;
+#endif
+
+  /** Number of threads the native engine may use; FFTX_NATIVE_THREADS overrides. */
+  inline int numThreadsFromEnv()
+  {
+    const char* env = std::getenv("FFTX_NATIVE_THREADS");
+    int n = (env != nullptr) ? atoi(env) : (int) std::thread::hardware_concurrency();
+    return (n > 0) ? n : 1;
+  }
+
+  inline int numThreads()
+  {
+    static const int nthreads = numThreadsFromEnv();
+    return nthreads;
+  }
+
+  /**
+     True on a thread that is already one of several running in parallel,
+     such as a worker of parallelFor; transforms called there stay serial.
+     Callers that run transforms on their own threads may set it too.
+  */
+  inline bool& inParallel()
+  {
+    static thread_local bool flag = false;
+    return flag;
+  }
+
+  /**
+     Call a_func(begin, end) on consecutive ranges of [0, a_count),
+     on up to numThreads() threads.  A_cost is the approximate work per
+     item; small jobs, and nested calls, run on the calling thread.
+  */
+  template<typename F>
+  inline void parallelFor(size_t a_count, size_t a_cost, F a_func)
+  {
+    size_t nthreads = std::min((size_t) numThreads(), a_count);
+    if (nthreads <= 1 || inParallel() || a_count * a_cost < (1 << 15))
+      {
+        a_func((size_t) 0, a_count);
+        return;
+      }
+    auto worker = [&a_func](size_t begin, size_t end)
+      {
+        inParallel() = true;
+        a_func(begin, end);
+      };
+    std::vector<std::thread> threads;
+    size_t chunk = (a_count + nthreads - 1) / nthreads;
+    for (size_t begin = chunk; begin < a_count; begin += chunk)
+      {
+        threads.push_back(std::thread(worker, begin, std::min(begin + chunk, a_count)));
+      }
+    inParallel() = true;
+    a_func((size_t) 0, std::min(chunk, a_count));
+    inParallel() = false;
+    for (auto& t : threads) t.join();
+  }
+
+  /**
+     One Stockham stage of radix R for a current length l = m*R and
+     current stride s: y[q + s*(R*p + k)] = w_l^(p*k) * sum_j x[q + s*(p + j*m)] w_R^(j*k).
+     The inner loop over q is unit-stride in both x and y; butterflies<R, V>
+     runs it on vectors V from a_q while a whole vector fits, and returns
+     where it stopped, for cvec1 to finish.
+  */
+  template<int R, class V>
+  struct butterflies;
+
+  template<class V>
+  struct butterflies<2, V>
+  {
+    static int run(int a_q, int s, int m, const cplx* x0, cplx* y0, const cplx* tw, int /* sign */)
+    {
+      typename V::tw w1(tw[1]);
+      const cplx* x1 = x0 + s*m;
+      cplx* y1 = y0 + s;
+      int q = a_q;
+      for (; q + V::width <= s; q += V::width)
+        {
+          V a0 = V::load(x0 + q), a1 = V::load(x1 + q);
+          (a0 + a1).store(y0 + q);
+          cmul(a0 - a1, w1).store(y1 + q);
+        }
+      return q;
+    }
+  };
+
+  template<class V>
+  struct butterflies<4, V>
+  {
+    static int run(int a_q, int s, int m, const cplx* x0, cplx* y0, const cplx* tw, int sign)
+    {
+      typename V::tw w1(tw[1]), w2(tw[2]), w3(tw[3]);
+      const cplx* x1 = x0 + s*m;
+      const cplx* x2 = x0 + 2*s*m;
+      const cplx* x3 = x0 + 3*s*m;
+      int q = a_q;
+      for (; q + V::width <= s; q += V::width)
+        {
+          V a0 = V::load(x0 + q), a1 = V::load(x1 + q), a2 = V::load(x2 + q), a3 = V::load(x3 + q);
+          V s02 = a0 + a2, d02 = a0 - a2;
+          V s13 = a1 + a3, d13 = mulI(a1 - a3, sign);
+          (s02 + s13).store(y0 + q);
+          cmul(d02 + d13, w1).store(y0 + q + s);
+          cmul(s02 - s13, w2).store(y0 + q + 2*s);
+          cmul(d02 - d13, w3).store(y0 + q + 3*s);
+        }
+      return q;
+    }
+  };
+
+  /** cos and sin of 2 pi j / R, built once per radix. */
+  template<int R>
+  struct unitRoots
+  {
+    double c[R], sn[R];
+    unitRoots()
+    {
+      for (int j = 0; j < R; j++)
+        {
+          cplx w = root(j, R, 1);
+          c[j] = w.real();
+          sn[j] = w.imag();
+        }
+    }
+    static const unitRoots& get()
+    {
+      static const unitRoots roots;
+      return roots;
+    }
+  };
+
+  /** Odd prime radix, pairing inputs j and R-j to halve the multiplies. */
+  template<int R, class V>
+  struct butterflies
+  {
+    static int run(int a_q, int s, int m, const cplx* x0, cplx* y0, const cplx* tw, int sign)
+    {
+      const int H = (R - 1) / 2;
+      const double* c = unitRoots<R>::get().c;
+      const double* sn = unitRoots<R>::get().sn;
+      typename V::tw tws[R];
+      for (int k = 0; k < R; k++) tws[k] = typename V::tw(tw[k]);
+      int q = a_q;
+      for (; q + V::width <= s; q += V::width)
+        {
+          V a0 = V::load(x0 + q);
+          V sum[H + 1], dif[H + 1];
+          V dc = a0;
+          for (int j = 1; j <= H; j++)
+            {
+              V aj = V::load(x0 + q + s*j*m);
+              V ar = V::load(x0 + q + s*(R - j)*m);
+              sum[j] = aj + ar;
+              dif[j] = aj - ar;
+              dc = dc + sum[j];
+            }
+          dc.store(y0 + q);
+          for (int k = 1; k <= H; k++)
+            {
+              V re = a0, im = V::zero();
+              for (int j = 1; j <= H; j++)
+                {
+                  int jk = (j*k) % R;
+                  re = re + c[jk] * sum[j];
+                  im = im + sn[jk] * dif[j];
+                }
+              im = mulI(im, sign);
+              cmul(re + im, tws[k]).store(y0 + q + s*k);
+              cmul(re - im, tws[R - k]).store(y0 + q + s*(R - k));
+            }
+        }
+      return q;
+    }
+  };
+
+  template<int R>
+  inline void stage(int m, int s, const cplx* x, cplx* y, const cplx* tw, int sign)
+  {
+    for (int p = 0; p < m; p++)
+      {
+        const cplx* x0 = x + s*p;
+        cplx* y0 = y + s*(R*p);
+        const cplx* twp = tw + R*p;
+        int q = butterflies<R, cvecN>::run(0, s, m, x0, y0, twp, sign);
+        if (q < s) butterflies<R, cvec1>::run(q, s, m, x0, y0, twp, sign);
+      }
+  }
+
+  class plan1d;
+
+  inline std::shared_ptr<const plan1d> getPlan(int a_n);
+
+  /** Plan for a 1D complex DFT of one size. */
+  class plan1d
+  {
+  public:
+    explicit plan1d(int a_n);
+
+    int size() const { return m_n; }
+
+    /** Number of cplx entries needed in the a_work argument of execute(). */
+    size_t workSize() const { return m_bluestein ? 2*m_m : m_n; }
+
+    /** In-place transform of a_data[0 .. n-1]. */
+    void execute(cplx* a_data, cplx* a_work, int a_sign) const;
+
+  private:
+    int m_n;
+    std::vector<int> m_radices;
+    std::vector<cplx> m_twiddles[2]; // [0] for sign -1, [1] for sign +1
+
+    // Bluestein, for sizes with a prime factor larger than 7.
+    bool m_bluestein;
+    int m_m;
+    std::shared_ptr<const plan1d> m_sub;
+    std::vector<cplx> m_chirp[2];
+    std::vector<cplx> m_chirpFFT[2];
+  };
+
+  inline plan1d::plan1d(int a_n)
+  {
+    m_n = a_n;
+    m_bluestein = false;
+    m_m = 0;
+    int rem = a_n;
+    const int radices[] = {4, 2, 3, 5, 7};
+    for (int r : radices)
+      {
+        while (rem % r == 0) { m_radices.push_back(r); rem /= r; }
+      }
+    if (rem != 1)
+      {
+        m_radices.clear();
+        m_bluestein = true;
+        m_m = 1;
+        while (m_m < 2*a_n - 1) m_m *= 2;
+        m_sub = getPlan(m_m);
+        std::vector<cplx> work(m_sub->workSize());
+        for (int d = 0; d < 2; d++)
+          {
+            int sign = 2*d - 1;
+            m_chirp[d].resize(a_n);
+            for (long long k = 0; k < a_n; k++)
+              {
+                // exp(sign pi i k^2 / n)
+                m_chirp[d][k] = root(k*k, 2*(long long) a_n, sign);
+              }
+            std::vector<cplx>& b = m_chirpFFT[d];
+            b.assign(m_m, cplx(0., 0.));
+            for (int k = 0; k < a_n; k++)
+              {
+                b[k] = std::conj(m_chirp[d][k]) / (m_m * 1.);
+                if (k > 0) b[m_m - k] = b[k];
+              }
+            m_sub->execute(b.data(), work.data(), -1);
+          }
+        return;
+      }
+    for (int d = 0; d < 2; d++)
+      {
+        int sign = 2*d - 1;
+        int l = a_n;
+        for (int r : m_radices)
+          {
+            int m = l / r;
+            for (int p = 0; p < m; p++)
+              for (int k = 0; k < r; k++)
+                {
+                  m_twiddles[d].push_back(root(p*(long long) k, l, sign));
+                }
+            l = m;
+          }
+      }
+  }
+
+  inline void plan1d::execute(cplx* a_data, cplx* a_work, int a_sign) const
+  {
+    int d = (a_sign < 0) ? 0 : 1;
+    if (m_bluestein)
+      {
+        cplx* a = a_work;
+        const std::vector<cplx>& chirp = m_chirp[d];
+        for (int k = 0; k < m_n; k++) a[k] = cmul(a_data[k], chirp[k]);
+        std::fill(a + m_n, a + m_m, cplx(0., 0.));
+        m_sub->execute(a, a_work + m_m, -1);
+        const std::vector<cplx>& b = m_chirpFFT[d];
+        for (int k = 0; k < m_m; k++) a[k] = cmul(a[k], b[k]);
+        m_sub->execute(a, a_work + m_m, 1);
+        for (int k = 0; k < m_n; k++) a_data[k] = cmul(a[k], chirp[k]);
+        return;
+      }
+    cplx* x = a_data;
+    cplx* y = a_work;
+    const cplx* tw = m_twiddles[d].data();
+    int l = m_n;
+    int s = 1;
+    for (int r : m_radices)
+      {
+        int m = l / r;
+        switch (r)
+          {
+          case 2: stage<2>(m, s, x, y, tw, a_sign); break;
+          case 3: stage<3>(m, s, x, y, tw, a_sign); break;
+          case 4: stage<4>(m, s, x, y, tw, a_sign); break;
+          case 5: stage<5>(m, s, x, y, tw, a_sign); break;
+          case 7: stage<7>(m, s, x, y, tw, a_sign); break;
+          }
+        tw += m*r;
+        std::swap(x, y);
+        l = m;
+        s *= r;
+      }
+    if (x != a_data) std::copy(x, x + m_n, a_data);
+  }
+
+  /**
+     Shared plan of type PLAN for size a_n, built on first use; safe to call
+     from several threads.  Each plan type has its own cache.
+  */
+  template<class PLAN>
+  inline std::shared_ptr<const PLAN> getCachedPlan(int a_n)
+  {
+    static std::mutex plansMutex;
+    static std::map<int, std::shared_ptr<const PLAN>> plans;
+    {
+      std::lock_guard<std::mutex> lock(plansMutex);
+      auto found = plans.find(a_n);
+      if (found != plans.end()) return found->second;
+    }
+    // Build outside the lock: a plan may ask for other plans.
+    std::shared_ptr<const PLAN> built = std::make_shared<PLAN>(a_n);
+    std::lock_guard<std::mutex> lock(plansMutex);
+    return plans.insert(std::make_pair(a_n, built)).first->second;
+  }
+
+  inline std::shared_ptr<const plan1d> getPlan(int a_n)
+  {
+    return getCachedPlan<plan1d>(a_n);
+  }
+
+  /**
+     a_out[c*a_rows + r] = a_in[r*a_cols + c]: transpose of a row-major
+     a_rows x a_cols matrix, in square tiles so that both the reads and the
+     writes stay within a few cache lines, with rows of tiles on separate
+     threads.
+  */
+  inline void transpose(const cplx* a_in, cplx* a_out, size_t a_rows, size_t a_cols)
+  {
+    const size_t TILE = 32;
+    size_t rowTiles = (a_rows + TILE - 1) / TILE;
+    parallelFor(rowTiles, TILE * a_cols,
+                [&](size_t begin, size_t end)
+                {
+                  for (size_t rt = begin; rt < end; rt++)
+                    {
+                      size_t r0 = rt * TILE;
+                      size_t r1 = std::min(r0 + TILE, a_rows);
+                      for (size_t c0 = 0; c0 < a_cols; c0 += TILE)
+                        {
+                          size_t c1 = std::min(c0 + TILE, a_cols);
+                          for (size_t r = r0; r < r1; r++)
+                            for (size_t c = c0; c < c1; c++)
+                              {
+                                a_out[c*a_rows + r] = a_in[r*a_cols + c];
+                              }
+                        }
+                    }
+                });
+  }
+
+  /**
+     Addressing of the lines along axis a_axis of an array of extents
+     a_e[0 .. a_dim-1]: the packed row-major array, or with a_stride a view
+     whose element strides along the axes are a_stride[0 .. a_dim-1] (the
+     interior of an array with ghost cells, say).  Line (o, i) is the one
+     at the o-th point of the axes before a_axis and the i-th of the axes
+     after it, in row-major order.
+  */
+  class lineAccess
+  {
+  public:
+    lineAccess(int a_dim, const int* a_e, int a_axis, const size_t* a_stride = nullptr)
+      : m_e(a_e, a_e + a_dim), m_axis(a_axis), m_stride(a_stride)
+    {
+      m_inner = 1;
+      for (int d = a_axis + 1; d < a_dim; d++) m_inner *= a_e[d];
+    }
+
+    /** Offset of the first point of line (a_outer, a_inner). */
+    size_t line(size_t a_outer, size_t a_inner) const
+    {
+      if (m_stride == nullptr) return a_outer * m_e[m_axis] * m_inner + a_inner;
+      return offset(a_outer, 0, m_axis) + offset(a_inner, m_axis + 1, m_e.size());
+    }
+
+    /** Distance between the points of a line. */
+    size_t step() const { return (m_stride == nullptr) ? m_inner : m_stride[m_axis]; }
+
+  private:
+    size_t offset(size_t a_idx, int a_lo, int a_hi) const
+    {
+      size_t off = 0;
+      for (int d = a_hi - 1; d >= a_lo; d--)
+        {
+          off += (a_idx % m_e[d]) * m_stride[d];
+          a_idx /= m_e[d];
+        }
+      return off;
+    }
+
+    std::vector<int> m_e;
+    int m_axis;
+    const size_t* m_stride;
+    size_t m_inner;
+  };
+
+  /**
+     a_out = a_in, arrays of extents a_n[0 .. a_dim-1] with element strides
+     a_outStride and a_inStride (nullptr: packed row-major).
+  */
+  template<typename T>
+  inline void copyStrided(int a_dim, const int* a_n, T* a_out, const size_t* a_outStride,
+                          const T* a_in, const size_t* a_inStride)
+  {
+    lineAccess out(a_dim, a_n, a_dim - 1, a_outStride);
+    lineAccess in(a_dim, a_n, a_dim - 1, a_inStride);
+    const int len = a_n[a_dim - 1];
+    size_t rows = 1;
+    for (int d = 0; d < a_dim - 1; d++) rows *= a_n[d];
+    parallelFor(rows, len,
+                [&](size_t begin, size_t end)
+                {
+                  for (size_t r = begin; r < end; r++)
+                    {
+                      T* o = a_out + out.line(r, 0);
+                      const T* i = a_in + in.line(r, 0);
+                      for (int l = 0; l < len; l++)
+                        {
+                          o[l*out.step()] = i[l*in.step()];
+                        }
+                    }
+                });
+  }
+
+  /**
+     Transform a row-major array of extents a_n[0 .. a_dim-1] (last index
+     fastest) in place along axis a_axis; a_stride gives the element strides
+     of a strided view (lineAccess).  Lines along the axis are gathered in
+     blocks of adjacent lines, so strided reads touch whole cache lines.
+  */
+  inline void transformAxis(cplx* a_data, int a_dim, const int* a_n, int a_axis, int a_sign,
+                            const size_t* a_stride = nullptr)
+  {
+    const int len = a_n[a_axis];
+    if (len == 1) return;
+    size_t outer = 1, inner = 1;
+    for (int d = 0; d < a_axis; d++) outer *= a_n[d];
+    for (int d = a_axis + 1; d < a_dim; d++) inner *= a_n[d];
+    lineAccess access(a_dim, a_n, a_axis, a_stride);
+    const size_t step = access.step();
+    std::shared_ptr<const plan1d> plan = getPlan(len);
+    const size_t BLOCK = 8;
+    size_t blocks = (inner + BLOCK - 1) / BLOCK;
+    parallelFor(outer * blocks, len * BLOCK,
+                [&](size_t begin, size_t end)
+                {
+                  std::vector<cplx> line(BLOCK * len);
+                  std::vector<cplx> work(plan->workSize());
+                  size_t off[BLOCK];
+                  for (size_t item = begin; item < end; item++)
+                    {
+                      size_t i0 = (item % blocks) * BLOCK;
+                      size_t nb = std::min(BLOCK, inner - i0);
+                      for (size_t b = 0; b < nb; b++)
+                        {
+                          off[b] = access.line(item / blocks, i0 + b);
+                        }
+                      if (inner == 1 && step == 1)
+                        {
+                          plan->execute(a_data + off[0], work.data(), a_sign);
+                          continue;
+                        }
+                      for (int l = 0; l < len; l++)
+                        for (size_t b = 0; b < nb; b++)
+                          {
+                            line[b*len + l] = a_data[off[b] + l*step];
+                          }
+                      for (size_t b = 0; b < nb; b++)
+                        {
+                          plan->execute(&line[b*len], work.data(), a_sign);
+                        }
+                      for (int l = 0; l < len; l++)
+                        for (size_t b = 0; b < nb; b++)
+                          {
+                            a_data[off[b] + l*step] = line[b*len + l];
+                          }
+                    }
+                });
+  }
+
+  /**
+     Multidimensional complex DFT of a row-major array of extents
+     a_n[0 .. a_dim-1]; a_out may be the same as a_in.
+  */
+  inline void mddft(int a_dim, const int* a_n, cplx* a_out, const cplx* a_in, int a_sign)
+  {
+    size_t npts = 1;
+    for (int d = 0; d < a_dim; d++) npts *= a_n[d];
+    if (a_out != a_in) std::copy(a_in, a_in + npts, a_out);
+    for (int d = a_dim - 1; d >= 0; d--)
+      {
+        transformAxis(a_out, a_dim, a_n, d, a_sign);
+      }
+  }
+
+  /**
+     mddft of strided views (lineAccess) with element strides a_outStride
+     and a_inStride, either nullptr for a packed array: the points outside
+     the views, such as ghost cells, are neither read nor written.
+  */
+  inline void mddft(int a_dim, const int* a_n, cplx* a_out, const size_t* a_outStride,
+                    const cplx* a_in, const size_t* a_inStride, int a_sign)
+  {
+    if (a_out != a_in) copyStrided(a_dim, a_n, a_out, a_outStride, a_in, a_inStride);
+    for (int d = a_dim - 1; d >= 0; d--)
+      {
+        transformAxis(a_out, a_dim, a_n, d, a_sign, a_outStride);
+      }
+  }
+
+  /**
+     Complex array whose point i has real part re[i*pitch] and imaginary part
+     im[i*pitch]: a split-complex (planar) array has separate re and im and
+     pitch 1; an interleaved cplx array is splitArray(data), im = re + 1 and
+     pitch 2.
+  */
+  struct splitArray
+  {
+    double* re;
+    double* im;
+    size_t pitch;
+
+    splitArray(double* a_re, double* a_im, size_t a_pitch = 1)
+      : re(a_re), im(a_im), pitch(a_pitch) { }
+    explicit splitArray(cplx* a_data)
+      : re((double*)a_data), im((double*)a_data + 1), pitch(2) { }
+
+    cplx get(size_t a_i) const { return cplx(re[a_i*pitch], im[a_i*pitch]); }
+    void set(size_t a_i, const cplx& a_v) const
+    {
+      re[a_i*pitch] = a_v.real();
+      im[a_i*pitch] = a_v.imag();
+    }
+
+    /** The array from point a_points on. */
+    splitArray operator+(size_t a_points) const
+    {
+      return splitArray(re + a_points*pitch, im + a_points*pitch, pitch);
+    }
+  };
+
+  /** a_out[i] = a_in[i] for a_count points. */
+  inline void copySplit(splitArray a_out, splitArray a_in, size_t a_count)
+  {
+    parallelFor(a_count, 2,
+                [&](size_t begin, size_t end)
+                {
+                  for (size_t i = begin; i < end; i++)
+                    {
+                      a_out.set(i, a_in.get(i));
+                    }
+                });
+  }
+
+  /**
+     transformAxis of the packed row-major array a_in of extents a_n into
+     a_out (which may be a_in), either one split or interleaved: each block
+     of lines is gathered from the planes of a_in and scattered to those of
+     a_out, so neither is converted as a whole.
+  */
+  inline void transformAxisSplit(splitArray a_out, splitArray a_in,
+                                 int a_dim, const int* a_n, int a_axis, int a_sign)
+  {
+    const int len = a_n[a_axis];
+    size_t outer = 1, inner = 1;
+    for (int d = 0; d < a_axis; d++) outer *= a_n[d];
+    for (int d = a_axis + 1; d < a_dim; d++) inner *= a_n[d];
+    std::shared_ptr<const plan1d> plan = (len > 1) ? getPlan(len) : nullptr;
+    const size_t BLOCK = 8;
+    size_t blocks = (inner + BLOCK - 1) / BLOCK;
+    parallelFor(outer * blocks, len * BLOCK,
+                [&](size_t begin, size_t end)
+                {
+                  std::vector<cplx> line(BLOCK * len);
+                  std::vector<cplx> work(plan ? plan->workSize() : 0);
+                  for (size_t item = begin; item < end; item++)
+                    {
+                      size_t i0 = (item % blocks) * BLOCK;
+                      size_t nb = std::min(BLOCK, inner - i0);
+                      size_t base = (item / blocks) * len * inner + i0;
+                      for (int l = 0; l < len; l++)
+                        for (size_t b = 0; b < nb; b++)
+                          {
+                            line[b*len + l] = a_in.get(base + l*inner + b);
+                          }
+                      if (plan)
+                        for (size_t b = 0; b < nb; b++)
+                          {
+                            plan->execute(&line[b*len], work.data(), a_sign);
+                          }
+                      for (int l = 0; l < len; l++)
+                        for (size_t b = 0; b < nb; b++)
+                          {
+                            a_out.set(base + l*inner + b, line[b*len + l]);
+                          }
+                    }
+                });
+  }
+
+  /**
+     mddft of split-complex arrays (splitArray), a_out may be a_in: the
+     first pass reads the planes of a_in and every pass writes those of
+     a_out, without an interleaved copy of either.
+  */
+  inline void mddft(int a_dim, const int* a_n, splitArray a_out, splitArray a_in, int a_sign)
+  {
+    for (int d = a_dim - 1; d >= 0; d--)
+      {
+        transformAxisSplit(a_out, (d == a_dim - 1) ? a_in : a_out, a_dim, a_n, d, a_sign);
+      }
+  }
+
+  /**
+     Plan for a 1D real-to-complex (forward) and complex-to-real (inverse)
+     DFT of size n, with n/2+1 complex coefficients.  Even sizes pack the n
+     reals into an n/2-point complex FFT and separate the even and odd
+     halves with a twiddle pass; odd sizes use an n-point complex FFT.
+  */
+  class rplan1d
+  {
+  public:
+    explicit rplan1d(int a_n);
+
+    int size() const { return m_n; }
+
+    /** Number of cplx entries needed in the a_work argument. */
+    size_t workSize() const { return m_sub->size() + m_sub->workSize(); }
+
+    /** a_out[0 .. n/2] = sum_j a_in[j] exp(-2 pi i j k / n). */
+    void forward(const double* a_in, cplx* a_out, cplx* a_work) const;
+
+    /**
+       a_out[j] = sum_k a_in[k] exp(2 pi i j k / n), a_in Hermitian, k over
+       0 .. n-1; the imaginary parts of a_in[0] and (n even) a_in[n/2] are
+       ignored, so a_out is the real part of the sum for any a_in.
+    */
+    void inverse(const cplx* a_in, double* a_out, cplx* a_work) const;
+
+  private:
+    int m_n;
+    bool m_even;
+    std::shared_ptr<const plan1d> m_sub; // size n/2 if n even, n if odd
+    std::vector<cplx> m_twiddles;        // exp(-2 pi i k / n), k <= n/2
+  };
+
+  inline rplan1d::rplan1d(int a_n)
+  {
+    m_n = a_n;
+    m_even = (a_n % 2 == 0);
+    m_sub = getPlan(m_even ? a_n/2 : a_n);
+    if (m_even)
+      {
+        m_twiddles.resize(a_n/2 + 1);
+        for (int k = 0; k <= a_n/2; k++) m_twiddles[k] = root(k, a_n, -1);
+      }
+  }
+
+  inline void rplan1d::forward(const double* a_in, cplx* a_out, cplx* a_work) const
+  {
+    cplx* z = a_work;
+    if (!m_even)
+      {
+        for (int j = 0; j < m_n; j++) z[j] = cplx(a_in[j], 0.);
+        m_sub->execute(z, a_work + m_n, -1);
+        std::copy(z, z + m_n/2 + 1, a_out);
+        return;
+      }
+    int half = m_n/2;
+    for (int j = 0; j < half; j++) z[j] = cplx(a_in[2*j], a_in[2*j+1]);
+    m_sub->execute(z, a_work + half, -1);
+    // z = E + i O, with E and O the DFTs of the even and odd samples.
+    for (int k = 0; k <= half; k++)
+      {
+        cplx zk = z[k % half];
+        cplx zc = std::conj(z[(half - k) % half]);
+        cplx ek = 0.5 * (zk + zc);
+        cplx ok = mulI(0.5 * (zk - zc), -1);
+        a_out[k] = ek + cmul(m_twiddles[k], ok);
+      }
+  }
+
+  inline void rplan1d::inverse(const cplx* a_in, double* a_out, cplx* a_work) const
+  {
+    cplx* z = a_work;
+    if (!m_even)
+      {
+        z[0] = a_in[0];
+        for (int k = 1; k <= m_n/2; k++)
+          {
+            z[k] = a_in[k];
+            z[m_n - k] = std::conj(a_in[k]);
+          }
+        m_sub->execute(z, a_work + m_n, 1);
+        for (int j = 0; j < m_n; j++) a_out[j] = z[j].real();
+        return;
+      }
+    int half = m_n/2;
+    for (int k = 0; k < half; k++)
+      {
+        cplx xk = k ? a_in[k] : cplx(a_in[0].real(), 0.);
+        cplx xc = k ? std::conj(a_in[half - k]) : cplx(a_in[half].real(), 0.);
+        z[k] = (xk + xc) + mulI(cmul(xk - xc, std::conj(m_twiddles[k])), 1);
+      }
+    m_sub->execute(z, a_work + half, 1);
+    for (int j = 0; j < half; j++)
+      {
+        a_out[2*j] = z[j].real();
+        a_out[2*j+1] = z[j].imag();
+      }
+  }
+
+  inline std::shared_ptr<const rplan1d> getRealPlan(int a_n)
+  {
+    return getCachedPlan<rplan1d>(a_n);
+  }
+
+  /**
+     Real-to-real transforms, as the unscaled SPIRAL matrices DCT1 .. DST3
+     of size n (j the input index, k the output index):
+
+       DCT1  cos(pi j k / (n-1))        DST1  sin(pi (j+1) (k+1) / (n+1))
+       DCT2  cos(pi (2j+1) k / (2n))    DST2  sin(pi (2j+1) (k+1) / (2n))
+       DCT3  cos(pi j (2k+1) / (2n))    DST3  sin(pi (j+1) (2k+1) / (2n))
+
+     DCT3 and DST3 are the transposes of DCT2 and DST2; DCT1 of size 1 is
+     the identity.
+  */
+  enum r2rKind { R2R_DCT1 = 0, R2R_DCT2 = 1, R2R_DCT3 = 2, R2R_DST1 = 3, R2R_DST2 = 4, R2R_DST3 = 5 };
+
+  /**
+     Plan for the 1D real-to-real transforms of one size, all kinds.  DCT2
+     and DCT3 run an n-point complex FFT on the even/odd reordered line
+     (Makhoul), and DST2 and DST3 reduce to them by sign flips and
+     reversal; DCT1 and DST1 run a real FFT of the even or odd extension,
+     of length 2(n-1) or 2(n+1).
+  */
+  class r2rplan1d
+  {
+  public:
+    explicit r2rplan1d(int a_n);
+
+    int size() const { return m_n; }
+
+    /** Number of cplx entries needed in the a_work argument. */
+    size_t workSize() const { return m_work; }
+
+    /** a_out = kind(a_in); a_out may be the same as a_in. */
+    void execute(const double* a_in, double* a_out, r2rKind a_kind, cplx* a_work) const;
+
+  private:
+    int m_n;
+    size_t m_work;
+    std::shared_ptr<const plan1d> m_sub;    // size n
+    std::shared_ptr<const rplan1d> m_even;  // size 2(n-1), if n > 1
+    std::shared_ptr<const rplan1d> m_odd;   // size 2(n+1)
+    std::vector<cplx> m_twiddles;           // exp(-pi i k / (2n)), k < n
+
+    void dct2(const double* a_in, double* a_out, cplx* a_work) const;
+    void dct3(const double* a_in, double* a_out, cplx* a_work) const;
+    void extended(const double* a_in, double* a_out, bool a_odd, cplx* a_work) const;
+  };
+
+  inline r2rplan1d::r2rplan1d(int a_n)
+  {
+    m_n = a_n;
+    m_sub = getPlan(a_n);
+    m_odd = getRealPlan(2*(a_n + 1));
+    m_twiddles.resize(a_n);
+    for (int k = 0; k < a_n; k++) m_twiddles[k] = root(k, 4*a_n, -1);
+    // a line of n doubles, the n-point line and the FFT work
+    m_work = a_n + a_n + m_sub->workSize();
+    // the extension (as doubles), its spectrum and the real FFT work
+    m_work = std::max(m_work, (size_t)(a_n + 2) + (a_n + 2) + m_odd->workSize());
+    if (a_n > 1)
+      {
+        m_even = getRealPlan(2*(a_n - 1));
+        m_work = std::max(m_work, (size_t)a_n + a_n + m_even->workSize());
+      }
+  }
+
+  inline void r2rplan1d::dct2(const double* a_in, double* a_out, cplx* a_work) const
+  {
+    cplx* z = a_work;
+    for (int j = 0; 2*j < m_n; j++) z[j] = cplx(a_in[2*j], 0.);
+    for (int j = 0; 2*j + 1 < m_n; j++) z[m_n - 1 - j] = cplx(a_in[2*j + 1], 0.);
+    m_sub->execute(z, a_work + m_n, -1);
+    for (int k = 0; k < m_n; k++) a_out[k] = cmul(m_twiddles[k], z[k]).real();
+  }
+
+  inline void r2rplan1d::dct3(const double* a_in, double* a_out, cplx* a_work) const
+  {
+    cplx* z = a_work;
+    double x0 = a_in[0];
+    z[0] = cplx(x0, 0.);
+    for (int k = 1; k < m_n; k++)
+      {
+        z[k] = cmul(std::conj(m_twiddles[k]), cplx(a_in[k], -a_in[m_n - k]));
+      }
+    m_sub->execute(z, a_work + m_n, 1);
+    // z now holds twice the DCT2 preimage with the first term counted twice
+    for (int j = 0; 2*j < m_n; j++) a_out[2*j] = 0.5 * (z[j].real() + x0);
+    for (int j = 0; 2*j + 1 < m_n; j++) a_out[2*j + 1] = 0.5 * (z[m_n - 1 - j].real() + x0);
+  }
+
+  inline void r2rplan1d::extended(const double* a_in, double* a_out, bool a_odd, cplx* a_work) const
+  {
+    const rplan1d& plan = a_odd ? *m_odd : *m_even;
+    int len = plan.size();
+    cplx* spec = a_work;
+    double* ext = (double*)(a_work + len/2 + 1);
+    cplx* work = a_work + len/2 + 1 + (len + 1)/2;
+    if (a_odd)
+      {
+        ext[0] = 0.;
+        ext[m_n + 1] = 0.;
+        for (int j = 0; j < m_n; j++)
+          {
+            ext[j + 1] = a_in[j];
+            ext[len - 1 - j] = -a_in[j];
+          }
+      }
+    else
+      {
+        for (int j = 0; j < m_n; j++) ext[j] = a_in[j];
+        for (int j = 1; j < m_n - 1; j++) ext[len - j] = a_in[j];
+      }
+    plan.forward(ext, spec, work);
+    if (a_odd)
+      {
+        for (int k = 0; k < m_n; k++) a_out[k] = -0.5 * spec[k + 1].imag();
+      }
+    else
+      {
+        double first = ext[0], last = ext[m_n - 1];
+        for (int k = 0; k < m_n; k++)
+          {
+            a_out[k] = 0.5 * (spec[k].real() + first + ((k % 2) ? -last : last));
+          }
+      }
+  }
+
+  inline void r2rplan1d::execute(const double* a_in, double* a_out, r2rKind a_kind,
+                                 cplx* a_work) const
+  {
+    double* line = (double*)(a_work + m_n + m_sub->workSize());
+    switch (a_kind)
+      {
+      case R2R_DCT1:
+        if (m_n == 1)
+          a_out[0] = a_in[0];
+        else
+          extended(a_in, a_out, false, a_work);
+        break;
+      case R2R_DST1:
+        extended(a_in, a_out, true, a_work);
+        break;
+      case R2R_DCT2:
+        dct2(a_in, a_out, a_work);
+        break;
+      case R2R_DCT3:
+        dct3(a_in, a_out, a_work);
+        break;
+      case R2R_DST2:
+        // DST2(x)_k = DCT2((-1)^j x_j)_{n-1-k}
+        for (int j = 0; j < m_n; j++) line[j] = (j % 2) ? -a_in[j] : a_in[j];
+        dct2(line, line, a_work);
+        for (int k = 0; k < m_n; k++) a_out[k] = line[m_n - 1 - k];
+        break;
+      case R2R_DST3:
+        // DST3(x)_k = (-1)^k DCT3(x reversed)_k
+        for (int j = 0; j < m_n; j++) line[j] = a_in[m_n - 1 - j];
+        dct3(line, a_out, a_work);
+        for (int k = 1; k < m_n; k += 2) a_out[k] = -a_out[k];
+        break;
+      }
+  }
+
+  inline std::shared_ptr<const r2rplan1d> getR2RPlan(int a_n)
+  {
+    return getCachedPlan<r2rplan1d>(a_n);
+  }
+
+  /**
+     Batch of a_batch 1D DFTs of length a_n, with the read and write
+     layouts of BATCH1DDFTProblem: 0 (APar) for lines stored one after
+     another, [a_batch][a_n], and 1 (AVec) for lines interleaved, [a_n][a_batch].
+  */
+  inline void batchdft(int a_n, int a_batch, int a_read, int a_write,
+                       cplx* a_out, const cplx* a_in, int a_sign)
+  {
+    int ext[2] = {a_batch, a_n};
+    int axis = 1;
+    if (a_read != 0)
+      {
+        ext[0] = a_n;
+        ext[1] = a_batch;
+        axis = 0;
+      }
+    size_t npts = (size_t) a_n * a_batch;
+    if (a_read == a_write)
+      {
+        if (a_out != a_in) std::copy(a_in, a_in + npts, a_out);
+        transformAxis(a_out, 2, ext, axis, a_sign);
+      }
+    else
+      {
+        std::vector<cplx> temp(a_in, a_in + npts);
+        transformAxis(temp.data(), 2, ext, axis, a_sign);
+        transpose(temp.data(), a_out, ext[0], ext[1]);
+      }
+  }
+
+  /**
+     Complex pass along axis a_axis, out of place: a_in has extents a_e, and
+     each of its lines is zero-padded to a_len, transformed, and cut to its
+     entries a_outLo .. a_outLo+a_outLen-1 in a_out (extents a_e except
+     a_outLen along a_axis).  Only the lines of a_in are transformed, so a
+     pass over a zero-embedded array skips the lines that are known to be
+     zero, and only the kept entries are stored.  Kept entries past a_len
+     throw std::out_of_range.
+  */
+  inline void transformAxisPadded(const cplx* a_in, cplx* a_out, int a_dim, const int* a_e,
+                                  int a_axis, int a_len, int a_outLen, int a_sign,
+                                  int a_outLo = 0)
+  {
+    const int inLen = a_e[a_axis];
+    if (a_outLo < 0 || a_outLo + a_outLen > a_len || inLen > a_len)
+      throw std::out_of_range("fftx_native::transformAxisPadded: entries outside the line");
+    size_t outer = 1, inner = 1;
+    for (int d = 0; d < a_axis; d++) outer *= a_e[d];
+    for (int d = a_axis + 1; d < a_dim; d++) inner *= a_e[d];
+    std::shared_ptr<const plan1d> plan = getPlan(a_len);
+    const size_t BLOCK = 8;
+    size_t blocks = (inner + BLOCK - 1) / BLOCK;
+    parallelFor(outer * blocks, a_len * BLOCK,
+                [&](size_t begin, size_t end)
+                {
+                  std::vector<cplx> line(BLOCK * a_len);
+                  std::vector<cplx> work(plan->workSize());
+                  for (size_t item = begin; item < end; item++)
+                    {
+                      const cplx* ibase = a_in + (item / blocks) * inLen * inner;
+                      cplx* obase = a_out + (item / blocks) * a_outLen * inner;
+                      size_t i0 = (item % blocks) * BLOCK;
+                      size_t nb = std::min(BLOCK, inner - i0);
+                      for (size_t b = 0; b < nb; b++)
+                        {
+                          std::fill(&line[b*a_len] + inLen, &line[b*a_len] + a_len, cplx(0.));
+                        }
+                      for (int l = 0; l < inLen; l++)
+                        for (size_t b = 0; b < nb; b++)
+                          {
+                            line[b*a_len + l] = ibase[l*inner + i0 + b];
+                          }
+                      for (size_t b = 0; b < nb; b++)
+                        {
+                          plan->execute(&line[b*a_len], work.data(), a_sign);
+                        }
+                      for (int l = 0; l < a_outLen; l++)
+                        for (size_t b = 0; b < nb; b++)
+                          {
+                            obase[l*inner + i0 + b] = line[b*a_len + a_outLo + l];
+                          }
+                    }
+                });
+  }
+
+  /**
+     Real-to-complex pass along axis a_axis of a row-major real array of
+     extents a_e, each line zero-padded to a_len before the transform;
+     a_out has the same extents except a_outLen along a_axis, the entries
+     a_outLo .. a_outLo+a_outLen-1 of the a_len/2+1 of each line (all of
+     them by default), which must lie in the half line (std::out_of_range
+     otherwise).  a_inStride and a_outStride give the element strides of
+     strided views (lineAccess).
+  */
+  inline void realForwardAxisPadded(const double* a_in, cplx* a_out,
+                                    int a_dim, const int* a_e, int a_axis, int a_len,
+                                    int a_outLo = 0, int a_outLen = -1,
+                                    const size_t* a_inStride = nullptr,
+                                    const size_t* a_outStride = nullptr)
+  {
+    const int inLen = a_e[a_axis];
+    const int h = a_len/2 + 1;
+    const int outLen = (a_outLen < 0) ? h : a_outLen;
+    if (a_outLo < 0 || a_outLo + outLen > h || inLen > a_len)
+      throw std::out_of_range("fftx_native::realForwardAxisPadded: entries outside the half line");
+    size_t outer = 1, inner = 1;
+    for (int d = 0; d < a_axis; d++) outer *= a_e[d];
+    for (int d = a_axis + 1; d < a_dim; d++) inner *= a_e[d];
+    std::vector<int> oe(a_e, a_e + a_dim);
+    oe[a_axis] = outLen;
+    lineAccess rin(a_dim, a_e, a_axis, a_inStride), cacc(a_dim, oe.data(), a_axis, a_outStride);
+    const size_t rstep = rin.step(), cstep = cacc.step();
+    std::shared_ptr<const rplan1d> plan = getRealPlan(a_len);
+    const size_t BLOCK = 8;
+    size_t blocks = (inner + BLOCK - 1) / BLOCK;
+    parallelFor(outer * blocks, a_len * BLOCK,
+                [&](size_t begin, size_t end)
+                {
+                  std::vector<double> rline(BLOCK * a_len); // the padding stays zero
+                  std::vector<cplx> cline(BLOCK * h);
+                  std::vector<cplx> work(plan->workSize());
+                  size_t roff[BLOCK], coff[BLOCK];
+                  for (size_t item = begin; item < end; item++)
+                    {
+                      size_t i0 = (item % blocks) * BLOCK;
+                      size_t nb = std::min(BLOCK, inner - i0);
+                      for (size_t b = 0; b < nb; b++)
+                        {
+                          roff[b] = rin.line(item / blocks, i0 + b);
+                          coff[b] = cacc.line(item / blocks, i0 + b);
+                        }
+                      for (int l = 0; l < inLen; l++)
+                        for (size_t b = 0; b < nb; b++)
+                          {
+                            rline[b*a_len + l] = a_in[roff[b] + l*rstep];
+                          }
+                      for (size_t b = 0; b < nb; b++)
+                        {
+                          plan->forward(&rline[b*a_len], &cline[b*h], work.data());
+                        }
+                      for (int k = 0; k < outLen; k++)
+                        for (size_t b = 0; b < nb; b++)
+                          {
+                            a_out[coff[b] + k*cstep] = cline[b*h + a_outLo + k];
+                          }
+                    }
+                });
+  }
+
+  /**
+     Complex-to-real pass along axis a_axis of length a_len, keeping the
+     a_e[a_axis] samples of each line from a_outLo on: a_out is the
+     row-major real array of extents a_e, a_in has the same extents except
+     a_len/2+1 along a_axis.  a_outStride gives the element strides of a
+     strided view (lineAccess).
+  */
+  inline void realInverseAxisTruncated(const cplx* a_in, double* a_out,
+                                       int a_dim, const int* a_e, int a_axis, int a_len,
+                                       int a_outLo = 0, const size_t* a_outStride = nullptr)
+  {
+    const int outLen = a_e[a_axis];
+    const int h = a_len/2 + 1;
+    size_t outer = 1, inner = 1;
+    for (int d = 0; d < a_axis; d++) outer *= a_e[d];
+    for (int d = a_axis + 1; d < a_dim; d++) inner *= a_e[d];
+    lineAccess rout(a_dim, a_e, a_axis, a_outStride);
+    const size_t rstep = rout.step();
+    std::shared_ptr<const rplan1d> plan = getRealPlan(a_len);
+    const size_t BLOCK = 8;
+    size_t blocks = (inner + BLOCK - 1) / BLOCK;
+    parallelFor(outer * blocks, a_len * BLOCK,
+                [&](size_t begin, size_t end)
+                {
+                  std::vector<double> rline(BLOCK * a_len);
+                  std::vector<cplx> cline(BLOCK * h);
+                  std::vector<cplx> work(plan->workSize());
+                  for (size_t item = begin; item < end; item++)
+                    {
+                      const cplx* cbase = a_in + (item / blocks) * h * inner;
+                      size_t i0 = (item % blocks) * BLOCK;
+                      size_t nb = std::min(BLOCK, inner - i0);
+                      for (int k = 0; k < h; k++)
+                        for (size_t b = 0; b < nb; b++)
+                          {
+                            cline[b*h + k] = cbase[k*inner + i0 + b];
+                          }
+                      for (size_t b = 0; b < nb; b++)
+                        {
+                          plan->inverse(&cline[b*h], &rline[b*a_len], work.data());
+                        }
+                      for (size_t b = 0; b < nb; b++)
+                        {
+                          double* rbase = a_out + rout.line(item / blocks, i0 + b);
+                          for (int l = 0; l < outLen; l++)
+                            {
+                              rbase[l*rstep] = rline[b*a_len + a_outLo + l];
+                            }
+                        }
+                    }
+                });
+  }
+
+  /**
+     Real-to-complex pass along axis a_axis of a row-major real array of
+     extents a_n; a_out has the same extents except n/2+1 along a_axis.
+  */
+  inline void realForwardAxis(const double* a_in, cplx* a_out,
+                              int a_dim, const int* a_n, int a_axis)
+  {
+    realForwardAxisPadded(a_in, a_out, a_dim, a_n, a_axis, a_n[a_axis]);
+  }
+
+  /**
+     Complex-to-real pass along axis a_axis: a_in has extents a_n except
+     n/2+1 along a_axis, a_out is the row-major real array of extents a_n.
+  */
+  inline void realInverseAxis(const cplx* a_in, double* a_out,
+                              int a_dim, const int* a_n, int a_axis)
+  {
+    realInverseAxisTruncated(a_in, a_out, a_dim, a_n, a_axis, a_n[a_axis]);
+  }
+
+  /**
+     Fourier resampling pass along axis a_axis: each real line of length
+     n = a_e[a_axis] of the row-major array a_in of extents a_e is replaced
+     by the a_len samples y_j = f((j + a_shift) / a_len) of its band-limited
+     periodic interpolant f, with f(i/n) = x_i.  The forward real FFT, the
+     truncation or zero padding of the spectrum with the shift, and the
+     inverse real FFT of a line are done in one go.  A Nyquist coefficient
+     of the source counts half at +n/2 and half at -n/2, and modes beyond
+     a_len/2 are dropped, so the result is real.
+  */
+  inline void resampleAxis(const double* a_in, double* a_out,
+                           int a_dim, const int* a_e, int a_axis, int a_len, double a_shift)
+  {
+    const int inLen = a_e[a_axis];
+    const int hin = inLen/2 + 1, hout = a_len/2 + 1;
+    size_t outer = 1, inner = 1;
+    for (int d = 0; d < a_axis; d++) outer *= a_e[d];
+    for (int d = a_axis + 1; d < a_dim; d++) inner *= a_e[d];
+    std::shared_ptr<const rplan1d> fwd = getRealPlan(inLen);
+    std::shared_ptr<const rplan1d> inv = getRealPlan(a_len);
+    // factor of each kept coefficient: weight, shift and 1/n normalization
+    std::vector<cplx> factor(hout, cplx(0., 0.));
+    for (int l = 0; l < std::min(hin, hout); l++)
+      {
+        double weight = (inLen % 2 == 0 && 2*l == inLen) ? 0.5 : 1.;
+        factor[l] = std::polar(weight / inLen, 2. * M_PI * l * a_shift / a_len);
+      }
+    const bool nyquist = (a_len % 2 == 0 && hout <= hin);
+    const size_t BLOCK = 8;
+    size_t blocks = (inner + BLOCK - 1) / BLOCK;
+    parallelFor(outer * blocks, (inLen + a_len) * BLOCK,
+                [&](size_t begin, size_t end)
+                {
+                  std::vector<double> rin(BLOCK * inLen), rout(BLOCK * a_len);
+                  std::vector<cplx> spec(std::max(hin, hout));
+                  std::vector<cplx> work(std::max(fwd->workSize(), inv->workSize()));
+                  for (size_t item = begin; item < end; item++)
+                    {
+                      const double* ibase = a_in + (item / blocks) * inLen * inner;
+                      double* obase = a_out + (item / blocks) * a_len * inner;
+                      size_t i0 = (item % blocks) * BLOCK;
+                      size_t nb = std::min(BLOCK, inner - i0);
+                      for (int l = 0; l < inLen; l++)
+                        for (size_t b = 0; b < nb; b++)
+                          {
+                            rin[b*inLen + l] = ibase[l*inner + i0 + b];
+                          }
+                      for (size_t b = 0; b < nb; b++)
+                        {
+                          fwd->forward(&rin[b*inLen], spec.data(), work.data());
+                          for (int l = 0; l < hout; l++) spec[l] *= factor[l];
+                          if (nyquist)
+                            {
+                              // the +m/2 and -m/2 modes both land on the Nyquist sample
+                              spec[hout - 1] = cplx(2. * spec[hout - 1].real(), 0.);
+                            }
+                          inv->inverse(spec.data(), &rout[b*a_len], work.data());
+                        }
+                      for (int l = 0; l < a_len; l++)
+                        for (size_t b = 0; b < nb; b++)
+                          {
+                            obase[l*inner + i0 + b] = rout[b*a_len + l];
+                          }
+                    }
+                });
+  }
+
+  /**
+     Fourier resampling of the row-major real array a_in of extents
+     a_n[0 .. a_dim-1] onto extents a_m, shifted by a_shift[d] destination
+     grid spacings along axis d (see resampleAxis).  The axes that shrink
+     are done first, so no intermediate array is larger than it must be,
+     and neither the full spectrum nor a zero-padded array is formed.
+  */
+  inline void mdresample(int a_dim, const int* a_n, const int* a_m, const double* a_shift,
+                         double* a_out, const double* a_in)
+  {
+    std::vector<int> order(a_dim);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b)
+                     {
+                       return (double)a_m[a] / a_n[a] < (double)a_m[b] / a_n[b];
+                     });
+    std::vector<int> e(a_n, a_n + a_dim);
+    std::vector<double> buffers[2];
+    const double* src = a_in;
+    for (int p = 0; p < a_dim; p++)
+      {
+        int d = order[p];
+        double* dst = a_out;
+        if (p < a_dim - 1)
+          {
+            size_t npts = 1;
+            for (int dd = 0; dd < a_dim; dd++) npts *= (dd == d) ? a_m[dd] : e[dd];
+            buffers[p % 2].resize(npts);
+            dst = buffers[p % 2].data();
+          }
+        resampleAxis(src, dst, a_dim, e.data(), d, a_m[d], a_shift[d]);
+        e[d] = a_m[d];
+        src = dst;
+      }
+  }
+
+  /**
+     Real-to-real pass of kind a_kind along axis a_axis of a row-major array
+     of extents a_n, in place.
+  */
+  inline void r2rAxis(double* a_data, int a_dim, const int* a_n, int a_axis, r2rKind a_kind)
+  {
+    const int len = a_n[a_axis];
+    size_t outer = 1, inner = 1;
+    for (int d = 0; d < a_axis; d++) outer *= a_n[d];
+    for (int d = a_axis + 1; d < a_dim; d++) inner *= a_n[d];
+    std::shared_ptr<const r2rplan1d> plan = getR2RPlan(len);
+    const size_t BLOCK = 8;
+    size_t blocks = (inner + BLOCK - 1) / BLOCK;
+    parallelFor(outer * blocks, len * BLOCK,
+                [&](size_t begin, size_t end)
+                {
+                  std::vector<double> line(BLOCK * len);
+                  std::vector<cplx> work(plan->workSize());
+                  for (size_t item = begin; item < end; item++)
+                    {
+                      double* base = a_data + (item / blocks) * len * inner;
+                      size_t i0 = (item % blocks) * BLOCK;
+                      size_t nb = std::min(BLOCK, inner - i0);
+                      for (int l = 0; l < len; l++)
+                        for (size_t b = 0; b < nb; b++)
+                          {
+                            line[b*len + l] = base[l*inner + i0 + b];
+                          }
+                      for (size_t b = 0; b < nb; b++)
+                        {
+                          plan->execute(&line[b*len], &line[b*len], a_kind, work.data());
+                        }
+                      for (int l = 0; l < len; l++)
+                        for (size_t b = 0; b < nb; b++)
+                          {
+                            base[l*inner + i0 + b] = line[b*len + l];
+                          }
+                    }
+                });
+  }
+
+  /**
+     Multidimensional real-to-real transform of kind a_kind along every axis
+     of a row-major array of extents a_n[0 .. a_dim-1]; a_out may be the
+     same as a_in.
+  */
+  inline void mdr2r(int a_dim, const int* a_n, r2rKind a_kind, double* a_out, const double* a_in)
+  {
+    size_t npts = 1;
+    for (int d = 0; d < a_dim; d++) npts *= a_n[d];
+    if (a_out != a_in) std::copy(a_in, a_in + npts, a_out);
+    for (int d = a_dim - 1; d >= 0; d--)
+      {
+        r2rAxis(a_out, a_dim, a_n, d, a_kind);
+      }
+  }
+
+  /**
+     mdprdft of strided views (lineAccess): a_in has extents a_n and element
+     strides a_inStride, a_out the extents of the spectrum and element
+     strides a_outStride, either nullptr for a packed array.
+  */
+  inline void mdprdft(int a_dim, const int* a_n, int a_truncAxis,
+                      cplx* a_out, const size_t* a_outStride,
+                      const double* a_in, const size_t* a_inStride)
+  {
+    realForwardAxisPadded(a_in, a_out, a_dim, a_n, a_truncAxis, a_n[a_truncAxis],
+                          0, -1, a_inStride, a_outStride);
+    std::vector<int> h(a_n, a_n + a_dim);
+    h[a_truncAxis] = a_n[a_truncAxis]/2 + 1;
+    for (int d = a_dim - 1; d >= 0; d--)
+      {
+        if (d != a_truncAxis) transformAxis(a_out, a_dim, h.data(), d, -1, a_outStride);
+      }
+  }
+
+  /**
+     Multidimensional real-to-complex DFT (sign -1) of a row-major array of
+     extents a_n[0 .. a_dim-1]; the output is truncated to n/2+1 along
+     a_truncAxis (a_dim-1 for the FFTX_COMPLEX_TRUNC_LAST layout).
+  */
+  inline void mdprdft(int a_dim, const int* a_n, int a_truncAxis,
+                      cplx* a_out, const double* a_in)
+  {
+    mdprdft(a_dim, a_n, a_truncAxis, a_out, nullptr, a_in, nullptr);
+  }
+
+  /**
+     imdprdft of strided views (lineAccess): a_in has the extents of the
+     spectrum and element strides a_inStride, a_out extents a_n and element
+     strides a_outStride, either nullptr for a packed array.
+  */
+  inline void imdprdft(int a_dim, const int* a_n, int a_truncAxis,
+                       double* a_out, const size_t* a_outStride,
+                       const cplx* a_in, const size_t* a_inStride)
+  {
+    std::vector<int> h(a_n, a_n + a_dim);
+    h[a_truncAxis] = a_n[a_truncAxis]/2 + 1;
+    size_t npts = 1;
+    for (int d = 0; d < a_dim; d++) npts *= h[d];
+    std::vector<cplx> temp(npts);
+    copyStrided(a_dim, h.data(), temp.data(), (const size_t*)nullptr, a_in, a_inStride);
+    for (int d = a_dim - 1; d >= 0; d--)
+      {
+        if (d != a_truncAxis) transformAxis(temp.data(), a_dim, h.data(), d, 1);
+      }
+    realInverseAxisTruncated(temp.data(), a_out, a_dim, a_n, a_truncAxis, a_n[a_truncAxis],
+                             0, a_outStride);
+  }
+
+  /**
+     Multidimensional complex-to-real DFT (sign +1), the inverse of mdprdft
+     up to a factor of the number of points; a_in is left unchanged.
+  */
+  inline void imdprdft(int a_dim, const int* a_n, int a_truncAxis,
+                       double* a_out, const cplx* a_in)
+  {
+    imdprdft(a_dim, a_n, a_truncAxis, a_out, nullptr, a_in, nullptr);
+  }
+
+  /**
+     mdprdft to a split-complex spectrum: the last complex pass writes the
+     planes of a_out.
+  */
+  inline void mdprdft(int a_dim, const int* a_n, int a_truncAxis,
+                      splitArray a_out, const double* a_in)
+  {
+    std::vector<int> h(a_n, a_n + a_dim);
+    h[a_truncAxis] = a_n[a_truncAxis]/2 + 1;
+    size_t nspec = 1;
+    for (int d = 0; d < a_dim; d++) nspec *= h[d];
+    std::vector<cplx> temp(nspec);
+    realForwardAxis(a_in, temp.data(), a_dim, a_n, a_truncAxis);
+    int last = (a_truncAxis == 0) ? 1 : 0;
+    if (last >= a_dim)
+      {
+        copySplit(a_out, splitArray(temp.data()), nspec);
+        return;
+      }
+    for (int d = a_dim - 1; d >= 0; d--)
+      {
+        if (d == a_truncAxis) continue;
+        if (d == last)
+          transformAxisSplit(a_out, splitArray(temp.data()), a_dim, h.data(), d, -1);
+        else
+          transformAxis(temp.data(), a_dim, h.data(), d, -1);
+      }
+  }
+
+  /**
+     imdprdft of a split-complex spectrum: the first complex pass reads the
+     planes of a_in, which is left unchanged.
+  */
+  inline void imdprdft(int a_dim, const int* a_n, int a_truncAxis,
+                       double* a_out, splitArray a_in)
+  {
+    std::vector<int> h(a_n, a_n + a_dim);
+    h[a_truncAxis] = a_n[a_truncAxis]/2 + 1;
+    size_t nspec = 1;
+    for (int d = 0; d < a_dim; d++) nspec *= h[d];
+    std::vector<cplx> temp(nspec);
+    int first = (a_truncAxis == a_dim - 1) ? a_dim - 2 : a_dim - 1;
+    if (first < 0)
+      copySplit(splitArray(temp.data()), a_in, nspec);
+    for (int d = a_dim - 1; d >= 0; d--)
+      {
+        if (d == a_truncAxis) continue;
+        if (d == first)
+          transformAxisSplit(splitArray(temp.data()), a_in, a_dim, h.data(), d, 1);
+        else
+          transformAxis(temp.data(), a_dim, h.data(), d, 1);
+      }
+    realInverseAxis(temp.data(), a_out, a_dim, a_n, a_truncAxis);
+  }
+
+  /**
+     mdprdft of extents a_n of a real array that is zero outside the box of
+     extents a_m at the origin, given compactly as a row-major array of
+     extents a_m.  The zero-padded array is never formed: each pass grows
+     one axis from a_m to its full length and transforms only the lines
+     that can be nonzero; for a domain doubled along each of 3 axes that is
+     7/12 of the work of the full transform.
+  */
+  inline void mdprdftEmbedded(int a_dim, const int* a_n, int a_truncAxis,
+                              cplx* a_out, const double* a_in, const int* a_m)
+  {
+    std::vector<int> e(a_m, a_m + a_dim);
+    e[a_truncAxis] = a_n[a_truncAxis]/2 + 1;
+    std::vector<cplx> cur, next;
+    cplx* dst = a_out;
+    if (a_dim > 1)
+      {
+        cur.resize(std::accumulate(e.begin(), e.end(), (size_t)1, std::multiplies<size_t>()));
+        dst = cur.data();
+      }
+    realForwardAxisPadded(a_in, dst, a_dim, a_m, a_truncAxis, a_n[a_truncAxis]);
+    int passes = a_dim - 1;
+    for (int d = a_dim - 1; d >= 0; d--)
+      {
+        if (d == a_truncAxis) continue;
+        std::vector<int> grown = e;
+        grown[d] = a_n[d];
+        if (--passes > 0)
+          {
+            next.resize(std::accumulate(grown.begin(), grown.end(), (size_t)1, std::multiplies<size_t>()));
+            dst = next.data();
+          }
+        else
+          {
+            dst = a_out;
+          }
+        transformAxisPadded(cur.data(), dst, a_dim, e.data(), d, a_n[d], a_n[d], -1);
+        cur.swap(next);
+        e = grown;
+      }
+  }
+
+  /**
+     imdprdft of extents a_n, keeping only the box of extents a_m at a_lo
+     (the origin by default), written compactly as a row-major array of
+     extents a_m.  Each pass cuts one axis to the box as soon as it is
+     transformed, so the later passes skip the lines of the discarded part.
+  */
+  inline void imdprdftExtracted(int a_dim, const int* a_n, int a_truncAxis,
+                                double* a_out, const cplx* a_in, const int* a_m,
+                                const int* a_lo = nullptr)
+  {
+    std::vector<int> lo(a_dim, 0);
+    if (a_lo != nullptr) lo.assign(a_lo, a_lo + a_dim);
+    std::vector<int> e(a_n, a_n + a_dim);
+    e[a_truncAxis] = a_n[a_truncAxis]/2 + 1;
+    std::vector<cplx> cur, next;
+    const cplx* src = a_in;
+    for (int d = 0; d < a_dim; d++)
+      {
+        if (d == a_truncAxis) continue;
+        std::vector<int> cut = e;
+        cut[d] = a_m[d];
+        next.resize(std::accumulate(cut.begin(), cut.end(), (size_t)1, std::multiplies<size_t>()));
+        transformAxisPadded(src, next.data(), a_dim, e.data(), d, a_n[d], a_m[d], 1, lo[d]);
+        cur.swap(next);
+        src = cur.data();
+        e = cut;
+      }
+    e[a_truncAxis] = a_m[a_truncAxis];
+    realInverseAxisTruncated(src, a_out, a_dim, e.data(), a_truncAxis, a_n[a_truncAxis],
+                             lo[a_truncAxis]);
+  }
+
+  /**
+     The box of extents a_m at a_lo of the mddft of extents a_n, written
+     compactly as a row-major array of extents a_m.  The passes run from the
+     last axis to the first, each cutting its axis to the box, so every pass
+     after the first transforms only the lines that reach the box and no
+     coefficient outside it is stored.
+  */
+  inline void mddftBox(int a_dim, const int* a_n, cplx* a_out, const cplx* a_in,
+                       const int* a_lo, const int* a_m, int a_sign)
+  {
+    std::vector<int> e(a_n, a_n + a_dim);
+    std::vector<cplx> cur, next;
+    const cplx* src = a_in;
+    for (int d = a_dim - 1; d >= 0; d--)
+      {
+        std::vector<int> cut = e;
+        cut[d] = a_m[d];
+        cplx* dst = a_out;
+        if (d > 0)
+          {
+            next.resize(std::accumulate(cut.begin(), cut.end(), (size_t)1, std::multiplies<size_t>()));
+            dst = next.data();
+          }
+        transformAxisPadded(src, dst, a_dim, e.data(), d, a_n[d], a_m[d], a_sign, a_lo[d]);
+        cur.swap(next);
+        src = cur.data();
+        e = cut;
+      }
+  }
+
+  /**
+     The box of extents a_m at a_lo of the mdprdft of extents a_n (a box of
+     the half spectrum, truncated along a_truncAxis), written compactly as a
+     row-major array of extents a_m; as mddftBox, each pass cuts its axis.
+  */
+  inline void mdprdftBox(int a_dim, const int* a_n, int a_truncAxis, cplx* a_out,
+                         const double* a_in, const int* a_lo, const int* a_m)
+  {
+    std::vector<int> e(a_n, a_n + a_dim);
+    e[a_truncAxis] = a_m[a_truncAxis];
+    std::vector<cplx> cur, next;
+    cplx* dst = a_out;
+    if (a_dim > 1)
+      {
+        cur.resize(std::accumulate(e.begin(), e.end(), (size_t)1, std::multiplies<size_t>()));
+        dst = cur.data();
+      }
+    realForwardAxisPadded(a_in, dst, a_dim, a_n, a_truncAxis, a_n[a_truncAxis],
+                          a_lo[a_truncAxis], a_m[a_truncAxis]);
+    int passes = a_dim - 1;
+    for (int d = a_dim - 1; d >= 0; d--)
+      {
+        if (d == a_truncAxis) continue;
+        std::vector<int> cut = e;
+        cut[d] = a_m[d];
+        if (--passes > 0)
+          {
+            next.resize(std::accumulate(cut.begin(), cut.end(), (size_t)1, std::multiplies<size_t>()));
+            dst = next.data();
+          }
+        else
+          {
+            dst = a_out;
+          }
+        transformAxisPadded(cur.data(), dst, a_dim, e.data(), d, a_n[d], a_m[d], -1, a_lo[d]);
+        cur.swap(next);
+        e = cut;
+      }
+  }
+}
+
+#endif
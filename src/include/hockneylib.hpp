@@ -0,0 +1,109 @@
+#ifndef FFTX_HOCKNEYLIB_HEADER
+#define FFTX_HOCKNEYLIB_HEADER
+
+//  Copyright (c) 2018-2022, Carnegie Mellon University
+//  See LICENSE for details
+
+#include "interface.hpp"
+#include "fftxdag.hpp"
+
+/*
+ Free-space (Hockney) convolution of a real field on a box of sizes n with
+ a real, even Green's function: the field is taken as zero outside the
+ box, and the convolution runs on the doubled domain 2n, of which only the
+ first box of sizes n is kept.
+
+ The doubled, zero-padded field is never formed.  The problem is the
+ graph ZERO_EMBED -> MDPRDFT -> pointwise symbol -> IMDPRDFT -> EXTRACT
+ (freeSpaceConvolutionGraph), fused into one operator unless FFTX_FUSION
+ is 0, so the generated kernel prunes the transforms of the 7/8 of the
+ input that is zero and of the 7/8 of the output that is discarded; on
+ CPU without SPIRAL the native engine runs the same pruned transforms
+ (mdprdftEmbedded, imdprdftExtracted in fftxnative.hpp).
+
+ The problem sizes are {n0, n1, n2}, and args are {Y, X, sym}: X and Y the
+ real fields on the box, and sym the real symbol on the half spectrum of
+ the doubled domain, 2n0 x 2n1 x (n2+1) values in the layout of the output
+ of MDPRDFTProblem of sizes 2n: the DFT of the Green's function sampled
+ on the doubled domain, with G(k) at k mod 2n, divided by 8 n0 n1 n2 for
+ the unnormalized inverse.
+
+     HockneyProblem hp(std::vector<void*>{out, in, symbol}, {n0, n1, n2}, "hockney");
+     hp.transform();
+*/
+
+/**
+   Graph of a free-space convolution on a box of extents a_n (slowest
+   varying first), on the doubled domain; one input and one output field,
+   passed as arrays of pointers (DAGProblem) or, if !a_pointerArgs, as the
+   plain X and Y of the other problems.
+*/
+inline fftx_dag::graph freeSpaceConvolutionGraph(const std::vector<int>& a_n,
+                                                 bool a_pointerArgs = true)
+{
+  std::vector<int> padded = a_n;
+  for (int& e : padded) e *= 2;
+  std::vector<int> h = fftx_dag::halfExtents(padded);
+  std::vector<int> origin(a_n.size(), 0);
+  fftx_dag::graph g;
+  fftx_dag::var x = g.input(a_n);
+  fftx_dag::var y = g.output(a_n);
+  fftx_dag::var xpad = g.local(padded);
+  fftx_dag::var spectrum = g.local(h, fftx_dag::COMPLEX);
+  fftx_dag::var product = g.local(h, fftx_dag::COMPLEX);
+  fftx_dag::var ypad = g.local(padded);
+  g.zeroEmbed(xpad, x, origin);
+  g.prdft(spectrum, xpad, padded);
+  g.diagonal(product, spectrum);
+  g.iprdft(ypad, product, padded);
+  g.extract(y, ypad, origin);
+  if (!a_pointerArgs)
+    {
+      g.bind(x, fftx_dag::INPUT, -1);
+      g.bind(y, fftx_dag::OUTPUT, -1);
+      g.setPointerArgs(false);
+    }
+  return g;
+}
+
+class HockneyProblem: public FFTXProblem {
+public:
+    using FFTXProblem::FFTXProblem;
+    void randomProblemInstance() {
+    }
+    void semantics() {
+        fftx_dag::graph g = freeSpaceConvolutionGraph(std::vector<int>(sizes.begin(), sizes.begin() + 3), false);
+        if(fftx_dag::fusionEnabled())
+            g.fuse();
+        std::cout << "name := \""<< name << "_spiral" << "\";" << std::endl;
+        std::cout << g.script() << std::endl;
+    }
+#if !defined (FFTX_CUDA) && !defined (FFTX_HIP)
+    bool nativeTransform() {
+        std::vector<int> n(sizes.begin(), sizes.begin() + 3);
+        int trunc = FFTX_COMPLEX_TRUNC_LAST ? 2 : 0;
+        #if !FFTX_ROW_MAJOR_ORDER
+        std::reverse(n.begin(), n.end());
+        trunc = 2 - trunc;
+        #endif
+        std::vector<int> padded{2*n[0], 2*n[1], 2*n[2]};
+        size_t nspec = (size_t)padded[0] * padded[1] * padded[2] / padded[trunc] * (n[trunc] + 1);
+        spectrum.resize(nspec);
+        fftx_native::mdprdftEmbedded(3, padded.data(), trunc, spectrum.data(),
+                                     (double*)args.at(1), n.data());
+        const double * sym = (const double*)args.at(2);
+        fftx_native::parallelFor(nspec, 4, [&](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++)
+                spectrum[i] *= sym[i];
+        });
+        fftx_native::imdprdftExtracted(3, padded.data(), trunc, (double*)args.at(0),
+                                       spectrum.data(), n.data());
+        return true;
+    }
+
+protected:
+    std::vector<std::complex<double>> spectrum;
+#endif
+};
+
+#endif
@@ -1,28 +1,21 @@
-using namespace fftx;
+#ifndef FFTX_IMDDFTOBJ_HEADER
+#define FFTX_IMDDFTOBJ_HEADER
 
-class IMDDFTProblem: public FFTXProblem {
+#include "mddftObj.hpp"
+
+class IMDDFTProblem: public MDDFTProblem {
 public:
-    using FFTXProblem::FFTXProblem;
-    void randomProblemInstance() {
+    IMDDFTProblem() {
+        sign = 1;
     }
-    void semantics() {
-        tracing=true;
-  
-        box_t<3> domain(point_t<3>({{1,1,1}}), point_t<3>({{sizes.at(0), sizes.at(1), sizes.at(2)}}));
-        
-        std::array<array_t<3,std::complex<double>>,1> intermediates {domain};
-        array_t<3,std::complex<double>> inputs(domain);
-        array_t<3,std::complex<double>> outputs(domain);
-
-
-        setInputs(inputs);
-        setOutputs(outputs);
-        
-        openScalarDAG();
-        
-        // MDDFT(domain.extents(), 1, intermediates[0], inputs);
-        IMDDFT(domain.extents(), 1, outputs, inputs);
-
-        closeScalarDAG(intermediates, name.c_str());
+    IMDDFTProblem(std::string name1) :
+        MDDFTProblem(name1) {
+        sign = 1;
+    }
+    IMDDFTProblem(const std::vector<void*>& args1, const std::vector<int>& sizes1, std::string name1) :
+        MDDFTProblem(args1, sizes1, name1) {
+        sign = 1;
     }
 };
+
+#endif
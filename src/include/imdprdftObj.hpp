@@ -1,48 +1,21 @@
-using namespace fftx;
+#ifndef FFTX_IMDPRDFTOBJ_HEADER
+#define FFTX_IMDPRDFTOBJ_HEADER
 
-// static constexpr auto imdprdft_script{
-//     R"(szhalfcube := DropLast(szcube,1)::[Int(Last(szcube)/2)+1];
-//     var_1:= var("var_1", BoxND([0,0,0], TReal));
-//     var_2:= var("var_2", BoxND(szcube, TReal));
-//     var_3:= var("var_3", BoxND(szhalfcube, TReal));
-//     var_2:= X;
-//     var_3:= Y;
-//     symvar := var("sym", TPtr(TReal));
-//     transform := TFCall(TDecl(TDAG([
-//            TDAGNode(TTensorI(IMDPRDFT(szcube,sign),1,APar, APar), var_3,var_2),
-//                   ]),
-//             [var_1]
-//             ),
-//         rec(fname:=name, params:= [symvar])
-//     );
-//     )"
-// };
+#include "mdprdftObj.hpp"
 
-static std::string imdprdft_script = "szhalfcube := DropLast(szcube,1)::[Int(Last(szcube)/2)+1];\n\
-    var_1:= var(\"var_1\", BoxND([0,0,0], TReal));\n\
-    var_2:= var(\"var_2\", BoxND(szcube, TReal));\n\
-    var_3:= var(\"var_3\", BoxND(szhalfcube, TReal));\n\
-    var_2:= X;\n\
-    var_3:= Y;\n\
-    symvar := var(\"sym\", TPtr(TReal));\n\
-    transform := TFCall(TDecl(TDAG([\n\
-           TDAGNode(TTensorI(IMDPRDFT(szcube,sign),1,APar, APar), var_3,var_2),\n\
-                  ]),\n\
-            [var_1]\n\
-            ),\n\
-        rec(fname:=name, params:= [symvar])\n\
-    );";
-
-class IMDPRDFTProblem: public FFTXProblem {
+class IMDPRDFTProblem: public MDPRDFTProblem {
 public:
-    using FFTXProblem::FFTXProblem;
-    void randomProblemInstance() {
+    IMDPRDFTProblem() {
+        sign = 1;
+    }
+    IMDPRDFTProblem(std::string name1) :
+        MDPRDFTProblem(name1) {
+        sign = 1;
     }
-    void semantics() {
-        std::cout << "szcube := [" << sizes.at(0) << ", " << sizes.at(1) << ", " << sizes.at(2) << "];" << std::endl;
-        std::cout << "sign := 1;" << std::endl;
-        std::cout << "name := \""<< name << "_spiral" << "\";" << std::endl;
-        std::cout << imdprdft_script << std::endl;
+    IMDPRDFTProblem(const std::vector<void*>& args1, const std::vector<int>& sizes1, std::string name1) :
+        MDPRDFTProblem(args1, sizes1, name1) {
+        sign = 1;
     }
 };
 
+#endif
@@ -33,25 +33,53 @@
 #include <string>
 #include <array>
 #include <chrono>
+#include "fftxcheck.hpp"
 #if defined FFTX_CUDA
 #include "cudabackend.hpp"
 #elif defined FFTX_HIP
 #include "hipbackend.hpp"
 #else
 #include "cpubackend.hpp"
+#include "fftxnative.hpp"
 #endif
 #if defined (FFTX_CUDA) || defined(FFTX_HIP)
 #include "fftx_mddft_gpu_public.h"
 #include "fftx_imddft_gpu_public.h"
 #include "fftx_mdprdft_gpu_public.h"
 #include "fftx_imdprdft_gpu_public.h"
+#ifndef FFTX_NO_R2R_LIB
+#include "fftx_mddct_gpu_public.h"
+#include "fftx_imddct_gpu_public.h"
+#include "fftx_mddst_gpu_public.h"
+#include "fftx_imddst_gpu_public.h"
+#endif
+#ifndef FFTX_NO_RESAMPLE_LIB
+#include "fftx_resample_gpu_public.h"
+#include "fftx_iresample_gpu_public.h"
+#endif
 #include "fftx_rconv_gpu_public.h"
+#ifdef FFTX_PSATD_LIB
+#include "fftx_psatd_gpu_public.h"
+#endif
 #else
 #include "fftx_mddft_cpu_public.h"
 #include "fftx_imddft_cpu_public.h"
 #include "fftx_mdprdft_cpu_public.h"
 #include "fftx_imdprdft_cpu_public.h"
+#ifndef FFTX_NO_R2R_LIB
+#include "fftx_mddct_cpu_public.h"
+#include "fftx_imddct_cpu_public.h"
+#include "fftx_mddst_cpu_public.h"
+#include "fftx_imddst_cpu_public.h"
+#endif
+#ifndef FFTX_NO_RESAMPLE_LIB
+#include "fftx_resample_cpu_public.h"
+#include "fftx_iresample_cpu_public.h"
+#endif
 #include "fftx_rconv_cpu_public.h"
+#ifdef FFTX_PSATD_LIB
+#include "fftx_psatd_cpu_public.h"
+#endif
 #endif
 #pragma once
 
@@ -103,22 +131,175 @@ inline void restore_input(int saved_fd)
     close(saved_fd);
 }
 
+// Number of fields transformed at once: sizes {x, y, z} or {x, y, z, batch}
+// for the 3D DFT problems, fields stored one after another.
+inline int problemBatch(const std::vector<int>& sizes) {
+    return (sizes.size() > 3) ? sizes.at(3) : 1;
+}
+
+// Sizes of a multidimensional DFT of extents n[0 .. d-1] (any d >= 1) on
+// batch fields.  In 3D they are {x, y, z} or {x, y, z, batch} as always;
+// otherwise {n[d-3], n[d-2], n[d-1], batch, d, n[0], ..., n[d-4]}, with
+// the extents of 1D and 2D padded with leading 1s, so the last three
+// extents and the batch keep their places, and each dimension is cached
+// on its own.
+inline std::vector<int> mdSizes(const std::vector<int>& n, int batch = 1) {
+    int dim = (int)n.size();
+    std::vector<int> sizes(3, 1);
+    for(int d = std::max(dim - 3, 0); d < dim; d++)
+        sizes.at(d - dim + 3) = n.at(d);
+    if(dim == 3 && batch == 1)
+        return sizes;
+    sizes.push_back(batch);
+    if(dim == 3)
+        return sizes;
+    sizes.push_back(dim);
+    for(int d = 0; d < dim - 3; d++)
+        sizes.push_back(n.at(d));
+    return sizes;
+}
+
+inline int problemDim(const std::vector<int>& sizes) {
+    return (sizes.size() > 4) ? sizes.at(4) : 3;
+}
+
+// The extents n[0 .. d-1] of sizes built by mdSizes.
+inline std::vector<int> problemExtents(const std::vector<int>& sizes) {
+    int dim = problemDim(sizes);
+    std::vector<int> n;
+    for(int d = 0; d < dim - 3; d++)
+        n.push_back(sizes.at(5 + d));
+    for(int d = std::max(3 - dim, 0); d < 3; d++)
+        n.push_back(sizes.at(d));
+    return n;
+}
+
+// SPIRAL list of the extents of sizes, "[n0, n1, ...]".
+inline std::string spiralExtents(const std::vector<int>& sizes) {
+    std::vector<int> n = problemExtents(sizes);
+    std::string rtn = "[";
+    for(int d = 0; d < (int)n.size(); d++)
+        rtn += (d ? ", " : "") + std::to_string(n[d]);
+    return rtn + "]";
+}
+
+// Sizes of the code of an MD problem of sizes in a_layout: the row-major
+// transform of the extents in memory order (a column-major plan of
+// {x, y, z} is the row-major plan of {z, y, x}).  A batch with interleaved
+// components is a different plan: its sizes end with the dimension and
+// the componentOrder of the output and of the input.  Split-complex
+// layouts have no generated plan (they run on the native engine only).
+inline std::vector<int> layoutSizes(const std::vector<int>& sizes, const fftx::layout_t& a_layout) {
+    int batch = problemBatch(sizes);
+    std::vector<int> rtn = mdSizes(a_layout.physical(problemExtents(sizes)), batch);
+    if(batch > 1 && a_layout.interleaved()) {
+        if(rtn.size() == 4)
+            rtn.push_back(3);
+        rtn.push_back(a_layout.outComponents);
+        rtn.push_back(a_layout.inComponents);
+    }
+    return rtn;
+}
+
+// SPIRAL tag of a componentOrder in TTensorI, as in batch1ddftObj.hpp.
+inline const char * spiralComponents(fftx::componentOrder a_order) {
+    return (a_order == fftx::AOS) ? "AVec" : "APar";
+}
+
+// The complex DFT libraries are keyed by 3 extents; 1D and 2D transforms
+// are in them as {1, 1, x} and {1, x, y} (gen_files.py pads the sizes).
+// Their arguments are packed and interleaved: sizes with the tags of
+// layoutSizes are not in them.
+inline bool mdLibrary(const std::vector<int>& sizes) {
+    return problemDim(sizes) <= 3 && sizes.size() <= 5;
+}
+
+// The real-to-real libraries are 3D only, one kind each: sizes {x, y, z, batch,
+// dim, kind} of r2rlib.hpp must have dim 3 and the kind of the library.
+inline bool r2rLibraryKind(const std::vector<int>& sizes, int kind) {
+    return sizes.size() < 6 || (sizes.at(4) == 3 && sizes.at(5) == kind);
+}
+
+// Fixed library transforms are for one field; with a batch, FFTXProblem
+// runs the library transform on each field in turn.  a_out and a_in are
+// set to the doubles of one field of the output and input of the library
+// transform name over sizes (memory order, as the libraries are keyed);
+// false for the libraries that are not run field by field.
+inline bool libFieldDoubles(const std::string& name, const std::vector<int>& sizes,
+                            size_t& a_out, size_t& a_in) {
+    size_t npts = (size_t)sizes.at(0) * sizes.at(1) * sizes.at(2);
+    size_t nspec = npts / sizes.at(2) * (sizes.at(2)/2 + 1);
+    if(name == "mddft" || name == "imddft")
+        a_out = a_in = 2 * npts;
+    else if(name == "mdprdft") {
+        a_out = 2 * nspec;
+        a_in = npts;
+    }
+    else if(name == "imdprdft") {
+        a_out = npts;
+        a_in = 2 * nspec;
+    }
+    else
+        return false;
+    return true;
+}
+
+// The resampling libraries refine (a_refine) or coarsen by 2 without shift:
+// sizes {x, y, z, batch, x', y', z', shift} of resamplelib.hpp.
+inline bool resampleLibrary(const std::vector<int>& sizes, bool a_refine) {
+    if(sizes.size() < 10)
+        return false;
+    for(int d = 0; d < 3; d++) {
+        int n = sizes.at(d), m = sizes.at(4 + d);
+        if(sizes.at(7 + d) != 0 || (a_refine ? (m != 2*n) : (n != 2*m)))
+            return false;
+    }
+    return true;
+}
+
 inline transformTuple_t * getLibTransform(std::string name, std::vector<int> sizes) {
-    if(name == "mddft") {
+    if(name == "mddft" && mdLibrary(sizes)) {
         return fftx_mddft_Tuple(fftx::point_t<3>({{sizes.at(0), sizes.at(1), sizes.at(2)}}));
     }
-    else if(name == "imddft") {
+    else if(name == "imddft" && mdLibrary(sizes)) {
         return fftx_imddft_Tuple(fftx::point_t<3>({{sizes.at(0), sizes.at(1), sizes.at(2)}}));
     }
-    else if(name == "mdprdft") {
+    else if(name == "mdprdft" && mdLibrary(sizes)) {
         return fftx_mdprdft_Tuple(fftx::point_t<3>({{sizes.at(0), sizes.at(1), sizes.at(2)}}));
     }
-    else if(name == "imdprdft") {
+    else if(name == "imdprdft" && mdLibrary(sizes)) {
         return fftx_imdprdft_Tuple(fftx::point_t<3>({{sizes.at(0), sizes.at(1), sizes.at(2)}}));
     }
+#ifndef FFTX_NO_R2R_LIB
+    else if(name == "mddct" && r2rLibraryKind(sizes, fftx_native::R2R_DCT2)) {
+        return fftx_mddct_Tuple(fftx::point_t<3>({{sizes.at(0), sizes.at(1), sizes.at(2)}}));
+    }
+    else if(name == "imddct" && r2rLibraryKind(sizes, fftx_native::R2R_DCT3)) {
+        return fftx_imddct_Tuple(fftx::point_t<3>({{sizes.at(0), sizes.at(1), sizes.at(2)}}));
+    }
+    else if(name == "mddst" && r2rLibraryKind(sizes, fftx_native::R2R_DST2)) {
+        return fftx_mddst_Tuple(fftx::point_t<3>({{sizes.at(0), sizes.at(1), sizes.at(2)}}));
+    }
+    else if(name == "imddst" && r2rLibraryKind(sizes, fftx_native::R2R_DST3)) {
+        return fftx_imddst_Tuple(fftx::point_t<3>({{sizes.at(0), sizes.at(1), sizes.at(2)}}));
+    }
+#endif
+#ifndef FFTX_NO_RESAMPLE_LIB
+    else if(name == "resample" && resampleLibrary(sizes, true)) {
+        return fftx_resample_Tuple(fftx::point_t<3>({{sizes.at(0), sizes.at(1), sizes.at(2)}}));
+    }
+    else if(name == "resample" && resampleLibrary(sizes, false)) {
+        return fftx_iresample_Tuple(fftx::point_t<3>({{sizes.at(0), sizes.at(1), sizes.at(2)}}));
+    }
+#endif
     else if(name == "rconv") {
         return fftx_rconv_Tuple(fftx::point_t<3>({{sizes.at(0), sizes.at(1), sizes.at(2)}}));
     }
+#ifdef FFTX_PSATD_LIB
+    else if(name == "psatd") {
+        return fftx_psatd_Tuple(fftx::point_t<3>({{sizes.at(0), sizes.at(1), sizes.at(2)}}));
+    }
+#endif
     else {
         if(DEBUGOUT)
             std::cout << "non-supported fixed library transform" << std::endl; 
@@ -126,6 +307,11 @@ inline transformTuple_t * getLibTransform(std::string name, std::vector<int> siz
     }
 }
 
+inline bool haveEnv(const char * var) {
+    const char * tmp = std::getenv(var);
+    return (tmp != nullptr && tmp[0] != '\0');
+}
+
 inline std::string getFFTX() {
      const char * tmp2 = std::getenv("FFTX_HOME");
     std::string tmp(tmp2 ? tmp2 : "");
@@ -152,7 +338,7 @@ inline std::string getFromCache(std::string name, std::vector<int> sizes) {
     std::ostringstream oss;
     std::string tmp = getFFTX();
     oss << tmp << "cache_" << name << "_" << sizes.at(0);
-    for(int i = 1; i< sizes.size(); i++) {
+    for(size_t i = 1; i< sizes.size(); i++) {
         oss << "x" << sizes.at(i);
     }
     #if defined FFTX_HIP 
@@ -169,7 +355,7 @@ inline void printToCache(std::string spiral_out, std::string name, std::vector<i
     std::ofstream cached_file;
     std::string file_name;
     file_name.append(getFFTX()+"cache_"+name+"_"+std::to_string(sizes.at(0)));
-    for(int i = 1; i< sizes.size(); i++) {
+    for(size_t i = 1; i< sizes.size(); i++) {
         file_name.append("x"+std::to_string(sizes.at(i)));
     }
     #if defined FFTX_HIP
@@ -228,6 +414,7 @@ public:
     std::string res;
     std::map<std::vector<int>, Executor> executors;
     std::string name;
+    fftx::layout_t layout;
     FFTXProblem(){
     }
 
@@ -260,16 +447,73 @@ public:
     void setSizes(const std::vector<int>& sizes1);
     void setArgs(const std::vector<void*>& args1);
     void setName(std::string name);
+    // Layout of the arrays (fftx3.hpp), default FFTX_ROW_MAJOR_ORDER and
+    // FFTX_COMPLEX_TRUNC_LAST; throws std::invalid_argument for a layout
+    // the problem does not support.
+    void setLayout(const fftx::layout_t& a_layout);
+    virtual bool layoutSupported(const fftx::layout_t& a_layout) { return a_layout == fftx::layout_t(); }
+    // Element strides of argument a_arg (0 for Y, 1 for X) when it is a
+    // strided view, e.g. the interior of a field with ghost cells
+    // (fftx::array_t::strides()): one per axis of the problem, in the order
+    // of the extents of sizes, after the distance between fields for a
+    // batched problem.  Views run on the native engine, reading and writing
+    // only their points; an empty a_strides makes the argument packed again.
+    // Throws std::invalid_argument if the problem cannot take views.
+    void setStrides(int a_arg, const std::vector<size_t>& a_strides);
+    virtual bool viewsSupported() { return false; }
     void transform();
     std::string semantics2();
     virtual void randomProblemInstance() = 0;
     virtual void semantics() = 0;
+    // Run the transform with the native CPU engine (fftxnative.hpp), used when
+    // SPIRAL is not available; returns false if the problem has no native version.
+    virtual bool nativeTransform() { return false; }
+    bool runNative();
+    // Checked mode (fftxcheck.hpp): verify every a_rate-th call in the
+    // background, 0 turns it off.  Problems describe what they compute with
+    // checkSpec; those that do not are never checked.
+    void setCheckRate(int a_rate) { checkSampler.setRate(a_rate); }
+    virtual bool checkSpec(fftx_check::spec& /* s */) { return false; }
     float gpuTime;
+    // Wall time (ms) the last transform spent getting its code (generating,
+    // compiling or looking it up: 0 for code already in memory), and setting
+    // it up around the kernel (loading, init and destroy functions).
+    float planTime = 0.;
+    float initTime = 0.;
     void run(Executor e);
     std::string returnJIT();
     float getTime();
+    float getPlanTime() { return planTime; }
+    float getInitTime() { return initTime; }
     ~FFTXProblem(){}
 
+protected:
+    fftx_check::sampler checkSampler;
+    // Sizes of the code semantics() generates, which key the libraries and
+    // caches: sizes, or for a layout the sizes in memory order.
+    virtual std::vector<int> planSizes() { return sizes; }
+    // False when no generated code covers the problem (in its layout), so
+    // it runs natively or not at all.
+    virtual bool planGenerated() { return true; }
+    void runTransform();
+    const double * argBuffer(int i);
+    // Strides of the views set with setStrides, by argument, and in memory order.
+    std::map<int, std::vector<size_t>> views, memoryStrides;
+    // Element strides of argument a_arg in memory order, for the native
+    // engine, or nullptr if it is packed; a_field is set to the distance
+    // between the fields of a batch of a view.
+    const size_t * viewStrides(int a_arg, size_t& a_field);
+    // viewStrides, or for an argument with AOS components in the layout,
+    // the strides of its interleaved fields of extents a_n (in memory
+    // order), with a_field set to 1.
+    const size_t * componentStrides(int a_arg, const std::vector<int>& a_n, size_t& a_field);
+#if !defined (FFTX_CUDA) && !defined (FFTX_HIP)
+    // Complex argument a_arg for the native engine: the planes {re, im} of
+    // a SPLIT argument (args.at(a_arg) points to the pair), or the
+    // interleaved array.
+    fftx_native::splitArray complexArg(int a_arg);
+#endif
+
 };
 
 inline void FFTXProblem::setArgs(const std::vector<void*>& args1) {
@@ -284,6 +528,64 @@ inline void FFTXProblem::setName(std::string name1) {
     name = name1;
 }
 
+inline void FFTXProblem::setLayout(const fftx::layout_t& a_layout) {
+    if(!layoutSupported(a_layout))
+        throw std::invalid_argument(name + ": layout not supported");
+    layout = a_layout;
+}
+
+inline void FFTXProblem::setStrides(int a_arg, const std::vector<size_t>& a_strides) {
+    if(a_strides.empty()) {
+        views.erase(a_arg);
+        return;
+    }
+    if(!viewsSupported())
+        throw std::invalid_argument(name + ": strided views not supported");
+    views[a_arg] = a_strides;
+}
+
+inline const size_t * FFTXProblem::viewStrides(int a_arg, size_t& a_field) {
+    auto it = views.find(a_arg);
+    if(it == views.end())
+        return nullptr;
+    std::vector<size_t>& v = it->second;
+    size_t dim = problemDim(sizes);
+    bool batched = problemBatch(sizes) > 1;
+    if(v.size() != dim + (batched ? 1 : 0))
+        throw std::invalid_argument(name + ": strides do not match the sizes");
+    if(batched)
+        a_field = v[0];
+    memoryStrides[a_arg].assign(v.end() - dim, v.end());
+    if(!layout.rowMajor)
+        std::reverse(memoryStrides[a_arg].begin(), memoryStrides[a_arg].end());
+    return memoryStrides[a_arg].data();
+}
+
+#if !defined (FFTX_CUDA) && !defined (FFTX_HIP)
+inline fftx_native::splitArray FFTXProblem::complexArg(int a_arg) {
+    fftx::complexFormat format = (a_arg == 0) ? layout.outComplex : layout.inComplex;
+    if(format == fftx::SPLIT) {
+        double ** planes = (double**)args.at(a_arg);
+        return fftx_native::splitArray(planes[0], planes[1]);
+    }
+    return fftx_native::splitArray((std::complex<double>*)args.at(a_arg));
+}
+#endif
+
+inline const size_t * FFTXProblem::componentStrides(int a_arg, const std::vector<int>& a_n, size_t& a_field) {
+    const size_t * rtn = viewStrides(a_arg, a_field);
+    int batch = problemBatch(sizes);
+    fftx::componentOrder order = (a_arg == 0) ? layout.outComponents : layout.inComponents;
+    if(rtn != nullptr || batch == 1 || order == fftx::SOA)
+        return rtn;
+    std::vector<size_t>& s = memoryStrides[a_arg];
+    s.assign(a_n.size(), batch);
+    for(int d = (int)a_n.size() - 2; d >= 0; d--)
+        s[d] = s[d+1] * a_n[d+1];
+    a_field = 1;
+    return s.data();
+}
+
 inline std::string FFTXProblem::semantics2() {
     std::string tmp = getSPIRAL();
     int p[2];
@@ -322,12 +624,55 @@ inline std::string FFTXProblem::semantics2() {
 }
 
 
+inline const double * FFTXProblem::argBuffer(int i) {
+    #if defined FFTX_CUDA
+    return *((double**)args.at(i));
+    #else
+    return (const double*)args.at(i);
+    #endif
+}
+
 inline void FFTXProblem::transform(){
+    fftx_check::spec chk;
+    if(!checkSampler.sample() || !views.empty() || !checkSpec(chk)) {
+        runTransform();
+        return;
+    }
+    // the input may be overwritten by the transform, so copy it first
+    std::vector<double> input = fftx_check::snapshot(argBuffer(1), chk.inputDoubles());
+    runTransform();
+    fftx_check::submit(chk, std::move(input), argBuffer(0));
+}
 
-    transformTuple_t *tupl = getLibTransform(name, sizes);
+// Milliseconds since a_start.
+inline float elapsedMs(std::chrono::high_resolution_clock::time_point a_start) {
+    std::chrono::duration<float, std::milli> duration = std::chrono::high_resolution_clock::now() - a_start;
+    return duration.count();
+}
+
+inline void FFTXProblem::runTransform(){
+
+    planTime = initTime = 0.;
+    auto planStart = std::chrono::high_resolution_clock::now();
+    if(!planGenerated() || !views.empty()) {
+        if(!runNative())
+            throw std::runtime_error(name + ": no generated code for this layout or view");
+        return;
+    }
+    std::vector<int> key = planSizes();
+    transformTuple_t *tupl = getLibTransform(name, key);
+    int batch = problemBatch(sizes);
+    size_t outStride = 0, inStride = 0;
+    if(tupl != nullptr && batch > 1 &&
+       (!libFieldDoubles(name, key, outStride, inStride) || executors.find(key) != executors.end() ||
+        haveEnv("SPIRAL_HOME")))
+        tupl = nullptr; // one batched kernel rather than a library call per field
     if(tupl != nullptr) { //check if fixed library has transform
         if ( DEBUGOUT) std::cout << "found size in fixed library\n";
+        planTime = elapsedMs(planStart);
+        auto initStart = std::chrono::high_resolution_clock::now();
         ( * tupl->initfp )();
+        initTime = elapsedMs(initStart);
         #if defined (FFTX_CUDA) ||  (FFTX_HIP)
             DEVICE_EVENT_T custart, custop;
             DEVICE_EVENT_CREATE ( &custart );
@@ -336,11 +681,13 @@ inline void FFTXProblem::transform(){
         #else
             auto start = std::chrono::high_resolution_clock::now();
         #endif
+            for(int b = 0; b < batch; b++) {
             #if defined FFTX_CUDA
-            ( * tupl->runfp ) ( *((double**)args.at(0)), *((double**)args.at(1)), (*(double**)args.at(2)) );    
+            ( * tupl->runfp ) ( *((double**)args.at(0)) + b*outStride, *((double**)args.at(1)) + b*inStride, (*(double**)args.at(2)) );    
             #else
-            ( * tupl->runfp ) ( (double*)args.at(0), (double*)args.at(1), (double*)args.at(2) );
+            ( * tupl->runfp ) ( (double*)args.at(0) + b*outStride, (double*)args.at(1) + b*inStride, (double*)args.at(2) );
             #endif
+            }
         #if defined (FFTX_CUDA) ||  (FFTX_HIP)
             DEVICE_EVENT_RECORD ( custop );
             DEVICE_EVENT_SYNCHRONIZE ( custop );
@@ -354,12 +701,12 @@ inline void FFTXProblem::transform(){
         //end time
     }
     else { // use RTC
-        if(executors.find(sizes) != executors.end()) { //check in memory cache
+        if(executors.find(key) != executors.end()) { //check in memory cache
             if ( DEBUGOUT) std::cout << "cached size found, running cached instance\n";
-            run(executors.at(sizes));
+            run(executors.at(key));
         }
         else { //check filesystem cache
-            std::string file_name = getFromCache(name, sizes);
+            std::string file_name = haveEnv("FFTX_HOME") ? getFromCache(name, key) : "";
             std::ifstream ifs ( file_name );
             if(ifs) {
                 if ( DEBUGOUT) std::cout << "found cached file on disk\n";
@@ -368,29 +715,51 @@ inline void FFTXProblem::transform(){
                 res = fcontent;
                 Executor e;
                 e.execute(fcontent);
-                executors.insert(std::make_pair(sizes, e));
+                executors.insert(std::make_pair(key, e));
+                planTime = elapsedMs(planStart);
                 run(e);
             } 
+            else if(!haveEnv("SPIRAL_HOME") && runNative()) { //no code generator, use native engine
+                if ( DEBUGOUT) std::cout << "SPIRAL_HOME not set, ran native CPU transform\n";
+            }
             else { //generate code at runtime
                 if ( DEBUGOUT) std::cout << "haven't seen size, generating\n";
                 res = semantics2();
                 Executor e;
                 e.execute(res);
-                executors.insert(std::make_pair(sizes, e));
+                executors.insert(std::make_pair(key, e));
+                planTime = elapsedMs(planStart);
                 run(e);
-                printToCache(res, name, sizes);
+                printToCache(res, name, key);
             }
         }
     }
 }
 
 
+inline bool FFTXProblem::runNative() {
+    #if defined (FFTX_CUDA) || defined (FFTX_HIP)
+    return false;
+    #else
+    auto start = std::chrono::high_resolution_clock::now();
+    if(!nativeTransform())
+        return false;
+    auto stop = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<float, std::milli> duration = stop - start;
+    gpuTime = duration.count();
+    return true;
+    #endif
+}
+
+// The kernel time is from the executor, the rest of the call is its initialization.
 inline void FFTXProblem::run(Executor e) {
+    auto start = std::chrono::high_resolution_clock::now();
     #if (defined FFTX_HIP || FFTX_CUDA)
     gpuTime = e.initAndLaunch(args);
     #else
     gpuTime = e.initAndLaunch(args, name);
     #endif
+    initTime = std::max(0.f, elapsedMs(start) - gpuTime);
 }
 
 inline float FFTXProblem::getTime() {
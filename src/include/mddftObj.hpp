@@ -1,24 +1,36 @@
+#ifndef FFTX_MDDFTOBJ_HEADER
+#define FFTX_MDDFTOBJ_HEADER
+
 using namespace fftx;
 
+// MDDFT of sign -1 from a traced plan; IMDDFTProblem in imddftObj.hpp is
+// the same transform with sign 1.
 class MDDFTProblem: public FFTXProblem {
 public:
     using FFTXProblem::FFTXProblem;
     void randomProblemInstance() {
     }
     void semantics() {
-        tracing = true;
-        box_t<3> empty(point_t<3>({{1,1,1}}), point_t<3>({{0,0,0}}));
-        box_t<3> domain(point_t<3>({{1,1,1}}), point_t<3>({{sizes.at(0), sizes.at(1), sizes.at(2)}}));
-        
-        std::array<array_t<3,std::complex<double>>,1> intermediates {{empty}}; // in this case, empty
-        array_t<3,std::complex<double>> inputs(domain);
-        array_t<3,std::complex<double>> outputs(domain);
-        setInputs(inputs);
-        setOutputs(outputs);
-        
-        openScalarDAG();
-        MDDFT(domain.extents(), 1, outputs, inputs);
-
-        closeScalarDAG(intermediates, name.c_str());
+        // sizes of any dimension, from mdSizes
+        if(!traceMDDFTPlan(problemExtents(planSizes()), problemBatch(sizes), sign, name.c_str()))
+            throw std::runtime_error(std::string(sign == -1 ? "MDDFTProblem" : "IMDDFTProblem") +
+                                     ": no traced plan of dimension " +
+                                     std::to_string(problemDim(sizes)));
+    }
+    bool checkSpec(fftx_check::spec& s) {
+        s = fftx_check::layoutSpec(name, fftx_check::C2C, problemExtents(sizes), sign, layout);
+        s.batch = problemBatch(sizes);
+        return true;
+    }
+    // the traced plans take interleaved complex fields one after another (APar) only
+    bool layoutSupported(const fftx::layout_t& a_layout) {
+        return !a_layout.interleaved() && !a_layout.split();
+    }
+protected:
+    int sign = -1;
+    std::vector<int> planSizes() {
+        return layoutSizes(sizes, layout);
     }
 };
+
+#endif
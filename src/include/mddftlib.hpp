@@ -10,7 +10,7 @@ var_2:= X;
 var_3:= Y;
 symvar := var("sym", TPtr(TReal));
 transform := TFCall(TDecl(TDAG([
-        TDAGNode(TTensorI(MDDFT(szcube,sign),1,APar, APar), var_3,var_2),
+        TDAGNode(TTensorI(MDDFT(szcube,sign),batch,write, read), var_3,var_2),
                 ]),
         [var_1]
         ),
@@ -19,28 +19,174 @@ transform := TFCall(TDecl(TDAG([
 )"};
 
 
+// MDDFT of sign -1 on complex fields; IMDDFTProblem below is the same
+// transform with sign 1.
 class MDDFTProblem: public FFTXProblem {
 public:
     using FFTXProblem::FFTXProblem;
     void randomProblemInstance() {
     }
     void semantics() {
-        std::cout << "szcube := [" << sizes.at(0) << ", " << sizes.at(1) << ", " << sizes.at(2) << "];" << std::endl;
-        std::cout << "sign := -1;" << std::endl;
+        std::cout << "szcube := " << spiralExtents(planSizes()) << ";" << std::endl;
+        std::cout << "batch := " << problemBatch(sizes) << ";" << std::endl;
+        std::cout << "write := " << spiralComponents(layout.outComponents) << ";" << std::endl;
+        std::cout << "read := " << spiralComponents(layout.inComponents) << ";" << std::endl;
+        std::cout << "sign := " << sign << ";" << std::endl;
         std::cout << "name := \""<< name << "_spiral" << "\";" << std::endl;
         std::cout << mddft_script << std::endl;
     }
+    bool checkSpec(fftx_check::spec& s) {
+        s = fftx_check::layoutSpec(name, fftx_check::C2C, problemExtents(sizes), sign, layout);
+        s.batch = problemBatch(sizes);
+        return !layout.interleaved() && !layout.split();
+    }
+    // components are interleaved, or complex values split, not both; split
+    // layouts run on the native engine only, so not on the device
+    bool layoutSupported(const fftx::layout_t& a_layout) {
+#if defined (FFTX_CUDA) || defined (FFTX_HIP)
+        if(a_layout.split())
+            return false;
+#endif
+        return !(a_layout.interleaved() && a_layout.split());
+    }
+#if !defined (FFTX_CUDA) && !defined (FFTX_HIP)
+    bool nativeTransform() {
+        std::vector<int> n = layout.physical(problemExtents(sizes));
+        size_t npts = 1;
+        for(int e : n) npts *= e;
+        if(layout.split()) {
+            if(!views.empty())
+                return false;
+            fftx_native::splitArray out = complexArg(0), in = complexArg(1);
+            for(int b = 0; b < problemBatch(sizes); b++)
+                fftx_native::mddft(n.size(), n.data(), out + b*npts, in + b*npts, sign);
+            return true;
+        }
+        size_t outField = npts, inField = npts;
+        const size_t * outStride = componentStrides(0, n, outField);
+        const size_t * inStride = componentStrides(1, n, inField);
+        std::complex<double> * out = (std::complex<double>*)args.at(0);
+        std::complex<double> * in = (std::complex<double>*)args.at(1);
+        for(int b = 0; b < problemBatch(sizes); b++)
+            fftx_native::mddft(n.size(), n.data(), out + b*outField, outStride,
+                               in + b*inField, inStride, sign);
+        return true;
+    }
+    bool viewsSupported() {
+        return true;
+    }
+#endif
+protected:
+    int sign = -1;
+    std::vector<int> planSizes() {
+        return layoutSizes(sizes, layout);
+    }
+    // the MD scripts take interleaved complex values, so split layouts run
+    // on the native engine
+    bool planGenerated() {
+        return !layout.split();
+    }
 };
 
-class IMDDFTProblem: public FFTXProblem {
+class IMDDFTProblem: public MDDFTProblem {
 public:
-    using FFTXProblem::FFTXProblem;
+    IMDDFTProblem() {
+        sign = 1;
+    }
+    IMDDFTProblem(std::string name1) :
+        MDDFTProblem(name1) {
+        sign = 1;
+    }
+    IMDDFTProblem(const std::vector<void*>& args1, const std::vector<int>& sizes1, std::string name1) :
+        MDDFTProblem(args1, sizes1, name1) {
+        sign = 1;
+    }
+};
+
+// The box of the output of MDDFT given by the box_t, for diagnostics and
+// filters that need only part of the spectrum: the kernel skips the
+// butterflies and stores of the other coefficients, and Y holds only the
+// box, (hi-lo+1) points along each axis per field.  The constructor stores
+// the box in sizes, as {n0, n1, n2, batch, lo0, lo1, lo2, hi0, hi1, hi2}, so
+// each box is generated and cached on its own; the name must not be one of
+// the library transforms (mddft, imddft, ...).  A box outside the spectrum
+// throws std::out_of_range, as fftx_dag::graph does.
+class MDDFTBoxProblem: public FFTXProblem {
+public:
+    MDDFTBoxProblem() {
+    }
+    MDDFTBoxProblem(const std::vector<void*>& args1, const std::vector<int>& sizes1,
+                    const box_t<3>& box, std::string name1) :
+        MDDFTBoxProblem(args1, sizes1, box, name1, -1) {
+    }
+    // sizes of the box, which must lie in the spectrum of sizes1, truncated
+    // to n/2+1 along a_truncAxis (none if negative)
+    static std::vector<int> boxSizes(const std::vector<int>& sizes1, const box_t<3>& box,
+                                     int a_truncAxis) {
+        for(int d = 0; d < 3; d++) {
+            int n = (d == a_truncAxis) ? sizes1.at(d)/2 + 1 : sizes1.at(d);
+            if(box.lo[d] < 0 || box.hi[d] < box.lo[d] || box.hi[d] >= n)
+                throw std::out_of_range("MDDFTBoxProblem: box outside the spectrum");
+        }
+        std::vector<int> rtn{sizes1.at(0), sizes1.at(1), sizes1.at(2), problemBatch(sizes1)};
+        for(int d = 0; d < 3; d++)
+            rtn.push_back(box.lo[d]);
+        for(int d = 0; d < 3; d++)
+            rtn.push_back(box.hi[d]);
+        return rtn;
+    }
     void randomProblemInstance() {
     }
     void semantics() {
-        std::cout << "szcube := [" << sizes.at(0) << ", " << sizes.at(1) << ", " << sizes.at(2) << "];" << std::endl;
-        std::cout << "sign := 1;" << std::endl;
+        fftx_dag::graph g = fftx_dag::subBoxTransform(fftx_dag::DFT, cube(), boxLo(), boxExtents(),
+                                                      sign, problemBatch(sizes));
+        if(fftx_dag::fusionEnabled())
+            g.fuse();
         std::cout << "name := \""<< name << "_spiral" << "\";" << std::endl;
-        std::cout << mddft_script << std::endl;
+        std::cout << g.script() << std::endl;
+    }
+#if !defined (FFTX_CUDA) && !defined (FFTX_HIP)
+    bool nativeTransform() {
+        std::vector<int> n = cube(), lo = boxLo(), m = boxExtents();
+        #if !FFTX_ROW_MAJOR_ORDER
+        std::reverse(n.begin(), n.end());
+        std::reverse(lo.begin(), lo.end());
+        std::reverse(m.begin(), m.end());
+        #endif
+        size_t npts = (size_t)n[0] * n[1] * n[2];
+        size_t nbox = (size_t)m[0] * m[1] * m[2];
+        std::complex<double> * out = (std::complex<double>*)args.at(0);
+        std::complex<double> * in = (std::complex<double>*)args.at(1);
+        for(int b = 0; b < problemBatch(sizes); b++)
+            fftx_native::mddftBox(3, n.data(), out + b*nbox, in + b*npts, lo.data(), m.data(), sign);
+        return true;
+    }
+#endif
+
+protected:
+    int sign = -1;
+    MDDFTBoxProblem(const std::vector<void*>& args1, const std::vector<int>& sizes1,
+                    const box_t<3>& box, std::string name1, int a_truncAxis) :
+        FFTXProblem(args1, boxSizes(sizes1, box, a_truncAxis), name1) {
+    }
+    std::vector<int> cube() const { return std::vector<int>(sizes.begin(), sizes.begin() + 3); }
+    std::vector<int> boxLo() const { return std::vector<int>(sizes.begin() + 4, sizes.begin() + 7); }
+    std::vector<int> boxExtents() const {
+        std::vector<int> m(3);
+        for(int d = 0; d < 3; d++)
+            m[d] = sizes.at(7 + d) - sizes.at(4 + d) + 1;
+        return m;
     }
-};
\ No newline at end of file
+};
+
+class IMDDFTBoxProblem: public MDDFTBoxProblem {
+public:
+    IMDDFTBoxProblem() {
+        sign = 1;
+    }
+    IMDDFTBoxProblem(const std::vector<void*>& args1, const std::vector<int>& sizes1,
+                     const box_t<3>& box, std::string name1) :
+        MDDFTBoxProblem(args1, sizes1, box, name1) {
+        sign = 1;
+    }
+};
@@ -1,3 +1,6 @@
+#ifndef FFTX_MDPRDFTOBJ_HEADER
+#define FFTX_MDPRDFTOBJ_HEADER
+
 using namespace fftx;
 
 // static constexpr auto mdprdft_script{
@@ -26,23 +29,51 @@ static std::string mdprdft_script = "szhalfcube := DropLast(szcube,1)::[Int(Last
     var_3:= Y;\n\
     symvar := var(\"sym\", TPtr(TReal));\n\
     transform := TFCall(TDecl(TDAG([\n\
-           TDAGNode(TTensorI(MDPRDFT(szcube,sign),1,APar, APar), var_3,var_2),\n\
+           TDAGNode(TTensorI(prdft(szcube,sign),batch,APar, APar), var_3,var_2),\n\
                   ]),\n\
             [var_1]\n\
             ),\n\
         rec(fname:=name, params:= [symvar])\n\
     );";
 
-
+// MDPRDFT of sign -1, from real fields to the half spectrum;
+// IMDPRDFTProblem in imdprdftObj.hpp is the inverse, with sign 1.
 class MDPRDFTProblem: public FFTXProblem {
 public:
     using FFTXProblem::FFTXProblem;
     void randomProblemInstance() {
     }
     void semantics() {
-        std::cout << "szcube := [" << sizes.at(0) << ", " << sizes.at(1) << ", " << sizes.at(2) << "];" << std::endl;
-        std::cout << "sign := -1;" << std::endl;
+        std::cout << "szcube := " << spiralExtents(planSizes()) << ";" << std::endl;
+        std::cout << "prdft := " << (sign == -1 ? "MDPRDFT" : "IMDPRDFT") << ";" << std::endl;
+        std::cout << "batch := " << problemBatch(sizes) << ";" << std::endl;
+        std::cout << "sign := " << sign << ";" << std::endl;
         std::cout << "name := \""<< name << "_spiral" << "\";" << std::endl;
         std::cout << mdprdft_script << std::endl;
     }
+    bool checkSpec(fftx_check::spec& s) {
+        s = fftx_check::layoutSpec(name, sign == -1 ? fftx_check::R2C : fftx_check::C2R,
+                                   problemExtents(sizes), sign, layout);
+        s.batch = problemBatch(sizes);
+        return true;
+    }
+    // the traced plans take interleaved complex fields one after another
+    // (APar) only, with the truncated axis fastest in memory (planGenerated):
+    // C order truncated last or Fortran order truncated first
+    bool layoutSupported(const fftx::layout_t& a_layout) {
+        return !a_layout.interleaved() && !a_layout.split() && a_layout.rowMajor == a_layout.truncLast;
+    }
+protected:
+    int sign = -1;
+    std::vector<int> planSizes() {
+        return layoutSizes(sizes, layout);
+    }
+    // the generated code truncates the fastest axis in memory: the last
+    // axis in C order, the first in Fortran order
+    bool planGenerated() {
+        int dim = problemDim(sizes);
+        return layout.physicalTruncAxis(dim) == dim - 1;
+    }
 };
+
+#endif
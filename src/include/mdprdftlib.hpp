@@ -9,7 +9,7 @@ static constexpr auto mdprdft_script{
     var_3:= Y;
     symvar := var("sym", TPtr(TReal));
     transform := TFCall(TDecl(TDAG([
-           TDAGNode(TTensorI(prdft(szcube,sign),1,APar, APar), var_3,var_2),
+           TDAGNode(TTensorI(prdft(szcube,sign),batch,write, read), var_3,var_2),
                   ]),
             [var_1]
             ),
@@ -18,30 +18,156 @@ static constexpr auto mdprdft_script{
     )"
 };
 
+// MDPRDFT of sign -1, from real fields to the half spectrum; IMDPRDFTProblem
+// below is the inverse, with sign 1, from the half spectrum back to real
+// fields.  The real fields are argument 1 of the forward transform and
+// argument 0 of the inverse, the spectrum the other one.
 class MDPRDFTProblem: public FFTXProblem {
 public:
     using FFTXProblem::FFTXProblem;
     void randomProblemInstance() {
     }
     void semantics() {
-        std::cout << "szcube := [" << sizes.at(0) << ", " << sizes.at(1) << ", " << sizes.at(2) << "];" << std::endl;
-        std::cout << "prdft := MDPRDFT;" << std::endl;
-        std::cout << "sign := -1;" << std::endl;
+        std::cout << "szcube := " << spiralExtents(planSizes()) << ";" << std::endl;
+        std::cout << "prdft := " << (forward() ? "MDPRDFT" : "IMDPRDFT") << ";" << std::endl;
+        std::cout << "batch := " << problemBatch(sizes) << ";" << std::endl;
+        std::cout << "write := " << spiralComponents(layout.outComponents) << ";" << std::endl;
+        std::cout << "read := " << spiralComponents(layout.inComponents) << ";" << std::endl;
+        std::cout << "sign := " << sign << ";" << std::endl;
         std::cout << "name := \""<< name << "_spiral" << "\";" << std::endl;
         std::cout << mdprdft_script << std::endl;
     }
+    bool checkSpec(fftx_check::spec& s) {
+        s = fftx_check::layoutSpec(name, forward() ? fftx_check::R2C : fftx_check::C2R,
+                                   problemExtents(sizes), sign, layout);
+        s.batch = problemBatch(sizes);
+        return !layout.interleaved() && !layout.split();
+    }
+    // the real fields are not split; components are interleaved, or the
+    // spectrum split, not both.  The device runs only generated code (see
+    // planGenerated): the truncated axis fastest in memory, which is C order
+    // truncated last or Fortran order truncated first, an SOA spectrum, and
+    // no split values.
+    bool layoutSupported(const fftx::layout_t& a_layout) {
+#if defined (FFTX_CUDA) || defined (FFTX_HIP)
+        fftx::componentOrder spec = forward() ? a_layout.outComponents : a_layout.inComponents;
+        if(a_layout.rowMajor != a_layout.truncLast || spec == fftx::AOS || a_layout.split())
+            return false;
+#endif
+        fftx::complexFormat real = forward() ? a_layout.inComplex : a_layout.outComplex;
+        return real == fftx::INTERLEAVED && !(a_layout.interleaved() && a_layout.split());
+    }
+#if !defined (FFTX_CUDA) && !defined (FFTX_HIP)
+    bool nativeTransform() {
+        std::vector<int> n = layout.physical(problemExtents(sizes));
+        int trunc = layout.physicalTruncAxis(n.size());
+        size_t npts = 1;
+        for(int e : n) npts *= e;
+        std::vector<int> half = n;
+        half[trunc] = n[trunc]/2 + 1;
+        size_t nspec = npts / n[trunc] * half[trunc];
+        int realArg = forward() ? 1 : 0, specArg = 1 - realArg;
+        double * real = (double*)args.at(realArg);
+        if(layout.split()) {
+            if(!views.empty())
+                return false;
+            fftx_native::splitArray spec = complexArg(specArg);
+            for(int b = 0; b < problemBatch(sizes); b++) {
+                if(forward())
+                    fftx_native::mdprdft(n.size(), n.data(), trunc, spec + b*nspec, real + b*npts);
+                else
+                    fftx_native::imdprdft(n.size(), n.data(), trunc, real + b*npts, spec + b*nspec);
+            }
+            return true;
+        }
+        size_t realField = npts, specField = nspec;
+        const size_t * realStride = componentStrides(realArg, n, realField);
+        const size_t * specStride = componentStrides(specArg, half, specField);
+        std::complex<double> * spec = (std::complex<double>*)args.at(specArg);
+        for(int b = 0; b < problemBatch(sizes); b++) {
+            if(forward())
+                fftx_native::mdprdft(n.size(), n.data(), trunc, spec + b*specField, specStride,
+                                     real + b*realField, realStride);
+            else
+                fftx_native::imdprdft(n.size(), n.data(), trunc, real + b*realField, realStride,
+                                      spec + b*specField, specStride);
+        }
+        return true;
+    }
+    bool viewsSupported() {
+        return true;
+    }
+#endif
+protected:
+    int sign = -1;
+    bool forward() const {
+        return sign == -1;
+    }
+    std::vector<int> planSizes() {
+        return layoutSizes(sizes, layout);
+    }
+    // the generated code truncates the fastest axis in memory: the last
+    // axis in C order, the first in Fortran order; AVec on the half
+    // spectrum would interleave real and imaginary parts, so AOS
+    // components of the spectrum run natively, as do split layouts, which
+    // the script does not take
+    bool planGenerated() {
+        int dim = problemDim(sizes);
+        fftx::componentOrder spec = forward() ? layout.outComponents : layout.inComponents;
+        return layout.physicalTruncAxis(dim) == dim - 1 && spec == fftx::SOA && !layout.split();
+    }
 };
 
-class IMDPRDFTProblem: public FFTXProblem {
+class IMDPRDFTProblem: public MDPRDFTProblem {
 public:
-    using FFTXProblem::FFTXProblem;
-    void randomProblemInstance() {
+    IMDPRDFTProblem() {
+        sign = 1;
+    }
+    IMDPRDFTProblem(std::string name1) :
+        MDPRDFTProblem(name1) {
+        sign = 1;
+    }
+    IMDPRDFTProblem(const std::vector<void*>& args1, const std::vector<int>& sizes1, std::string name1) :
+        MDPRDFTProblem(args1, sizes1, name1) {
+        sign = 1;
+    }
+};
+
+// The box of the output of MDPRDFT given by the box_t, a box of the half
+// spectrum in the layout of MDPRDFTProblem; as MDDFTBoxProblem, Y holds
+// only the box and sizes are {n0, n1, n2, batch, lo0, lo1, lo2, hi0, hi1, hi2}.
+class MDPRDFTBoxProblem: public MDDFTBoxProblem {
+public:
+    MDPRDFTBoxProblem() {
+    }
+    MDPRDFTBoxProblem(const std::vector<void*>& args1, const std::vector<int>& sizes1,
+                      const box_t<3>& box, std::string name1) :
+        MDDFTBoxProblem(args1, sizes1, box, name1, FFTX_COMPLEX_TRUNC_LAST ? 2 : 0) {
     }
     void semantics() {
-        std::cout << "szcube := [" << sizes.at(0) << ", " << sizes.at(1) << ", " << sizes.at(2) << "];" << std::endl;
-        std::cout << "prdft := IMDPRDFT;" << std::endl;
-        std::cout << "sign := 1;" << std::endl;
+        fftx_dag::graph g = fftx_dag::subBoxTransform(fftx_dag::PRDFT, cube(), boxLo(), boxExtents(),
+                                                      -1, problemBatch(sizes));
+        if(fftx_dag::fusionEnabled())
+            g.fuse();
         std::cout << "name := \""<< name << "_spiral" << "\";" << std::endl;
-        std::cout << mdprdft_script << std::endl;
+        std::cout << g.script() << std::endl;
+    }
+#if !defined (FFTX_CUDA) && !defined (FFTX_HIP)
+    bool nativeTransform() {
+        std::vector<int> n = cube(), lo = boxLo(), m = boxExtents();
+        int trunc = FFTX_COMPLEX_TRUNC_LAST ? 2 : 0;
+        #if !FFTX_ROW_MAJOR_ORDER
+        std::reverse(n.begin(), n.end());
+        std::reverse(lo.begin(), lo.end());
+        std::reverse(m.begin(), m.end());
+        trunc = 2 - trunc;
+        #endif
+        size_t npts = (size_t)n[0] * n[1] * n[2];
+        size_t nbox = (size_t)m[0] * m[1] * m[2];
+        for(int b = 0; b < problemBatch(sizes); b++)
+            fftx_native::mdprdftBox(3, n.data(), trunc, (std::complex<double>*)args.at(0) + b*nbox,
+                                    (double*)args.at(1) + b*npts, lo.data(), m.data());
+        return true;
     }
+#endif
 };
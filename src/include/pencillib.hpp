@@ -0,0 +1,121 @@
+#ifndef FFTX_PENCIL_HEADER
+#define FFTX_PENCIL_HEADER
+
+//  Copyright (c) 2018-2022, Carnegie Mellon University
+//  See LICENSE for details
+
+#include "interface.hpp"
+#include "batch1ddftObj.hpp"
+#include "ibatch1ddftObj.hpp"
+
+/*
+ 3D complex DFT of any size [X, Y, Z] on a single node (CPU), composed of
+ three passes of batched 1D DFTs along the contiguous axis, the same stages
+ the distributed plans in lib_fftx_mpi use.  After each pass a cache-blocked,
+ threaded transpose rotates the next axis into the contiguous position:
+
+   [X][Y][Z] --DFT(Z), transpose--> [Z][X][Y] --DFT(Y), transpose--> [Y][Z][X]
+             --DFT(X), transpose--> [X][Y][Z]
+
+ Only the 1D lengths need code generation (BATCH1DDFTProblem for forward,
+ IBATCH1DDFTProblem for inverse), and the stage kernels are cached by
+ (length, batch) in the stage problem objects.  Without SPIRAL the stages
+ run on the native engine.  Transforms are unnormalized, like MDDFT and
+ IMDDFT; the input array is not modified.
+*/
+
+#if !defined (FFTX_CUDA) && !defined (FFTX_HIP)
+
+class MDDFTPencilProblem {
+public:
+
+    std::vector<void*> args;
+    std::vector<int> sizes;
+    std::string name;
+
+    MDDFTPencilProblem() {
+    }
+    MDDFTPencilProblem(const std::vector<void*>& args1, const std::vector<int>& sizes1) {
+        args = args1;
+        sizes = sizes1;
+    }
+    MDDFTPencilProblem(const std::vector<void*>& args1, const std::vector<int>& sizes1, std::string name1) {
+        args = args1;
+        sizes = sizes1;
+        name = name1;
+    }
+
+    void setSizes(const std::vector<int>& sizes1) { sizes = sizes1; }
+    void setArgs(const std::vector<void*>& args1) { args = args1; }
+    void setName(std::string name1) { name = name1; }
+    void transform();
+    // total time of the last transform, and the part of it spent in transposes (ms)
+    float getTime() { return gpuTime; }
+    float getTransposeTime() { return transposeTime; }
+
+protected:
+    int sign = -1;
+    float gpuTime = 0.;
+    float transposeTime = 0.;
+    std::vector<std::complex<double>> work;
+    BATCH1DDFTProblem fstg;
+    IBATCH1DDFTProblem istg;
+
+    void runStage(int len, int lines, std::complex<double> * dst, std::complex<double> * src);
+};
+
+class IMDDFTPencilProblem: public MDDFTPencilProblem {
+public:
+    IMDDFTPencilProblem() {
+        sign = 1;
+    }
+    IMDDFTPencilProblem(const std::vector<void*>& args1, const std::vector<int>& sizes1) :
+        MDDFTPencilProblem(args1, sizes1) {
+        sign = 1;
+    }
+    IMDDFTPencilProblem(const std::vector<void*>& args1, const std::vector<int>& sizes1, std::string name1) :
+        MDDFTPencilProblem(args1, sizes1, name1) {
+        sign = 1;
+    }
+};
+
+inline void MDDFTPencilProblem::runStage(int len, int lines, std::complex<double> * dst, std::complex<double> * src) {
+    std::vector<int> stgsizes{len, lines, 0, 0};
+    std::vector<void*> stgargs{(void*)dst, (void*)src, nullptr};
+    FFTXProblem& stg = (sign < 0) ? (FFTXProblem&)fstg : (FFTXProblem&)istg;
+    stg.setName((sign < 0) ? "b1dft" : "ib1dft");
+    stg.setSizes(stgsizes);
+    stg.setArgs(stgargs);
+    stg.transform();
+    gpuTime += stg.getTime();
+}
+
+inline void MDDFTPencilProblem::transform() {
+    int n[3] = {sizes.at(0), sizes.at(1), sizes.at(2)};
+    #if !FFTX_ROW_MAJOR_ORDER
+    std::swap(n[0], n[2]);
+    #endif
+    size_t npts = (size_t)n[0] * n[1] * n[2];
+    if(work.size() != npts)
+        work.resize(npts);
+    std::complex<double> * out = (std::complex<double>*)args.at(0);
+    std::complex<double> * src = (std::complex<double>*)args.at(1);
+    gpuTime = 0.;
+    transposeTime = 0.;
+    for(int pass = 0; pass < 3; pass++) {
+        int len = n[2 - pass];
+        int lines = (int)(npts / len);
+        runStage(len, lines, work.data(), src);
+        auto start = std::chrono::high_resolution_clock::now();
+        fftx_native::transpose(work.data(), out, lines, len);
+        auto stop = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<float, std::milli> duration = stop - start;
+        transposeTime += duration.count();
+        src = out;
+    }
+    gpuTime += transposeTime;
+}
+
+#endif
+
+#endif            // FFTX_PENCIL_HEADER
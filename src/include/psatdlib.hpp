@@ -0,0 +1,250 @@
+#ifndef FFTX_PSATDLIB_HEADER
+#define FFTX_PSATDLIB_HEADER
+
+//  Copyright (c) 2018-2022, Carnegie Mellon University
+//  See LICENSE for details
+
+#include <sstream>
+#include "interface.hpp"
+#include "fftxdag.hpp"
+
+using namespace fftx;
+
+/*
+ PSATD (pseudo-spectral analytical time domain) field update of WarpX, the
+ pipeline of src/library/fftx_psatd-frame.g for any grid: the 11 staggered
+ real input fields (E, B, J, and rho at the old and new time) are
+ resampled to the cell-centred grid, transformed by a batch of real DFTs,
+ updated pointwise by the 6x11 matrix built from the 8 symbol arrays, and
+ the 6 updated fields (E, B) are transformed back and resampled onto their
+ staggered grids.
+
+ The problem sizes are the cell-centred grid {nx, ny, nz}.  Every field is
+ stored x fastest, [nz][ny][nx], with one point more along the axes on
+ which it is nodal (psatdStagger).  The arguments are {Y, X, sym}, each an
+ array of pointers: to the 6 output fields, to the 11 input fields, and to
+ the 8 symbol arrays kx, ky, kz (nx/2+1, ny and nz doubles) and C, S_ck,
+ X1, X2, X3 (one double per point of the spectrum, [nz][ny][nx/2+1]).  On
+ the GPU backends the arrays of pointers and the fields they point to live
+ on the device.
+
+     double * Y[6] = { ex, ey, ez, bx, by, bz };
+     double * X[11] = { ex, ey, ez, bx, by, bz, jx, jy, jz, rho0, rho1 };
+     double * S[8] = { kx, ky, kz, c, s_ck, x1, x2, x3 };
+     PSATDProblem psatd(std::vector<void*>{Y, X, S}, std::vector<int>{nx, ny, nz}, "psatd");
+     psatd.transform();
+
+ The script is the fftx_dag::graph of psatdGraph, the update matrix a RAW
+ node; on CPU, without SPIRAL, the same steps run on the native engine.
+*/
+
+static const int PSATD_INPUTS = 11;
+static const int PSATD_OUTPUTS = 6;
+
+// 1 along the axes (z, y, x) on which input field f is nodal; output r is
+// staggered as input r.
+static const int psatdStagger[PSATD_INPUTS][3] = {
+    {1, 1, 0}, {1, 0, 1}, {0, 1, 1},    // Ex, Ey, Ez
+    {0, 0, 1}, {0, 1, 0}, {1, 0, 0},    // Bx, By, Bz
+    {1, 1, 0}, {1, 0, 1}, {0, 1, 1},    // Jx, Jy, Jz
+    {1, 1, 1}, {1, 1, 1}                // rho old, rho new
+};
+
+enum psatdFactor { PSATD_ONE = 0, PSATD_C2 = 1, PSATD_INVEP0 = 2 };
+
+// Entry of the update matrix: Y[row] gets X[col] times
+// sign * k[kdir] * factor * sym[symbol] / (nx ny nz), times i if imag
+// (kdir -1: no wavenumber).
+struct psatdEntry {
+    int row, col;
+    bool imag;
+    int sign, kdir;
+    psatdFactor factor;
+    int symbol;
+};
+
+static const psatdEntry psatdMatrix[] = {
+    {0, 0, false,  1, -1, PSATD_ONE, 3}, {0, 4, true, -1, 2, PSATD_C2, 4},
+    {0, 5, true,  1, 1, PSATD_C2, 4}, {0, 6, false, -1, -1, PSATD_INVEP0, 4},
+    {0, 9, true,  1, 0, PSATD_ONE, 7}, {0, 10, true, -1, 0, PSATD_ONE, 6},
+    {1, 1, false,  1, -1, PSATD_ONE, 3}, {1, 3, true,  1, 2, PSATD_C2, 4},
+    {1, 5, true, -1, 0, PSATD_C2, 4}, {1, 7, false, -1, -1, PSATD_INVEP0, 4},
+    {1, 9, true,  1, 1, PSATD_ONE, 7}, {1, 10, true, -1, 1, PSATD_ONE, 6},
+    {2, 2, false,  1, -1, PSATD_ONE, 3}, {2, 3, true, -1, 1, PSATD_C2, 4},
+    {2, 4, true,  1, 0, PSATD_C2, 4}, {2, 8, false, -1, -1, PSATD_INVEP0, 4},
+    {2, 9, true,  1, 2, PSATD_ONE, 7}, {2, 10, true, -1, 2, PSATD_ONE, 6},
+    {3, 1, true,  1, 2, PSATD_ONE, 4}, {3, 2, true, -1, 1, PSATD_ONE, 4},
+    {3, 3, false,  1, -1, PSATD_ONE, 3}, {3, 7, true, -1, 2, PSATD_ONE, 5},
+    {3, 8, true,  1, 1, PSATD_ONE, 5},
+    {4, 0, true, -1, 2, PSATD_ONE, 4}, {4, 2, true,  1, 0, PSATD_ONE, 4},
+    {4, 4, false,  1, -1, PSATD_ONE, 3}, {4, 6, true,  1, 2, PSATD_ONE, 5},
+    {4, 8, true, -1, 0, PSATD_ONE, 5},
+    {5, 0, true,  1, 1, PSATD_ONE, 4}, {5, 1, true, -1, 0, PSATD_ONE, 4},
+    {5, 5, false,  1, -1, PSATD_ONE, 3}, {5, 6, true, -1, 1, PSATD_ONE, 5},
+    {5, 7, true,  1, 0, PSATD_ONE, 5}
+};
+
+static const double PSATD_C = 299792458.;
+static const double PSATD_EP0 = 8.8541878128e-12;
+
+/** Extents [z, y, x] of input field a_field on the grid a_sizes = {nx, ny, nz}. */
+inline std::vector<int> psatdExtents(const std::vector<int>& a_sizes, int a_field) {
+    std::vector<int> ext(3);
+    for(int d = 0; d < 3; d++)
+        ext[d] = a_sizes.at(2 - d) + psatdStagger[a_field][d];
+    return ext;
+}
+
+/** Shift of field a_field by a_half cell along the axes on which it is cell-centred. */
+inline std::vector<double> psatdShift(int a_field, double a_half) {
+    std::vector<double> shift(3);
+    for(int d = 0; d < 3; d++)
+        shift[d] = psatdStagger[a_field][d] ? 0. : a_half;
+    return shift;
+}
+
+/** Graph of the PSATD update on the grid a_sizes = {nx, ny, nz}. */
+inline fftx_dag::graph psatdGraph(const std::vector<int>& a_sizes) {
+    static const char * symbols[8] = { "sym_kx", "sym_ky", "sym_kz", "sym_C",
+                                       "sym_S_ck", "sym_X1", "sym_X2", "sym_X3" };
+    static const char * factors[3] = { "", "c2 * ", "invep0 * " };
+    int nx = a_sizes.at(0), ny = a_sizes.at(1), nz = a_sizes.at(2);
+    std::vector<int> n{nz, ny, nx};
+    std::vector<int> h = fftx_dag::halfExtents(n);
+
+    fftx_dag::graph g;
+    std::vector<fftx_dag::var> x, y;
+    for(int f = 0; f < PSATD_INPUTS; f++)
+        x.push_back(g.input(psatdExtents(a_sizes, f)));
+    for(int r = 0; r < PSATD_OUTPUTS; r++)
+        y.push_back(g.output(psatdExtents(a_sizes, r)));
+    fftx_dag::var centred = g.local({PSATD_INPUTS, nz, ny, nx});
+    fftx_dag::var spectra = g.local({PSATD_INPUTS, nz, ny, h[2]}, fftx_dag::COMPLEX);
+    fftx_dag::var updated = g.local({PSATD_OUTPUTS, nz, ny, h[2]}, fftx_dag::COMPLEX);
+    fftx_dag::var result = g.local({PSATD_OUTPUTS, nz, ny, nx});
+
+    for(int f = 0; f < PSATD_INPUTS; f++)
+        g.resample(g.component(centred, f), x[f], psatdShift(f, -0.5));
+    g.prdft(spectra, centred, n, PSATD_INPUTS);
+    std::ostringstream update;
+    update << "    TDAGNode(TRC(TMap(rmat, [iz, iy, ix], AVec, AVec)), var_" << updated.id
+           << ", var_" << spectra.id << "),";
+    fftx_dag::node nd;
+    nd.op = fftx_dag::RAW;
+    nd.text = update.str();
+    g.addNode(nd);
+    g.iprdft(result, updated, n, PSATD_OUTPUTS);
+    for(int r = 0; r < PSATD_OUTPUTS; r++)
+        g.resample(y[r], g.component(result, r), psatdShift(r, 0.5));
+
+    std::ostringstream os;
+    os << "ix := Ind(" << h[2] << ");\n";
+    os << "iy := Ind(" << ny << ");\n";
+    os << "iz := Ind(" << nz << ");\n";
+    os << "c := 299792458;\n";
+    os << "c2 := c^2;\n";
+    os << "ep0 := 8.8541878128e-12;\n";
+    os << "invep0 := 1.0 / ep0;\n";
+    os << "ii := lin_idx(iz, iy, ix);\n";
+    for(int s = 0; s < 8; s++)
+        os << symbols[s] << " := nth(nth(symvar, " << s << "), "
+           << (s == 0 ? "ix" : s == 1 ? "iy" : s == 2 ? "iz" : "ii") << ");\n";
+    os << "div := " << (size_t)nx * ny * nz << ";\n";
+    os << "rmat := TSparseMat([" << PSATD_OUTPUTS << ", " << PSATD_INPUTS << "], [";
+    int row = -1;
+    for(const psatdEntry& e : psatdMatrix) {
+        if(e.row != row) {
+            os << (row < 0 ? "" : "],") << "\n    [" << e.row;
+            row = e.row;
+        }
+        std::ostringstream v;
+        v << (e.sign < 0 ? "-" : "");
+        if(e.kdir >= 0)
+            v << symbols[e.kdir] << " * ";
+        v << factors[e.factor] << symbols[e.symbol] << "/div";
+        os << ", [" << e.col << ", " << (e.imag ? "cxpack(0, " + v.str() + ")" : v.str()) << "]";
+    }
+    os << "]\n]);";
+    g.addScript(os.str());
+    g.setSymbolArrays(true);
+    return g;
+}
+
+class PSATDProblem: public FFTXProblem {
+public:
+    using FFTXProblem::FFTXProblem;
+    void randomProblemInstance() {
+    }
+    void semantics() {
+        // the update matrix needs the WarpX configuration on CPU and CUDA;
+        // HIP keeps the default JIT configuration
+        #if defined FFTX_CUDA
+        std::cout << "conf := FFTXGlobals.confWarpXCUDADevice();" << std::endl;
+        #elif !defined FFTX_HIP
+        std::cout << "conf := FFTXGlobals.defaultWarpXConf();" << std::endl;
+        #endif
+        std::cout << "name := \""<< name << "_spiral" << "\";" << std::endl;
+        std::cout << psatdGraph(sizes).script() << std::endl;
+    }
+#if !defined (FFTX_CUDA) && !defined (FFTX_HIP)
+    bool nativeTransform();
+
+protected:
+    std::vector<double> fields;
+    std::vector<std::complex<double>> spectra, updated;
+#endif
+};
+
+#if !defined (FFTX_CUDA) && !defined (FFTX_HIP)
+
+// The nodes of psatdGraph in order: resampling of each input to the
+// centred grid, the forward transforms, the update matrix at each point of
+// the spectrum, the inverse transforms and resampling of each output.
+inline bool PSATDProblem::nativeTransform() {
+    typedef std::complex<double> cplx;
+    int nx = sizes.at(0), ny = sizes.at(1), nz = sizes.at(2);
+    std::vector<int> n{nz, ny, nx};
+    size_t npts = (size_t)nx * ny * nz;
+    int hx = nx/2 + 1;
+    size_t nspec = (size_t)nz * ny * hx;
+    double ** Y = (double**)args.at(0);
+    double ** X = (double**)args.at(1);
+    const double * const * sym = (const double * const *)args.at(2);
+    fields.resize(PSATD_INPUTS * npts);
+    spectra.resize(PSATD_INPUTS * nspec);
+    updated.resize(PSATD_OUTPUTS * nspec);
+
+    for(int f = 0; f < PSATD_INPUTS; f++) {
+        std::vector<int> ext = psatdExtents(sizes, f);
+        std::vector<double> shift = psatdShift(f, -0.5);
+        fftx_native::mdresample(3, ext.data(), n.data(), shift.data(), fields.data() + f*npts, X[f]);
+        fftx_native::mdprdft(3, n.data(), 2, spectra.data() + f*nspec, fields.data() + f*npts);
+    }
+    const double factor[3] = { 1., PSATD_C * PSATD_C, 1. / PSATD_EP0 };
+    const double scale = 1. / npts;
+    fftx_native::parallelFor(nspec, 64, [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            const double k[3] = { sym[0][i % hx], sym[1][(i / hx) % ny], sym[2][i / ((size_t)ny * hx)] };
+            cplx out[PSATD_OUTPUTS];
+            for(const psatdEntry& e : psatdMatrix) {
+                double v = e.sign * factor[e.factor] * sym[e.symbol][i] * scale;
+                if(e.kdir >= 0)
+                    v *= k[e.kdir];
+                out[e.row] += (e.imag ? cplx(0., v) : cplx(v, 0.)) * spectra[e.col*nspec + i];
+            }
+            for(int r = 0; r < PSATD_OUTPUTS; r++)
+                updated[r*nspec + i] = out[r];
+        }
+    });
+    for(int r = 0; r < PSATD_OUTPUTS; r++) {
+        std::vector<int> ext = psatdExtents(sizes, r);
+        std::vector<double> shift = psatdShift(r, 0.5);
+        fftx_native::imdprdft(3, n.data(), 2, fields.data() + r*npts, updated.data() + r*nspec);
+        fftx_native::mdresample(3, n.data(), ext.data(), shift.data(), Y[r], fields.data() + r*npts);
+    }
+    return true;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef FFTX_R2RLIB_HEADER
+#define FFTX_R2RLIB_HEADER
+
+//  Copyright (c) 2018-2022, Carnegie Mellon University
+//  See LICENSE for details
+
+#include "interface.hpp"
+
+using namespace fftx;
+
+/*
+ Real-to-real transforms: DCT and DST of types I, II and III, in 1, 2 or 3
+ dimensions, for fast Poisson solvers with Neumann (DCT) and Dirichlet
+ (DST) boundary conditions.  The transforms are the unscaled SPIRAL
+ matrices DCT1 .. DST3 (fftx_native::r2rKind), applied along every axis.
+ DCT3 and DST3 are the transposes of DCT2 and DST2: along an axis of
+ length n, DCT3 undoes DCT2 up to a factor n/2 once the coefficient of
+ index 0 is halved, and DST3 undoes DST2 once that of index n-1 is.
+
+ The problem sizes are {n0, n1, n2, batch, dim, kind}, built by r2rSizes:
+ the extents of a dim-dimensional array are the last dim of n0, n1, n2,
+ the others 1.  The arguments are {Y, X, sym} with X and Y real, batch
+ arrays one after the other, and sym unused.
+
+     DCT2Problem dp(std::vector<void*>{out, in, nullptr}, {nn, kk}, "dct2");
+     dp.transform();
+
+ In 3D, with batch 1, the pairs DCT2/DCT3 and DST2/DST3 are in the fixed
+ libraries under the names "mddct"/"imddct" and "mddst"/"imddst".
+*/
+
+static constexpr auto r2r_script{
+    R"(var_1:= var("var_1", BoxND([0,0,0], TReal));
+    var_2:= var("var_2", BoxND([batch]::szcube, TReal));
+    var_3:= var("var_3", BoxND([batch]::szcube, TReal));
+    var_2:= X;
+    var_3:= Y;
+    symvar := var("sym", TPtr(TReal));
+    transform := TFCall(TDecl(TDAG([
+           TDAGNode(TTensorI(dtt,batch,APar, APar), var_3,var_2),
+                  ]),
+            [var_1]
+            ),
+        rec(fname:=name, params:= [symvar])
+    );
+    )"
+};
+
+/** Sizes of a real-to-real problem of a_kind on extents a_n (1 to 3 of them). */
+inline std::vector<int> r2rSizes(fftx_native::r2rKind a_kind, const std::vector<int>& a_n,
+                                 int a_batch = 1)
+{
+    std::vector<int> sizes(3, 1);
+    std::copy(a_n.begin(), a_n.end(), sizes.end() - a_n.size());
+    sizes.push_back(a_batch);
+    sizes.push_back((int)a_n.size());
+    sizes.push_back((int)a_kind);
+    return sizes;
+}
+
+class R2RProblem: public FFTXProblem {
+public:
+    using FFTXProblem::FFTXProblem;
+    void randomProblemInstance() {
+    }
+    void semantics() {
+        int dim = r2rDim();
+        static const char * kinds[] = { "DCT1", "DCT2", "DCT3", "DST1", "DST2", "DST3" };
+        std::string op = std::string(kinds[r2rKind()]) + "(";
+        std::cout << "szcube := [";
+        for(int d = 3 - dim; d < 3; d++)
+            std::cout << sizes.at(d) << ((d < 2) ? ", " : "");
+        std::cout << "];" << std::endl;
+        std::string dtt = op + std::to_string(sizes.at(3 - dim)) + ")";
+        for(int d = 4 - dim; d < 3; d++)
+            dtt = "TTensor(" + dtt + ", " + op + std::to_string(sizes.at(d)) + "))";
+        std::cout << "dtt := " << dtt << ";" << std::endl;
+        std::cout << "batch := " << problemBatch(sizes) << ";" << std::endl;
+        std::cout << "name := \""<< name << "_spiral" << "\";" << std::endl;
+        std::cout << r2r_script << std::endl;
+    }
+#if !defined (FFTX_CUDA) && !defined (FFTX_HIP)
+    bool nativeTransform() {
+        int dim = r2rDim();
+        std::vector<int> n(sizes.begin() + 3 - dim, sizes.begin() + 3);
+        #if !FFTX_ROW_MAJOR_ORDER
+        std::reverse(n.begin(), n.end());
+        #endif
+        size_t npts = 1;
+        for(int e : n) npts *= e;
+        for(int b = 0; b < problemBatch(sizes); b++)
+            fftx_native::mdr2r(dim, n.data(), r2rKind(), (double*)args.at(0) + b*npts,
+                               (double*)args.at(1) + b*npts);
+        return true;
+    }
+#endif
+
+protected:
+    int r2rDim() const {
+        return (sizes.size() > 4) ? sizes.at(4) : 3;
+    }
+    fftx_native::r2rKind r2rKind() const {
+        return (fftx_native::r2rKind)((sizes.size() > 5) ? sizes.at(5) : fftx_native::R2R_DCT2);
+    }
+};
+
+/** R2RProblem of one kind, on 1 to 3 extents. */
+template <fftx_native::r2rKind KIND>
+class R2RKindProblem: public R2RProblem {
+public:
+    R2RKindProblem(const std::vector<void*>& args, const std::vector<int>& n,
+                   std::string name, int batch = 1)
+        : R2RProblem(args, r2rSizes(KIND, n, batch), name) {
+    }
+};
+
+typedef R2RKindProblem<fftx_native::R2R_DCT1> DCT1Problem;
+typedef R2RKindProblem<fftx_native::R2R_DCT2> DCT2Problem;
+typedef R2RKindProblem<fftx_native::R2R_DCT3> DCT3Problem;
+typedef R2RKindProblem<fftx_native::R2R_DST1> DST1Problem;
+typedef R2RKindProblem<fftx_native::R2R_DST2> DST2Problem;
+typedef R2RKindProblem<fftx_native::R2R_DST3> DST3Problem;
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef FFTX_RESAMPLELIB_HEADER
+#define FFTX_RESAMPLELIB_HEADER
+
+//  Copyright (c) 2018-2022, Carnegie Mellon University
+//  See LICENSE for details
+
+#include <sstream>
+#include "interface.hpp"
+
+using namespace fftx;
+
+/*
+ Fourier resampling of a real periodic field from extents {n0, n1, n2} to
+ extents {m0, m1, m2} (up or down along each axis), shifted by s[d]
+ destination grid spacings along axis d: the output is the band-limited
+ interpolant of the input evaluated at the points (j + s) / m, with a
+ Nyquist coefficient of the input split between +n/2 and -n/2 and the
+ modes beyond m/2 dropped (fftx_native::resampleAxis).
+
+ The problem is one TResample node, which SPIRAL generates as a single
+ pruned kernel: the forward transform, the truncation or zero padding of
+ the spectrum with the shift, and the inverse transform fused, with no
+ zero-padded array.  On CPU without SPIRAL the native engine does the
+ same, one fused line pass per axis (fftx_native::mdresample).
+
+ The problem sizes are {n0, n1, n2, batch, m0, m1, m2, p0, p1, p2}, built
+ by resampleSizes, with the shift s[d] = p[d] / resampleShiftDenominator
+ so that it is part of the key of the in-memory and disk caches.  The
+ arguments are {Y, X, sym} with X and Y real, batch fields one after the
+ other, and sym unused.
+
+     ResampleProblem rp(std::vector<void*>{fine, coarse, nullptr},
+                        resampleSizes({nn, nn, nn}, {2*nn, 2*nn, 2*nn}, {0., 0., 0.5}),
+                        "resample");
+     rp.transform();
+
+ Refinement by 2 (m = 2n) and coarsening by 2 (m = n/2) without shift are
+ in the fixed libraries under the name "resample", by the input sizes.
+*/
+
+static constexpr int resampleShiftDenominator = 1024;
+
+static constexpr auto resample_script{
+    R"(var_1:= var("var_1", BoxND([0,0,0], TReal));
+    var_2:= var("var_2", BoxND([batch]::szsrc, TReal));
+    var_3:= var("var_3", BoxND([batch]::szdst, TReal));
+    var_2:= X;
+    var_3:= Y;
+    symvar := var("sym", TPtr(TReal));
+    transform := TFCall(TDecl(TDAG([
+           TDAGNode(TTensorI(TResample(szdst, szsrc, shift),batch,APar, APar), var_3,var_2),
+                  ]),
+            [var_1]
+            ),
+        rec(fname:=name, params:= [symvar])
+    );
+    )"
+};
+
+/**
+   Sizes of a resampling problem from extents a_src to extents a_dst, with
+   a_shift rounded to a multiple of 1/resampleShiftDenominator.
+*/
+inline std::vector<int> resampleSizes(const std::vector<int>& a_src, const std::vector<int>& a_dst,
+                                      const std::vector<double>& a_shift, int a_batch = 1)
+{
+    std::vector<int> sizes(a_src.begin(), a_src.begin() + 3);
+    sizes.push_back(a_batch);
+    sizes.insert(sizes.end(), a_dst.begin(), a_dst.begin() + 3);
+    for(int d = 0; d < 3; d++)
+        sizes.push_back((int)std::lround(a_shift.at(d) * resampleShiftDenominator));
+    return sizes;
+}
+
+class ResampleProblem: public FFTXProblem {
+public:
+    using FFTXProblem::FFTXProblem;
+    void randomProblemInstance() {
+    }
+    void semantics() {
+        std::ostringstream shift;
+        for(int d = 0; d < 3; d++)
+            shift << (d ? ", " : "") << resampleShift()[d];
+        std::cout << "szsrc := [" << sizes.at(0) << ", " << sizes.at(1) << ", " << sizes.at(2) << "];" << std::endl;
+        std::cout << "szdst := [" << sizes.at(4) << ", " << sizes.at(5) << ", " << sizes.at(6) << "];" << std::endl;
+        std::cout << "shift := [" << shift.str() << "];" << std::endl;
+        std::cout << "batch := " << problemBatch(sizes) << ";" << std::endl;
+        std::cout << "name := \""<< name << "_spiral" << "\";" << std::endl;
+        std::cout << resample_script << std::endl;
+    }
+#if !defined (FFTX_CUDA) && !defined (FFTX_HIP)
+    bool nativeTransform() {
+        std::vector<int> n(sizes.begin(), sizes.begin() + 3);
+        std::vector<int> m(sizes.begin() + 4, sizes.begin() + 7);
+        std::vector<double> s = resampleShift();
+        #if !FFTX_ROW_MAJOR_ORDER
+        std::reverse(n.begin(), n.end());
+        std::reverse(m.begin(), m.end());
+        std::reverse(s.begin(), s.end());
+        #endif
+        size_t nin = (size_t)n[0] * n[1] * n[2];
+        size_t nout = (size_t)m[0] * m[1] * m[2];
+        for(int b = 0; b < problemBatch(sizes); b++)
+            fftx_native::mdresample(3, n.data(), m.data(), s.data(),
+                                    (double*)args.at(0) + b*nout, (double*)args.at(1) + b*nin);
+        return true;
+    }
+#endif
+
+protected:
+    std::vector<double> resampleShift() const {
+        std::vector<double> s(3);
+        for(int d = 0; d < 3; d++)
+            s[d] = (double)sizes.at(7 + d) / resampleShiftDenominator;
+        return s;
+    }
+};
+
+#endif
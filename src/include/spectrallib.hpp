@@ -0,0 +1,243 @@
+#ifndef FFTX_SPECTRALLIB_HEADER
+#define FFTX_SPECTRALLIB_HEADER
+
+//  Copyright (c) 2018-2022, Carnegie Mellon University
+//  See LICENSE for details
+
+#include <sstream>
+#include "interface.hpp"
+
+using namespace fftx;
+
+/*
+ Spectral derivative operators on a real periodic field of sizes
+ {n0, n1, n2}: gradient, divergence, curl, inverse Laplacian and Leray
+ (divergence-free) projection.  Each is one plan, as in psatdlib.hpp:
+ batched MDPRDFT of the input components, one sparse matrix of i k
+ factors applied pointwise to the spectra, batched IMDPRDFT of the output
+ components, with the factors applied inside the generated kernel.
+
+ The wavenumbers are k[d][i] = 2 pi i' / L[d] along axis d, with i' = i
+ or i - n[d] (the signed frequency) and 0 at the Nyquist frequency, so
+ that every operator maps real fields to real fields and they compose:
+ div(grad(invLaplacian(f))) is f without its mean and Nyquist modes.  The
+ inverse Laplacian is -1/|k|^2, and 0 where k = 0; Leray is
+ I - k k^T / |k|^2, and I where k = 0.  The 1/(n0 n1 n2) of the inverse
+ transform is in the kernel.
+
+ The problem sizes are {n0, n1, n2, 1, op}, built by spectralSizes.  The
+ arguments are {Y, X, sym}: X and Y the input and output components, one
+ real field after another (1 for a scalar, 3 for a vector, in the order
+ of the axes), and sym an array of 3 pointers to the wavenumber arrays,
+ of n0, n1 and n2 doubles (spectralSymbol).
+
+     spectralSymbol k({nn, nn, nn}, {lx, ly, lz});
+     SpectralProblem grad(std::vector<void*>{dudxyz, u, k.pointers()},
+                          spectralSizes(SPECTRAL_GRAD, {nn, nn, nn}), "grad");
+     grad.transform();
+*/
+
+enum spectralOp { SPECTRAL_GRAD = 0, SPECTRAL_DIV = 1, SPECTRAL_CURL = 2,
+                  SPECTRAL_INVLAPLACIAN = 3, SPECTRAL_LERAY = 4 };
+
+/** Number of input and output components of a_op. */
+inline int spectralInputs(spectralOp a_op) {
+    return (a_op == SPECTRAL_GRAD || a_op == SPECTRAL_INVLAPLACIAN) ? 1 : 3;
+}
+
+inline int spectralOutputs(spectralOp a_op) {
+    return (a_op == SPECTRAL_DIV || a_op == SPECTRAL_INVLAPLACIAN) ? 1 : 3;
+}
+
+inline std::vector<int> spectralSizes(spectralOp a_op, const std::vector<int>& a_n) {
+    return std::vector<int>{a_n.at(0), a_n.at(1), a_n.at(2), 1, (int)a_op};
+}
+
+/** The wavenumber arrays of a grid of sizes a_n on a box of lengths a_lengths. */
+class spectralSymbol {
+public:
+    spectralSymbol(const std::vector<int>& a_n,
+                   const std::vector<double>& a_lengths = std::vector<double>(3, 1.)) {
+        for(int d = 0; d < 3; d++) {
+            int n = a_n.at(d);
+            m_k[d].resize(n);
+            for(int i = 0; i < n; i++) {
+                int f = (2*i < n) ? i : i - n;
+                m_k[d][i] = (2*i == n) ? 0. : 2. * M_PI * f / a_lengths.at(d);
+            }
+            m_pointers[d] = m_k[d].data();
+        }
+    }
+    spectralSymbol(const spectralSymbol&) = delete;
+    spectralSymbol& operator=(const spectralSymbol&) = delete;
+
+    /** The sym argument of SpectralProblem. */
+    void * pointers() { return (void*)m_pointers; }
+    const std::vector<double>& wavenumbers(int a_dir) const { return m_k[a_dir]; }
+
+private:
+    std::vector<double> m_k[3];
+    double * m_pointers[3];
+};
+
+class SpectralProblem: public FFTXProblem {
+public:
+    using FFTXProblem::FFTXProblem;
+    void randomProblemInstance() {
+    }
+    void semantics() {
+        spectralOp op = spectralOperator();
+        int nin = spectralInputs(op), nout = spectralOutputs(op);
+        std::cout << "szcube := [" << sizes.at(0) << ", " << sizes.at(1) << ", " << sizes.at(2) << "];" << std::endl;
+        std::cout << "szhalfcube := DropLast(szcube,1)::[Int(Last(szcube)/2)+1];" << std::endl;
+        std::cout << "nin := " << nin << ";" << std::endl;
+        std::cout << "nout := " << nout << ";" << std::endl;
+        std::cout << "name := \""<< name << "_spiral" << "\";" << std::endl;
+        std::cout << "var_1 := var(\"var_1\", BoxND([nin]::szcube, TReal));" << std::endl;
+        std::cout << "var_2 := var(\"var_2\", BoxND([nin]::szhalfcube, TComplex));" << std::endl;
+        std::cout << "var_3 := var(\"var_3\", BoxND([nout]::szhalfcube, TComplex));" << std::endl;
+        std::cout << "var_4 := var(\"var_4\", BoxND([nout]::szcube, TReal));" << std::endl;
+        std::cout << "var_1 := X;" << std::endl;
+        std::cout << "var_4 := Y;" << std::endl;
+        std::cout << "symvar := var(\"sym\", TPtr(TPtr(TReal)));" << std::endl;
+        std::cout << "i0 := Ind(szhalfcube[1]);" << std::endl;
+        std::cout << "i1 := Ind(szhalfcube[2]);" << std::endl;
+        std::cout << "i2 := Ind(szhalfcube[3]);" << std::endl;
+        std::cout << "k0 := nth(nth(symvar, 0), i0);" << std::endl;
+        std::cout << "k1 := nth(nth(symvar, 1), i1);" << std::endl;
+        std::cout << "k2 := nth(nth(symvar, 2), i2);" << std::endl;
+        std::cout << "ksq := k0 * k0 + k1 * k1 + k2 * k2;" << std::endl;
+        std::cout << "kinv := cond(eq(ksq, V(0.0)), V(0.0), 1 / ksq);" << std::endl;
+        std::cout << "div := Product(szcube);" << std::endl;
+        std::cout << "rmat := TSparseMat([nout, nin], " << sparseMatrix(op) << ");" << std::endl;
+        std::cout << "transform := TFCall(TDecl(TDAG([" << std::endl;
+        std::cout << "    TDAGNode(TTensorI(MDPRDFT(szcube, -1), nin, APar, APar), var_2, var_1)," << std::endl;
+        std::cout << "    TDAGNode(TRC(TMap(rmat, [i0, i1, i2], AVec, AVec)), var_3, var_2)," << std::endl;
+        std::cout << "    TDAGNode(TTensorI(IMDPRDFT(szcube, 1), nout, APar, APar), var_4, var_3)," << std::endl;
+        std::cout << "]), [var_2, var_3])," << std::endl;
+        std::cout << "rec(fname := name, params := [symvar]));" << std::endl;
+    }
+#if !defined (FFTX_CUDA) && !defined (FFTX_HIP)
+    bool nativeTransform();
+
+protected:
+    std::vector<std::complex<double>> spectra, work;
+#endif
+
+protected:
+    spectralOp spectralOperator() const {
+        return (spectralOp)sizes.at(4);
+    }
+
+    // Rows of the TSparseMat of the operator: [row, [col, entry], ...].
+    static std::string sparseMatrix(spectralOp a_op) {
+        static const char * ik[3] = { "cxpack(0, k0 / div)", "cxpack(0, k1 / div)",
+                                      "cxpack(0, k2 / div)" };
+        static const char * k[3] = { "k0", "k1", "k2" };
+        std::ostringstream os;
+        os << "[";
+        switch(a_op) {
+        case SPECTRAL_GRAD:
+            for(int c = 0; c < 3; c++)
+                os << (c ? ", " : "") << "[" << c << ", [0, " << ik[c] << "]]";
+            break;
+        case SPECTRAL_DIV:
+            os << "[0";
+            for(int c = 0; c < 3; c++)
+                os << ", [" << c << ", " << ik[c] << "]";
+            os << "]";
+            break;
+        case SPECTRAL_CURL:
+            for(int c = 0; c < 3; c++) {
+                int a = (c + 1) % 3, b = (c + 2) % 3;
+                os << (c ? ", " : "") << "[" << c << ", [" << a << ", cxpack(0, -" << k[b]
+                   << " / div)], [" << b << ", cxpack(0, " << k[a] << " / div)]]";
+            }
+            break;
+        case SPECTRAL_INVLAPLACIAN:
+            os << "[0, [0, -kinv / div]]";
+            break;
+        case SPECTRAL_LERAY:
+            for(int c = 0; c < 3; c++) {
+                os << (c ? ", " : "") << "[" << c;
+                for(int j = 0; j < 3; j++)
+                    os << ", [" << j << ", (" << (c == j ? "1 - " : "-") << k[c] << " * " << k[j]
+                       << " * kinv) / div]";
+                os << "]";
+            }
+            break;
+        }
+        return os.str() + "]";
+    }
+};
+
+#if !defined (FFTX_CUDA) && !defined (FFTX_HIP)
+
+// Forward transforms of the input components, then for each output
+// component one pass over the spectrum applying its row of the operator
+// and its inverse transform, so one spectrum is live beyond the inputs'.
+inline bool SpectralProblem::nativeTransform() {
+    typedef std::complex<double> cplx;
+    spectralOp op = spectralOperator();
+    int nin = spectralInputs(op), nout = spectralOutputs(op);
+    std::vector<int> n(sizes.begin(), sizes.begin() + 3);
+    std::vector<int> axis{0, 1, 2};     // axis of sizes of each native axis
+    #if !FFTX_ROW_MAJOR_ORDER
+    std::reverse(n.begin(), n.end());
+    std::reverse(axis.begin(), axis.end());
+    #endif
+    const double * const * sym = (const double * const *)args.at(2);
+    std::vector<const double *> knat(3);
+    for(int a = 0; a < 3; a++)
+        knat[a] = sym[axis[a]];
+    size_t npts = (size_t)n[0] * n[1] * n[2];
+    int h2 = n[2]/2 + 1;
+    size_t nspec = (size_t)n[0] * n[1] * h2;
+    spectra.resize(nin * nspec);
+    work.resize(nspec);
+    for(int c = 0; c < nin; c++)
+        fftx_native::mdprdft(3, n.data(), 2, spectra.data() + c*nspec, (double*)args.at(1) + c*npts);
+    const double scale = 1. / npts;
+    for(int r = 0; r < nout; r++) {
+        fftx_native::parallelFor(nspec, 16, [&](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++) {
+                double kn[3] = { knat[0][i / ((size_t)n[1] * h2)],
+                                 knat[1][(i / h2) % n[1]],
+                                 knat[2][i % h2] };
+                double k[3];        // wavenumber along each axis of sizes
+                for(int a = 0; a < 3; a++)
+                    k[axis[a]] = kn[a];
+                double ksq = k[0]*k[0] + k[1]*k[1] + k[2]*k[2];
+                double kinv = (ksq == 0.) ? 0. : 1. / ksq;
+                const cplx * s = spectra.data() + i;
+                cplx v;
+                switch(op) {
+                case SPECTRAL_GRAD:
+                    v = cplx(0., k[r]) * s[0];
+                    break;
+                case SPECTRAL_DIV:
+                    v = cplx(0., 1.) * (k[0] * s[0] + k[1] * s[nspec] + k[2] * s[2*nspec]);
+                    break;
+                case SPECTRAL_CURL: {
+                    int a = (r + 1) % 3, b = (r + 2) % 3;
+                    v = cplx(0., 1.) * (k[a] * s[b*nspec] - k[b] * s[a*nspec]);
+                    break;
+                }
+                case SPECTRAL_INVLAPLACIAN:
+                    v = -kinv * s[0];
+                    break;
+                case SPECTRAL_LERAY:
+                    v = s[r*nspec] - k[r] * kinv * (k[0] * s[0] + k[1] * s[nspec] + k[2] * s[2*nspec]);
+                    break;
+                }
+                work[i] = v * scale;
+            }
+        });
+        fftx_native::imdprdft(3, n.data(), 2, (double*)args.at(0) + r*npts, work.data());
+    }
+    return true;
+}
+
+#endif
+
+#endif
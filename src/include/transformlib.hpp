@@ -1,4 +1,8 @@
 #include "mddftlib.hpp"
 #include "mdprdftlib.hpp"
+#include "r2rlib.hpp"
+#include "resamplelib.hpp"
+#include "spectrallib.hpp"
 #include "dftbatlib.hpp"
+#include "psatdlib.hpp"
 #pragma once
@@ -75,6 +75,8 @@ else
     MDDFT_LIB=true
     MDPRDFT_LIB=true
     RCONV_LIB=true
+    R2R_LIB=true
+    RESAMPLE_LIB=true
     PSATD_LIB=false
     CPU_SIZES_FILE="cube-sizes-cpu.txt"
     GPU_SIZES_FILE="cube-sizes-gpu.txt"
@@ -114,6 +116,18 @@ if [ $build_type = "CPU" ]; then
 	waitspiral=true
 	$pyexe gen_files.py fftx_rconv $CPU_SIZES_FILE $build_type true &
     fi
+    if [ "$R2R_LIB" = true ]; then
+	waitspiral=true
+	$pyexe gen_files.py fftx_mddct $CPU_SIZES_FILE $build_type true &
+	$pyexe gen_files.py fftx_mddct $CPU_SIZES_FILE $build_type false &
+	$pyexe gen_files.py fftx_mddst $CPU_SIZES_FILE $build_type true &
+	$pyexe gen_files.py fftx_mddst $CPU_SIZES_FILE $build_type false &
+    fi
+    if [ "$RESAMPLE_LIB" = true ]; then
+	waitspiral=true
+	$pyexe gen_files.py fftx_resample $CPU_SIZES_FILE $build_type true &
+	$pyexe gen_files.py fftx_resample $CPU_SIZES_FILE $build_type false &
+    fi
     if [ "$waitspiral" = true ]; then
 	wait		##  wait for the child processes to complete
     fi
@@ -149,6 +163,18 @@ if [[ $build_type = "CUDA" || $build_type = "HIP" ]]; then
 	waitspiral=true
 	$pyexe gen_files.py fftx_rconv $GPU_SIZES_FILE $build_type true &
     fi
+    if [ "$R2R_LIB" = true ]; then
+	waitspiral=true
+	$pyexe gen_files.py fftx_mddct $GPU_SIZES_FILE $build_type true &
+	$pyexe gen_files.py fftx_mddct $GPU_SIZES_FILE $build_type false &
+	$pyexe gen_files.py fftx_mddst $GPU_SIZES_FILE $build_type true &
+	$pyexe gen_files.py fftx_mddst $GPU_SIZES_FILE $build_type false &
+    fi
+    if [ "$RESAMPLE_LIB" = true ]; then
+	waitspiral=true
+	$pyexe gen_files.py fftx_resample $GPU_SIZES_FILE $build_type true &
+	$pyexe gen_files.py fftx_resample $GPU_SIZES_FILE $build_type false &
+    fi
     if [ "$PSATD_LIB" = true ]; then
 	waitspiral=true
 	$pyexe gen_files.py fftx_psatd $PSATD_SIZES_FILE $build_type true &
@@ -37,9 +37,14 @@ else
 fi;
 
 if 1 = 1 then
-    name := prefix::StringInt(szcube[1])::ApplyFunc(ConcatenationString, List(Drop(szcube, 1), s->"x"::StringInt(s)));
+    ##  1D and 2D transforms are named by their extents padded to 3, [1, 1, x] and [1, x, y],
+    szname := List([Length(szcube)+1..3], i->1)::szcube;
+    name := prefix::StringInt(szname[1])::ApplyFunc(ConcatenationString, List(Drop(szname, 1), s->"x"::StringInt(s)));
     name := name::"_"::codefor;
-    jitname := jitpref::StringInt(szcube[1])::ApplyFunc(ConcatenationString, List(Drop(szcube, 1), s->"x"::StringInt(s)));
+    ##  and cached at run time by their sizes [1, x, y, batch, dim] (mdSizes of interface.hpp)
+    jitsz := szcube;
+    if Length(szcube) < 3 then jitsz := szname::[1, Length(szcube)]; fi;
+    jitname := jitpref::StringInt(jitsz[1])::ApplyFunc(ConcatenationString, List(Drop(jitsz, 1), s->"x"::StringInt(s)));
     jitname := jitname::"_"::codefor::".txt";
     
     PrintLine("fftx_mddft-frame: name = ", name, ", cube = ", szcube, ", jitname = ", jitname, ";\t\t##PICKME##");
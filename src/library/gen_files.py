@@ -54,6 +54,9 @@ SP_TRANSFORM_MDDFT      = 'MDDFT'
 SP_TRANSFORM_MDRCONV    = 'MDRCONV'
 SP_TRANSFORM_MDRFSCONV  = 'MDRFSCONV'
 SP_TRANSFORM_MDPRDFT    = 'MDPRDFT'
+SP_TRANSFORM_MDDCT      = 'MDDCT'
+SP_TRANSFORM_MDDST      = 'MDDST'
+SP_TRANSFORM_RESAMPLE   = 'RESAMPLE'
 SP_TRANSFORM_UNKNOWN    = 'UNKNOWN'
 
 SP_KEY_BATCHSIZE        = 'BatchSize'
@@ -250,11 +253,37 @@ def body_public_header ( codefor, xfm ):
 
         _str = _str + 'void ' + _file_stem + codefor + 'python_destroy_wrapper ( int * req );\n\n}\n\n'
 
+        _str = _str + fixed_sizes_header ( codefor )
+
     _str = _str + '#endif\n\n'
 
     return _str;
 
 
+def fixed_sizes_header ( codefor ):
+    "Add the compile-time size table and the per-size traits to the public header file"
+
+    _str =        '//  Compile-time table of the sizes built into the library, terminated by { 0, 0, 0 }.\n\n'
+    _str = _str + 'static constexpr int ' + _file_stem + codefor + 'NumSizes = ' + str ( _num_sizes ) + ';\n'
+    _str = _str + 'static constexpr int ' + _file_stem + codefor + 'ConstSizes[][3] = {\n'
+    _str = _str + _const_sizes + '    { 0, 0, 0 }\n};\n'
+    _str = _str + '#define ' + _file_stem + 'NumSizes ' + _file_stem + codefor + 'NumSizes\n'
+    _str = _str + '#define ' + _file_stem + 'ConstSizes ' + _file_stem + codefor + 'ConstSizes\n\n'
+
+    _str = _str + '//  ' + _file_stem + codefor + 'Fixed<X, Y, Z>::available is true only for a size built\n'
+    _str = _str + '//  into the library.  For those sizes init(), run() and destroy() call the generated\n'
+    _str = _str + '//  functions directly, so no runtime lookup in the tuple table is needed.\n\n'
+
+    _str = _str + 'template <int NX, int NY, int NZ>\n'
+    _str = _str + 'struct ' + _file_stem + codefor + 'Fixed\n{\n'
+    _str = _str + '    static constexpr bool available = false;\n};\n\n'
+    _str = _str + _extern_decls
+    _str = _str + _fixed_specs
+    _str = _str + '#define ' + _file_stem + 'Fixed ' + _file_stem + codefor + 'Fixed\n\n'
+
+    return _str;
+
+
 def library_api ( mkvers, decor, type, xfm ):
     "Sets up the API file(s) for the library: one generic file and up to two arch specific versions"
     if type == '':
@@ -402,6 +431,9 @@ def python_cuda_api ( mkvers, decor, type, xfm ):
         ##                     x * y * ((z/2) + 1) * 2 doubles (for R2C, output)
         ##     IMDPRDFT:       x * y * ((z/2) + 1) * 2 doubles (for C2R, input)
         ##                     x * y * z     doubles (for C2R, output)
+        ##     [I]MDDCT/[I]MDDST: x * y * z  doubles (for R2R, both input & output)
+        ##     RESAMPLE:       x * y * z doubles in, 2x * 2y * 2z doubles out
+        ##     IRESAMPLE:      x * y * z doubles in, x/2 * y/2 * z/2 doubles out
         if xfm == 'mddft' or xfm == 'imddft':
             _str = _str + '    int ndoubin  = (int)(req[0] * req[1] * req[2] * 2);\n'
             _str = _str + '    int ndoubout = (int)(req[0] * req[1] * req[2] * 2);\n'
@@ -411,6 +443,15 @@ def python_cuda_api ( mkvers, decor, type, xfm ):
         elif xfm == 'imdprdft' or xfm == 'rconv':
             _str = _str + '    int ndoubin  = (int)(req[0] * req[1] * ((int)(req[2]/2) + 1) * 2);\n'
             _str = _str + '    int ndoubout = (int)(req[0] * req[1] * req[2] );\n'
+        elif xfm in ( 'mddct', 'imddct', 'mddst', 'imddst' ):
+            _str = _str + '    int ndoubin  = (int)(req[0] * req[1] * req[2] );\n'
+            _str = _str + '    int ndoubout = (int)(req[0] * req[1] * req[2] );\n'
+        elif xfm == 'resample':
+            _str = _str + '    int ndoubin  = (int)(req[0] * req[1] * req[2] );\n'
+            _str = _str + '    int ndoubout = (int)(req[0] * req[1] * req[2] * 8 );\n'
+        elif xfm == 'iresample':
+            _str = _str + '    int ndoubin  = (int)(req[0] * req[1] * req[2] );\n'
+            _str = _str + '    int ndoubout = (int)((req[0]/2) * (req[1]/2) * (req[2]/2) );\n'
         elif xfm == 'psatd':
             _str = _str + '    int ndoubin  = (int)(req[0] * req[1] * req[2] );\n'
             _str = _str + '    int ndoubout = (int)(req[0] * req[1] * ((int)(req[2]/2) + 1) * 2);\n'
@@ -452,6 +493,15 @@ def python_cuda_api ( mkvers, decor, type, xfm ):
         elif xfm == 'imdprdft' or xfm == 'rconv':
             _str = _str + '    int ndoubin  = (int)(req[0] * req[1] * ((int)(req[2]/2) + 1) * 2);\n'
             _str = _str + '    int ndoubout = (int)(req[0] * req[1] * req[2] );\n'
+        elif xfm in ( 'mddct', 'imddct', 'mddst', 'imddst' ):
+            _str = _str + '    int ndoubin  = (int)(req[0] * req[1] * req[2] );\n'
+            _str = _str + '    int ndoubout = (int)(req[0] * req[1] * req[2] );\n'
+        elif xfm == 'resample':
+            _str = _str + '    int ndoubin  = (int)(req[0] * req[1] * req[2] );\n'
+            _str = _str + '    int ndoubout = (int)(req[0] * req[1] * req[2] * 8 );\n'
+        elif xfm == 'iresample':
+            _str = _str + '    int ndoubin  = (int)(req[0] * req[1] * req[2] );\n'
+            _str = _str + '    int ndoubout = (int)((req[0]/2) * (req[1]/2) * (req[2]/2) );\n'
         elif xfm == 'psatd':
             _str = _str + '    int ndoubin  = (int)(req[0] * req[1] * req[2] );\n'
             _str = _str + '    int ndoubout = (int)(req[0] * req[1] * ((int)(req[2]/2) + 1) * 2);\n'
@@ -576,6 +626,9 @@ def cmake_library ( decor, type ):
 
 
 _extern_decls  = ''
+_fixed_specs   = ''
+_const_sizes   = ''
+_num_sizes     = 0
 _all_cubes     = 'static fftx::point_t<3> AllSizes3_' + _code_type + '[] = {\n'
 _tuple_funcs   = 'static transformTuple_t ' + _file_stem + _code_type + '_Tuples[] = {\n'
 
@@ -611,6 +664,14 @@ with open ( _sizesfil, 'r' ) as fil:
         line = re.sub ( ' *', '', line )                 ## compress out white space
         line = line.rstrip()                             ## remove training newline
         dims = re.split ( ',', line )
+        ##  1D and 2D sizes are in the mddft and mdprdft libraries as [ 1, 1, x ] and
+        ##  [ 1, x, y ] (the frame names the function the same way); the kernel is of
+        ##  the given rank.  The other libraries are 3D only.
+        if len ( dims ) != 3 and ( len ( dims ) > 3 or not _xform_root in ( 'mddft', 'imddft', 'mdprdft', 'imdprdft' ) ):
+            print ( 'Skipping size ' + line + ' for ' + _xform_root, flush = True )
+            continue
+        while len ( dims ) < 3:
+            dims.insert ( 0, '1' )
         _dimx = dims[0]
         _dimy = dims[1]
         _dimz = dims[2]
@@ -674,6 +735,16 @@ with open ( _sizesfil, 'r' ) as fil:
             _all_cubes = _all_cubes + '    { ' + _dimx + ', ' + _dimy + ', ' + _dimz + ' },\n'
             _tuple_funcs = _tuple_funcs + '    { init_' + _func_stem + ', destroy_' + _func_stem + ', '
             _tuple_funcs = _tuple_funcs + _func_stem + ' },\n'
+
+            _num_sizes   = _num_sizes + 1
+            _const_sizes = _const_sizes + '    { ' + _dimx + ', ' + _dimy + ', ' + _dimz + ' },\n'
+            _fixed_specs = _fixed_specs + 'template <>\nstruct ' + _file_stem + _decor + 'Fixed<'
+            _fixed_specs = _fixed_specs + _dimx + ', ' + _dimy + ', ' + _dimz + '>\n{\n'
+            _fixed_specs = _fixed_specs + '    static constexpr bool available = true;\n'
+            _fixed_specs = _fixed_specs + '    static void init () { init_' + _func_stem + ' (); }\n'
+            _fixed_specs = _fixed_specs + '    static void destroy () { destroy_' + _func_stem + ' (); }\n'
+            _fixed_specs = _fixed_specs + '    static void run ( double *output, double *input, double *sym )\n'
+            _fixed_specs = _fixed_specs + '        { ' + _func_stem + ' ( output, input, sym ); }\n};\n\n'
             _metadata += '        {    \\"' + SP_KEY_DIMENSIONS + '\\": [ ' + _dimx + ', ' + _dimy + ', ' + _dimz + ' ],\\\n'
             _metadata += '             \\"' + SP_KEY_DIRECTION + '\\": \\"'
             if _fwd == 'true':
@@ -54,6 +54,11 @@ namespace fftx {
       return this->transform2Buffers(a_src, a_dst);
     }
     
+    bool checkSpec(fftx_check::spec& a_spec)
+    {
+      return this->fillCheckSpec(a_spec, fftx_check::C2C, 1);
+    }
+
     std::string shortname()
     {
       return "imddft";
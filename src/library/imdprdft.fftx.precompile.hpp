@@ -56,6 +56,11 @@ namespace fftx {
       return this->transform2Buffers(a_src, a_dst);
     }
     
+    bool checkSpec(fftx_check::spec& a_spec)
+    {
+      return this->fillCheckSpec(a_spec, fftx_check::C2R, 1);
+    }
+
     std::string shortname()
     {
       return "imdprdft";
@@ -22,7 +22,8 @@ namespace fftx {
       // std::cout << "Defining mddft<" << DIM << ">" << this->m_size
       // << std::endl;
       // look up this transform size in the database.
-      // I would prefer if this was a constexpr kind of thing where we fail at compile time
+      // For a size known at compile time, use mddft_fixed<NX, NY, NZ> below,
+      // which fails at compile time if the size is not in the library.
       transformTuple_t* tupl = fftx_mddft_Tuple ( this->m_size );
       this->setInit(tupl);
       if (tupl != NULL) this->transform_spiral = *tupl->runfp;
@@ -54,6 +55,11 @@ namespace fftx {
       return this->transform2Buffers(a_src, a_dst);
     }
 
+    bool checkSpec(fftx_check::spec& a_spec)
+    {
+      return this->fillCheckSpec(a_spec, fftx_check::C2C, -1);
+    }
+
     std::string shortname()
     {
       return "mddft";
@@ -64,6 +70,54 @@ namespace fftx {
     // void (*transform_spiral)(double*, double*, double*) = nullptr;
     // void (*destroy_spiral)() = nullptr;
   };
+
+  /*
+   Complex to Complex DFT of size [NX,NY,NZ] fixed at compile time.
+
+   The size is checked against the compile-time size table in the library
+   public header, so a size that is not in the library fails to compile,
+   and construction binds the generated functions without any lookup.
+  */
+  template <int NX, int NY, int NZ>
+  class mddft_fixed : public transformer<3, std::complex<double>, std::complex<double>>
+  {
+    static_assert(fftx_mddft_Fixed<NX, NY, NZ>::available,
+                  "mddft_fixed: transform of size [NX,NY,NZ] is not in the mddft library");
+
+  public:
+    mddft_fixed() :
+      transformer<3, std::complex<double>, std::complex<double>>(point_t<3>({{NX, NY, NZ}}))
+    {
+      this->template setInitFixed<fftx_mddft_Fixed<NX, NY, NZ>>();
+    }
+
+    inline bool defined()
+    {
+      return true;
+    }
+
+    inline fftx::handle_t transform(array_t<3, std::complex<double>>& a_src,
+                                    array_t<3, std::complex<double>>& a_dst)
+    {
+      return this->transform2(a_src, a_dst);
+    }
+
+    inline fftx::handle_t transformBuffers(std::complex<double>* a_src,
+                                           std::complex<double>* a_dst)
+    {
+      return this->transform2Buffers(a_src, a_dst);
+    }
+
+    bool checkSpec(fftx_check::spec& a_spec)
+    {
+      return this->fillCheckSpec(a_spec, fftx_check::C2C, -1);
+    }
+
+    std::string shortname()
+    {
+      return "mddft_fixed";
+    }
+  };
 }
 
 #endif  
@@ -8,6 +8,10 @@
 
 #include "fftx3.hpp"
 #include "device_macros.h"
+#include "fftxcheck.hpp"
+#if !defined(__CUDACC__) && !defined(FFTX_HIP)
+#include "fftxnative.hpp"
+#endif
 
 /*
  Real 3D convolution class for precompiled transforms
@@ -104,6 +108,10 @@ namespace fftx {
 
       if (srcSame && dstSame)
         {
+          if (!a_src.contiguous() || !a_dst.contiguous())
+            {
+              return transform2Views(a_src, a_dst);
+            }
           return transform2Buffers(a_src.m_data.local(), a_dst.m_data.local());
         }
 
@@ -118,6 +126,14 @@ namespace fftx {
       double* inputLocal = (double*) a_src;
       double* outputLocal = (double*) a_dst;
       double* symLocal = nullptr;
+
+      fftx_check::spec chk;
+      bool checked = m_checkSampler.sample() && checkSpec(chk);
+      std::vector<double> input;
+      if (checked)
+        {
+          input = fftx_check::snapshot(inputLocal, chk.inputDoubles());
+        }
       
       kernelStart();
       std::chrono::high_resolution_clock::time_point t1 =
@@ -129,14 +145,128 @@ namespace fftx {
       std::chrono::duration<double> time_span =
         std::chrono::duration_cast<std::chrono::duration<double>>(t2-t1);
       m_CPU_milliseconds = time_span.count()*1000;
+
+      if (checked)
+        {
+          fftx_check::submit(chk, std::move(input), outputLocal);
+        }
       
       // dummy return handle for now
       fftx::handle_t rtn;
       return rtn;
     }
 
+    // Transform of strided views (array_t::subArray), such as the interiors
+    // of fields with ghost cells.  The library kernels are generated for
+    // packed arrays, so the native engine reads and writes the views in
+    // place (CPU only), as the transform that checkSpec describes.
+    inline fftx::handle_t transform2Views(array_t<DIM, T_IN>& a_src,
+                                          array_t<DIM, T_OUT>& a_dst)
+    {
+      fftx::handle_t rtn;
+#if defined(__CUDACC__) || defined(FFTX_HIP)
+      std::cout << "error: " << name()
+                << "::transform called with strided arrays on the device"
+                << std::endl;
+#else
+      fftx_check::spec chk;
+      if (!checkSpec(chk))
+        {
+          std::cout << "error: " << name()
+                    << "::transform cannot take strided arrays" << std::endl;
+          return rtn;
+        }
+      std::vector<size_t> srcStride = memoryStrides(a_src);
+      std::vector<size_t> dstStride = memoryStrides(a_dst);
+      double* inputLocal = (double*) a_src.m_data.local();
+      double* outputLocal = (double*) a_dst.m_data.local();
+      int dim = chk.n.size();
+
+      std::chrono::high_resolution_clock::time_point t1 =
+        std::chrono::high_resolution_clock::now();
+      switch (chk.tp)
+        {
+        case fftx_check::C2C:
+          fftx_native::mddft(dim, chk.n.data(), (fftx_native::cplx*) outputLocal, dstStride.data(),
+                             (fftx_native::cplx*) inputLocal, srcStride.data(), chk.sign);
+          break;
+        case fftx_check::R2C:
+          fftx_native::mdprdft(dim, chk.n.data(), chk.truncAxis,
+                               (fftx_native::cplx*) outputLocal, dstStride.data(),
+                               inputLocal, srcStride.data());
+          break;
+        case fftx_check::C2R:
+          fftx_native::imdprdft(dim, chk.n.data(), chk.truncAxis,
+                                outputLocal, dstStride.data(),
+                                (fftx_native::cplx*) inputLocal, srcStride.data());
+          break;
+        }
+      std::chrono::high_resolution_clock::time_point t2 =
+        std::chrono::high_resolution_clock::now();
+      std::chrono::duration<double> time_span =
+        std::chrono::duration_cast<std::chrono::duration<double>>(t2-t1);
+      m_CPU_milliseconds = time_span.count()*1000;
+#endif
+      return rtn;
+    }
+
+    // Transform with split-complex (planar) complex arguments: the real and
+    // imaginary parts of a complex source or destination are in separate
+    // arrays, a_srcRe and a_srcIm or a_dstRe and a_dstIm, packed over the
+    // input or output size; a real argument is a_srcRe or a_dstRe alone.
+    // The library kernels are interleaved, so the native engine (CPU only)
+    // reads and writes the planes directly, as the transform that checkSpec
+    // describes.
+    inline fftx::handle_t transform2Split(double* a_srcRe, double* a_srcIm,
+                                          double* a_dstRe, double* a_dstIm)
+    {
+      fftx::handle_t rtn;
+#if defined(__CUDACC__) || defined(FFTX_HIP)
+      std::cout << "error: " << name()
+                << "::transform2Split called on the device" << std::endl;
+#else
+      fftx_check::spec chk;
+      if (!checkSpec(chk))
+        {
+          std::cout << "error: " << name()
+                    << "::transform2Split cannot take split-complex arrays" << std::endl;
+          return rtn;
+        }
+      fftx_native::splitArray src(a_srcRe, a_srcIm), dst(a_dstRe, a_dstIm);
+      int dim = chk.n.size();
+
+      std::chrono::high_resolution_clock::time_point t1 =
+        std::chrono::high_resolution_clock::now();
+      switch (chk.tp)
+        {
+        case fftx_check::C2C:
+          fftx_native::mddft(dim, chk.n.data(), dst, src, chk.sign);
+          break;
+        case fftx_check::R2C:
+          fftx_native::mdprdft(dim, chk.n.data(), chk.truncAxis, dst, a_srcRe);
+          break;
+        case fftx_check::C2R:
+          fftx_native::imdprdft(dim, chk.n.data(), chk.truncAxis, a_dstRe, src);
+          break;
+        }
+      std::chrono::high_resolution_clock::time_point t2 =
+        std::chrono::high_resolution_clock::now();
+      std::chrono::duration<double> time_span =
+        std::chrono::duration_cast<std::chrono::duration<double>>(t2-t1);
+      m_CPU_milliseconds = time_span.count()*1000;
+#endif
+      return rtn;
+    }
+
     bool isDefined() { return m_defined; }
 
+    // Checked mode (fftxcheck.hpp): verify every a_rate-th transform in the
+    // background; 0 turns it off.
+    void setCheckRate(int a_rate) { m_checkSampler.setRate(a_rate); }
+
+    // Describe the transform for checked mode; false if it cannot be checked.
+    virtual bool checkSpec(fftx_check::spec& /* a_spec */) { return false; }
+
     double CPU_milliseconds() { return m_CPU_milliseconds; }
     double GPU_milliseconds() { return m_GPU_milliseconds; }
 
@@ -179,6 +309,28 @@ namespace fftx {
     double m_CPU_milliseconds = 0.;
     float  m_GPU_milliseconds = 0.;
 
+    fftx_check::sampler m_checkSampler;
+
+    // checkSpec for a transform over m_size.
+    bool fillCheckSpec(fftx_check::spec& a_spec, fftx_check::kind a_tp, int a_sign)
+    {
+      std::vector<int> n(m_size.x, m_size.x + DIM);
+      a_spec = fftx_check::layoutSpec(name(), a_tp, n, a_sign);
+      return true;
+    }
+
+    // Element strides of a_array in memory order, slowest varying first.
+    template <typename T>
+    static std::vector<size_t> memoryStrides(const array_t<DIM, T>& a_array)
+    {
+      std::array<size_t, DIM> strides = a_array.strides();
+      std::vector<size_t> rtn(strides.begin(), strides.end());
+#if !FFTX_ROW_MAJOR_ORDER
+      std::reverse(rtn.begin(), rtn.end());
+#endif
+      return rtn;
+    }
+
     void setInit(transformTuple_t* a_tupl)
     {
       // look up this transform size in the database.
@@ -211,6 +363,17 @@ namespace fftx {
         }
     }
 
+    // Bind the init, run and destroy functions of a fixed-size library
+    // entry directly (FIXED is an fftx_<transform>_Fixed<NX, NY, NZ>
+    // specialization from the library public header): no table lookup.
+    template <class FIXED>
+    void setInitFixed()
+    {
+      transformTuple_t tupl = { FIXED::init, FIXED::destroy, FIXED::run };
+      setInit(&tupl);
+      transform_spiral = FIXED::run;
+    }
+
     // private:
     void (*init_spiral)() = nullptr;
     void (*transform_spiral)(double*, double*, double*) = nullptr;